@@ -866,6 +866,43 @@ static int tls_set_priority(struct TlsSockData *data)
 }
 #endif
 
+/**
+ * tls_resume_session - Offer a saved session to the server
+ * @param conn Connection to a server
+ */
+static void tls_resume_session(struct Connection *conn)
+{
+  struct TlsSockData *data = conn->sockdata;
+
+  size_t len = 0;
+  const unsigned char *sdata = ssl_session_get(&conn->account, &len);
+  if (!sdata)
+    return;
+
+  int err = gnutls_session_set_data(data->session, sdata, len);
+  if (err < 0)
+    mutt_debug(LL_DEBUG1, "gnutls_session_set_data: %s\n", gnutls_strerror(err));
+}
+
+/**
+ * tls_save_session - Save the session, so that it can be resumed
+ * @param conn Connection to a server
+ *
+ * With TLS 1.3, the server only sends its session ticket after the handshake,
+ * so this is done when the connection is closed.
+ */
+static void tls_save_session(struct Connection *conn)
+{
+  struct TlsSockData *data = conn->sockdata;
+
+  gnutls_datum_t sdata = { 0 };
+  if (gnutls_session_get_data2(data->session, &sdata) < 0)
+    return;
+
+  ssl_session_set(&conn->account, sdata.data, sdata.size);
+  gnutls_free(sdata.data);
+}
+
 /**
  * tls_negotiate - Negotiate TLS connection
  * @param conn Connection to a server
@@ -941,6 +978,8 @@ static int tls_negotiate(struct Connection *conn)
 
   gnutls_credentials_set(data->session, GNUTLS_CRD_CERTIFICATE, data->xcred);
 
+  tls_resume_session(conn);
+
   do
   {
     err = gnutls_handshake(data->session);
@@ -960,6 +999,9 @@ static int tls_negotiate(struct Connection *conn)
     goto fail;
   }
 
+  if (gnutls_session_is_resumed(data->session))
+    mutt_debug(LL_DEBUG2, "Resumed TLS session with %s\n", conn->account.host);
+
   if (tls_check_certificate(conn) == 0)
     goto fail;
 
@@ -1018,6 +1060,7 @@ static int tls_socket_close(struct Connection *conn)
      * It is not required for the initiator of the close to wait for the
      * responding close_notify alert before closing the read side of the
      * connection.  */
+    tls_save_session(conn);
     gnutls_bye(data->session, GNUTLS_SHUT_WR);
 
     gnutls_certificate_free_credentials(data->xcred);
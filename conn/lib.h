@@ -35,10 +35,12 @@
  * | conn/gnutls.c         | @subpage conn_gnutls          |
  * | conn/gsasl.c          | @subpage conn_gsasl           |
  * | conn/openssl.c        | @subpage conn_openssl         |
+ * | conn/pool.c           | @subpage conn_pool            |
  * | conn/raw.c            | @subpage conn_raw             |
  * | conn/sasl.c           | @subpage conn_sasl            |
  * | conn/sasl_plain.c     | @subpage conn_sasl_plain      |
  * | conn/socket.c         | @subpage conn_socket          |
+ * | conn/ssl_session.c    | @subpage conn_ssl_session     |
  * | conn/tunnel.c         | @subpage conn_tunnel          |
  * | conn/zstrm.c          | @subpage conn_zstrm           |
  */
@@ -50,6 +52,7 @@
 // IWYU pragma: begin_keep
 #include "connaccount.h"
 #include "connection.h"
+#include "pool.h"
 #include "sasl_plain.h"
 #include "socket.h"
 #ifdef USE_SASL_GNU
@@ -66,7 +69,8 @@
 struct Buffer;
 
 #ifdef USE_SSL
-int mutt_ssl_starttls(struct Connection *conn);
+int  mutt_ssl_starttls       (struct Connection *conn);
+void mutt_ssl_session_cleanup(void);
 #endif
 
 int getdnsdomainname(struct Buffer *result);
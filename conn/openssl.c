@@ -88,6 +88,15 @@ static int HostExDataIndex = -1;
  * skips a certificate in the chain, the stored value will be non-null. */
 static int SkipModeExDataIndex = -1;
 
+/// Index for storing the Connection in the SSL structure, for saving sessions
+static int ConnExDataIndex = -1;
+
+/** Index for storing the "prompted" state in SSL structure.  When the user
+ * accepts or skips a certificate that isn't otherwise trusted, the stored value
+ * will be non-null, and the session isn't saved.  OpenSSL doesn't verify the
+ * certificates again when a session is resumed. */
+static int PromptedExDataIndex = -1;
+
 /** Keep a handle on accepted certificates in case we want to
  * open up another connection to the same server in this session */
 static STACK_OF(X509) *SslSessionCerts = NULL;
@@ -593,6 +602,8 @@ static int ssl_init(void)
   SSL_load_error_strings();
   SSL_library_init();
 #endif
+  ConnExDataIndex = SSL_get_ex_new_index(0, "conn", NULL, NULL, NULL);
+  PromptedExDataIndex = SSL_get_ex_new_index(0, "prompted", NULL, NULL, NULL);
   init_complete = true;
   return 0;
 }
@@ -619,6 +630,71 @@ static void ssl_get_client_cert(struct SslSockData *ssldata, struct Connection *
     mutt_debug(LL_DEBUG1, "Couldn't get user info\n");
 }
 
+/**
+ * ssl_new_session_cb - Save a new TLS session
+ * @param ssl  SSL connection
+ * @param sess New session
+ * @retval 0 The session hasn't been kept
+ *
+ * Called by OpenSSL once the server has sent a session ID or ticket.
+ * With TLS 1.3, this happens after the handshake.
+ *
+ * Only sessions whose certificate chain was verified by the system's trusted
+ * certificates, or by `$certificate_file`, are saved.
+ */
+static int ssl_new_session_cb(SSL *ssl, SSL_SESSION *sess)
+{
+  struct Connection *conn = SSL_get_ex_data(ssl, ConnExDataIndex);
+  if (!conn)
+    return 0;
+
+  if ((PromptedExDataIndex == -1) || SSL_get_ex_data(ssl, PromptedExDataIndex))
+  {
+    mutt_debug(LL_DEBUG2, "Not saving TLS session, the certificate was accepted manually\n");
+    return 0;
+  }
+
+  int len = i2d_SSL_SESSION(sess, NULL);
+  if (len <= 0)
+    return 0;
+
+  unsigned char *data = mutt_mem_malloc(len);
+  unsigned char *p = data;
+  i2d_SSL_SESSION(sess, &p);
+  ssl_session_set(&conn->account, data, len);
+  FREE(&data);
+
+  return 0;
+}
+
+/**
+ * ssl_resume_session - Offer a saved session to the server
+ * @param conn    Connection to a server
+ * @param ssldata SSL socket data
+ */
+static void ssl_resume_session(struct Connection *conn, struct SslSockData *ssldata)
+{
+  if ((ConnExDataIndex == -1) || !SSL_set_ex_data(ssldata->ssl, ConnExDataIndex, conn))
+    return;
+
+  SSL_CTX_set_session_cache_mode(ssldata->sctx, SSL_SESS_CACHE_CLIENT |
+                                                    SSL_SESS_CACHE_NO_INTERNAL_STORE);
+  SSL_CTX_sess_set_new_cb(ssldata->sctx, ssl_new_session_cb);
+
+  size_t len = 0;
+  const unsigned char *data = ssl_session_get(&conn->account, &len);
+  if (!data)
+    return;
+
+  SSL_SESSION *sess = d2i_SSL_SESSION(NULL, &data, len);
+  if (!sess)
+    return;
+
+  if (SSL_set_session(ssldata->ssl, sess) != 1)
+    mutt_debug(LL_DEBUG1, "Unable to use saved TLS session\n");
+  SSL_SESSION_free(sess);
+}
+
 /**
  * ssl_socket_close_and_restore - Close an SSL Connection and restore Connection callbacks - Implements Connection::close() - @ingroup connection_close
  */
@@ -961,6 +1037,7 @@ static bool interactive_check_cert(X509 *cert, int idx, size_t len, SSL *ssl, bo
       break;
     case 2: // Once
       SSL_set_ex_data(ssl, SkipModeExDataIndex, NULL);
+      SSL_set_ex_data(ssl, PromptedExDataIndex, &PromptedExDataIndex);
       ssl_cache_trusted_cert(cert);
       break;
     case 3: // Always
@@ -975,9 +1052,14 @@ static bool interactive_check_cert(X509 *cert, int idx, size_t len, SSL *ssl, bo
       }
 
       if (saved)
+      {
         mutt_message(_("Certificate saved"));
+      }
       else
+      {
         mutt_error(_("Warning: Couldn't save certificate"));
+        SSL_set_ex_data(ssl, PromptedExDataIndex, &PromptedExDataIndex);
+      }
 
       SSL_set_ex_data(ssl, SkipModeExDataIndex, NULL);
       ssl_cache_trusted_cert(cert);
@@ -985,6 +1067,7 @@ static bool interactive_check_cert(X509 *cert, int idx, size_t len, SSL *ssl, bo
     }
     case 4: // Skip
       SSL_set_ex_data(ssl, SkipModeExDataIndex, &SkipModeExDataIndex);
+      SSL_set_ex_data(ssl, PromptedExDataIndex, &PromptedExDataIndex);
       break;
   }
 
@@ -1068,6 +1151,9 @@ static int ssl_verify_callback(int preverify_ok, X509_STORE_CTX *ctx)
   {
     mutt_debug(LL_DEBUG2, "using cached certificate\n");
     SSL_set_ex_data(ssl, SkipModeExDataIndex, NULL);
+    /* it was accepted at the prompt, unless it's in $certificate_file */
+    if (!check_certificate_by_digest(cert))
+      SSL_set_ex_data(ssl, PromptedExDataIndex, &PromptedExDataIndex);
     return true;
   }
 
@@ -1150,6 +1236,13 @@ static int ssl_negotiate(struct Connection *conn, struct SslSockData *ssldata)
     return -1;
   }
 
+  if ((PromptedExDataIndex != -1) &&
+      !SSL_set_ex_data(ssldata->ssl, PromptedExDataIndex, NULL))
+  {
+    mutt_debug(LL_DEBUG1, "#5 failed to save prompted state in SSL structure\n");
+    return -1;
+  }
+
   SSL_set_verify(ssldata->ssl, SSL_VERIFY_PEER, ssl_verify_callback);
   SSL_set_mode(ssldata->ssl, SSL_MODE_AUTO_RETRY);
 
@@ -1286,10 +1379,14 @@ static int ssl_setup(struct Connection *conn)
 
   sockdata(conn)->ssl = SSL_new(sockdata(conn)->sctx);
   SSL_set_fd(sockdata(conn)->ssl, conn->fd);
+  ssl_resume_session(conn, sockdata(conn));
 
   if (ssl_negotiate(conn, sockdata(conn)))
     goto free_ssl;
 
+  if (SSL_session_reused(sockdata(conn)->ssl))
+    mutt_debug(LL_DEBUG2, "Resumed TLS session with %s\n", conn->account.host);
+
   sockdata(conn)->isopen = 1;
   conn->ssf = SSL_CIPHER_get_bits(SSL_get_current_cipher(sockdata(conn)->ssl), &maxbits);
 
@@ -0,0 +1,156 @@
+/**
+ * @file
+ * Pool of spare Connections
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @page conn_pool Connection pool
+ *
+ * Pool of spare Connections
+ *
+ * Setting up a Connection means a TCP handshake, a TLS handshake and a login.
+ * Rather than closing a secondary Connection as soon as it's finished with,
+ * the protocol can hand it to the pool.  The next request for the same
+ * ConnAccount gets it back, already authenticated.
+ *
+ * Spare Connections are kept alive while they're idle and closed once they've
+ * been unused for too long.
+ */
+
+#include "config.h"
+#include <stdbool.h>
+#include <time.h>
+#include "mutt/lib.h"
+#include "pool.h"
+#include "connaccount.h"
+#include "connection.h"
+
+ARRAY_HEAD(PoolConnectionArray, struct PoolConnection);
+
+/// Spare Connections
+static struct PoolConnectionArray ConnPool = ARRAY_HEAD_INITIALIZER;
+
+/**
+ * pool_account_match - Do two ConnAccounts refer to the same login?
+ * @param a1 First ConnAccount
+ * @param a2 Second ConnAccount
+ * @retval true They match
+ */
+static bool pool_account_match(const struct ConnAccount *a1, const struct ConnAccount *a2)
+{
+  return (a1->type == a2->type) && (a1->port == a2->port) &&
+         mutt_istr_equal(a1->host, a2->host) && mutt_str_equal(a1->user, a2->user);
+}
+
+/**
+ * pool_close - Close a spare Connection and remove it from the pool
+ * @param idx Index into the pool
+ */
+static void pool_close(size_t idx)
+{
+  struct PoolConnection *pc = ARRAY_GET(&ConnPool, idx);
+  if (!pc)
+    return;
+
+  struct PoolConnection copy = *pc;
+  ARRAY_REMOVE(&ConnPool, pc);
+
+  mutt_debug(LL_DEBUG2, "Closing spare connection to %s\n", copy.conn->account.host);
+  copy.close(&copy.data);
+}
+
+/**
+ * mutt_conn_pool_get - Take a spare Connection from the pool
+ * @param cac Account to match
+ * @retval ptr  Protocol data of the Connection, now owned by the caller
+ * @retval NULL No spare Connection
+ */
+void *mutt_conn_pool_get(const struct ConnAccount *cac)
+{
+  if (!cac)
+    return NULL;
+
+  struct PoolConnection *pc = NULL;
+  ARRAY_FOREACH(pc, &ConnPool)
+  {
+    if (!pool_account_match(&pc->conn->account, cac))
+      continue;
+
+    void *data = pc->data;
+    ARRAY_REMOVE(&ConnPool, pc);
+    mutt_debug(LL_DEBUG2, "Reusing spare connection to %s\n", cac->host);
+    return data;
+  }
+
+  return NULL;
+}
+
+/**
+ * mutt_conn_pool_put - Return a Connection to the pool
+ * @param pc Connection, its protocol data and callbacks
+ *
+ * The pool takes ownership of the protocol data.
+ */
+void mutt_conn_pool_put(const struct PoolConnection *pc)
+{
+  if (!pc || !pc->conn || !pc->data || !pc->keepalive || !pc->close)
+    return;
+
+  struct PoolConnection pc_new = *pc;
+  pc_new.last_used = mutt_date_now();
+  pc_new.last_keepalive = pc_new.last_used;
+  ARRAY_ADD(&ConnPool, pc_new);
+}
+
+/**
+ * mutt_conn_pool_check - Keep the spare Connections alive, close the idle ones
+ * @param keepalive Seconds between keepalives
+ * @param timeout   Seconds before an unused Connection is closed
+ */
+void mutt_conn_pool_check(time_t keepalive, time_t timeout)
+{
+  const time_t now = mutt_date_now();
+
+  for (size_t i = ARRAY_SIZE(&ConnPool); i > 0; i--)
+  {
+    struct PoolConnection *pc = ARRAY_GET(&ConnPool, i - 1);
+
+    if ((now - pc->last_used) >= timeout)
+    {
+      pool_close(i - 1);
+      continue;
+    }
+
+    if ((keepalive > 0) && ((now - pc->last_keepalive) >= keepalive))
+    {
+      pc->last_keepalive = now;
+      if (pc->keepalive(pc->data) < 0)
+        pool_close(i - 1);
+    }
+  }
+}
+
+/**
+ * mutt_conn_pool_cleanup - Close all the spare Connections
+ */
+void mutt_conn_pool_cleanup(void)
+{
+  while (!ARRAY_EMPTY(&ConnPool))
+    pool_close(ARRAY_SIZE(&ConnPool) - 1);
+
+  ARRAY_FREE(&ConnPool);
+}
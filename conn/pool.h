@@ -0,0 +1,70 @@
+/**
+ * @file
+ * Pool of spare Connections
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUTT_CONN_POOL_H
+#define MUTT_CONN_POOL_H
+
+#include <time.h>
+
+struct ConnAccount;
+struct Connection;
+
+/**
+ * @defgroup conn_pool_api Connection Pool API
+ *
+ * A spare, authenticated Connection, kept open for reuse
+ *
+ * The pool doesn't know about the protocol.  The protocol data that owns the
+ * Connection is stored alongside it, with callbacks to keep it alive and to
+ * log it out.
+ */
+struct PoolConnection
+{
+  struct Connection *conn; ///< Connection, used to match the ConnAccount
+  void *data;              ///< Protocol data that owns the Connection
+  time_t last_used;        ///< When the Connection was returned to the pool
+  time_t last_keepalive;   ///< When the Connection was last kept alive
+
+  /**
+   * @defgroup conn_pool_keepalive keepalive()
+   * @ingroup conn_pool_api
+   *
+   * keepalive - Stop the server timing out an idle Connection, e.g. NOOP
+   * @param data Protocol data
+   * @retval  0 Success
+   * @retval -1 Failure, the Connection will be closed
+   */
+  int (*keepalive)(void *data);
+
+  /**
+   * @defgroup conn_pool_close close()
+   * @ingroup conn_pool_api
+   *
+   * close - Log out and free the protocol data
+   * @param ptr Protocol data to free
+   */
+  void (*close)(void **ptr);
+};
+
+void  mutt_conn_pool_check  (time_t keepalive, time_t timeout);
+void  mutt_conn_pool_cleanup(void);
+void *mutt_conn_pool_get    (const struct ConnAccount *cac);
+void  mutt_conn_pool_put    (const struct PoolConnection *pc);
+
+#endif /* MUTT_CONN_POOL_H */
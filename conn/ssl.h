@@ -27,6 +27,7 @@
 #include <stdbool.h>
 #include "mutt/lib.h"
 
+struct ConnAccount;
 struct Connection;
 
 #ifdef USE_SSL
@@ -35,6 +36,9 @@ ARRAY_HEAD(CertArray, const char *);
 
 void cert_array_clear(struct CertArray *carr);
 
+const unsigned char *ssl_session_get(const struct ConnAccount *cac, size_t *len);
+void                 ssl_session_set(const struct ConnAccount *cac, const unsigned char *data, size_t len);
+
 /**
  * struct CertMenuData - Certificate data to use in the Menu
  */
@@ -0,0 +1,299 @@
+/**
+ * @file
+ * Cache of TLS sessions, for abbreviated handshakes
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @page conn_ssl_session TLS session cache
+ *
+ * Cache of TLS sessions, for abbreviated handshakes
+ *
+ * When a TLS connection is set up, the server may hand out a session ID or a
+ * session ticket.  Presenting it on the next connection to the same server
+ * lets both sides skip the key exchange and certificate checks.
+ *
+ * The sessions are kept in memory, keyed by service, host and port, in the
+ * serialised form of the TLS library.  If `$ssl_session_file` is set, they're
+ * also saved to disk, so that they survive a restart.
+ *
+ * The file has one session per line: "key time base64-data".
+ */
+
+#include "config.h"
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "mutt/lib.h"
+#include "config/lib.h"
+#include "core/lib.h"
+#include "connaccount.h"
+#include "ssl.h"
+
+/// Sessions older than this are discarded, (RFC8446 limits tickets to 7 days)
+#define SSL_SESSION_MAX_AGE (7 * 24 * 60 * 60)
+
+/**
+ * struct SslSession - A saved TLS session
+ */
+struct SslSession
+{
+  char *key;           ///< Service, host and port, e.g. "imap://example.com:993"
+  time_t time;         ///< When the session was saved
+  unsigned char *data; ///< Session, serialised by the TLS library
+  size_t len;          ///< Length of the data
+};
+ARRAY_HEAD(SslSessionArray, struct SslSession);
+
+/// Cache of TLS sessions
+static struct SslSessionArray SslSessions = ARRAY_HEAD_INITIALIZER;
+/// Has `$ssl_session_file` been read?
+static bool SslSessionsLoaded = false;
+
+/**
+ * session_key - Generate the cache key for a Connection
+ * @param cac Account of the Connection
+ * @param buf Buffer for the result
+ */
+static void session_key(const struct ConnAccount *cac, struct Buffer *buf)
+{
+  buf_printf(buf, "%s://%s:%u", NONULL(cac->service), cac->host, cac->port);
+}
+
+/**
+ * session_find - Find a session in the cache
+ * @param key Cache key
+ * @retval ptr Matching session
+ * @retval NULL Not found
+ */
+static struct SslSession *session_find(const char *key)
+{
+  struct SslSession *ss = NULL;
+  ARRAY_FOREACH(ss, &SslSessions)
+  {
+    if (mutt_str_equal(ss->key, key))
+      return ss;
+  }
+  return NULL;
+}
+
+/**
+ * session_store - Add or replace a session in the cache
+ * @param key   Cache key
+ * @param saved Time the session was saved
+ * @param data  Serialised session, will be owned by the cache
+ * @param len   Length of the data
+ */
+static void session_store(const char *key, time_t saved, unsigned char *data, size_t len)
+{
+  struct SslSession *ss = session_find(key);
+  if (ss)
+  {
+    FREE(&ss->data);
+  }
+  else
+  {
+    struct SslSession ss_new = { 0 };
+    ss_new.key = mutt_str_dup(key);
+    ARRAY_ADD(&SslSessions, ss_new);
+    ss = ARRAY_LAST(&SslSessions);
+  }
+
+  ss->time = saved;
+  ss->data = data;
+  ss->len = len;
+}
+
+/**
+ * session_file_load - Read the saved sessions from `$ssl_session_file`
+ */
+static void session_file_load(void)
+{
+  if (SslSessionsLoaded)
+    return;
+
+  SslSessionsLoaded = true;
+
+  const char *const c_ssl_session_file = cs_subset_path(NeoMutt->sub, "ssl_session_file");
+  if (!c_ssl_session_file)
+    return;
+
+  FILE *fp = mutt_file_fopen(c_ssl_session_file, "r");
+  if (!fp)
+    return;
+
+  const time_t now = mutt_date_now();
+  char *line = NULL;
+  size_t linelen = 0;
+  int line_num = 0;
+  while ((line = mutt_file_read_line(line, &linelen, fp, &line_num, MUTT_RL_NO_FLAGS)))
+  {
+    char *key = strtok(line, " ");
+    char *time_str = strtok(NULL, " ");
+    char *b64 = strtok(NULL, " ");
+    long saved = 0;
+    if (!key || !time_str || !b64 || !mutt_str_atol(time_str, &saved) ||
+        ((now - saved) > SSL_SESSION_MAX_AGE))
+    {
+      continue;
+    }
+
+    const size_t size = mutt_str_len(b64);
+    unsigned char *data = mutt_mem_malloc(size);
+    int len = mutt_b64_decode(b64, (char *) data, size);
+    if (len <= 0)
+    {
+      FREE(&data);
+      continue;
+    }
+
+    session_store(key, saved, data, len);
+  }
+
+  FREE(&line);
+  mutt_file_fclose(&fp);
+  mutt_debug(LL_DEBUG2, "Loaded %zu TLS sessions from %s\n",
+             ARRAY_SIZE(&SslSessions), c_ssl_session_file);
+}
+
+/**
+ * session_file_save - Write the cached sessions to `$ssl_session_file`
+ *
+ * The sessions are secret, so the file is only readable by the user.
+ * They're written to a temporary file, which then replaces the old one.
+ */
+static void session_file_save(void)
+{
+  const char *const c_ssl_session_file = cs_subset_path(NeoMutt->sub, "ssl_session_file");
+  if (!c_ssl_session_file)
+    return;
+
+  struct Buffer *tmpfile = buf_pool_get();
+  buf_printf(tmpfile, "%s.tmp", c_ssl_session_file);
+  unlink(buf_string(tmpfile));
+
+  FILE *fp = NULL;
+  int fd = open(buf_string(tmpfile), O_WRONLY | O_CREAT | O_EXCL, 0600);
+  if (fd >= 0)
+  {
+    fp = fdopen(fd, "w");
+    if (!fp)
+      close(fd);
+  }
+  if (!fp)
+  {
+    mutt_debug(LL_DEBUG1, "Can't save TLS sessions to %s\n", buf_string(tmpfile));
+    unlink(buf_string(tmpfile));
+    buf_pool_release(&tmpfile);
+    return;
+  }
+
+  char *b64 = NULL;
+  size_t b64len = 0;
+  const time_t now = mutt_date_now();
+  struct SslSession *ss = NULL;
+  ARRAY_FOREACH(ss, &SslSessions)
+  {
+    if ((now - ss->time) > SSL_SESSION_MAX_AGE)
+      continue;
+
+    const size_t need = ((ss->len + 2) / 3) * 4 + 1;
+    if (need > b64len)
+    {
+      b64len = need;
+      mutt_mem_realloc(&b64, b64len);
+    }
+    mutt_b64_encode((const char *) ss->data, ss->len, b64, b64len);
+    fprintf(fp, "%s %ld %s\n", ss->key, (long) ss->time, b64);
+  }
+
+  FREE(&b64);
+  if ((mutt_file_fclose(&fp) != 0) || (rename(buf_string(tmpfile), c_ssl_session_file) != 0))
+  {
+    mutt_debug(LL_DEBUG1, "Can't save TLS sessions to %s\n", c_ssl_session_file);
+    unlink(buf_string(tmpfile));
+  }
+  buf_pool_release(&tmpfile);
+}
+
+/**
+ * ssl_session_get - Find a saved TLS session for a Connection
+ * @param[in]  cac Account of the Connection
+ * @param[out] len Length of the session data
+ * @retval ptr  Serialised session
+ * @retval NULL None saved
+ */
+const unsigned char *ssl_session_get(const struct ConnAccount *cac, size_t *len)
+{
+  if (!cac || !len)
+    return NULL;
+
+  session_file_load();
+
+  struct Buffer *key = buf_pool_get();
+  session_key(cac, key);
+  struct SslSession *ss = session_find(buf_string(key));
+  buf_pool_release(&key);
+
+  if (!ss || ((mutt_date_now() - ss->time) > SSL_SESSION_MAX_AGE))
+    return NULL;
+
+  *len = ss->len;
+  return ss->data;
+}
+
+/**
+ * ssl_session_set - Save a TLS session for a Connection
+ * @param cac  Account of the Connection
+ * @param data Serialised session
+ * @param len  Length of the data
+ */
+void ssl_session_set(const struct ConnAccount *cac, const unsigned char *data, size_t len)
+{
+  if (!cac || !data || (len == 0))
+    return;
+
+  session_file_load();
+
+  struct Buffer *key = buf_pool_get();
+  session_key(cac, key);
+  mutt_debug(LL_DEBUG2, "Saving TLS session for %s\n", buf_string(key));
+
+  unsigned char *copy = mutt_mem_malloc(len);
+  memcpy(copy, data, len);
+  session_store(buf_string(key), mutt_date_now(), copy, len);
+  buf_pool_release(&key);
+
+  session_file_save();
+}
+
+/**
+ * mutt_ssl_session_cleanup - Free the TLS session cache
+ */
+void mutt_ssl_session_cleanup(void)
+{
+  struct SslSession *ss = NULL;
+  ARRAY_FOREACH(ss, &SslSessions)
+  {
+    FREE(&ss->key);
+    FREE(&ss->data);
+  }
+  ARRAY_FREE(&SslSessions);
+  SslSessionsLoaded = false;
+}
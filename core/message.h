@@ -36,6 +36,7 @@ struct Message
   char *path;           ///< path to temp file
   char *committed_path; ///< the final path generated by mx_msg_commit()
   bool write;           ///< nonzero if message is open for writing
+  bool partial;         ///< Message may omit large attachments (only for display)
   struct
   {
     bool read : 1;    ///< Message has been read
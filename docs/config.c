@@ -1880,6 +1880,34 @@
 ** headers.
 */
 
+{ "imap_fetch_envelope", DT_BOOL, false },
+/*
+** .pp
+** When \fIset\fP, NeoMutt asks the IMAP server for its pre-parsed ENVELOPE
+** and BODYSTRUCTURE of each message, instead of downloading a selection of
+** header fields and parsing them locally.  This reduces the amount of data
+** transferred when opening a large mailbox, and allows the number of
+** attachments to be shown without downloading each message.
+** .pp
+** A few headers, such as References, aren't part of the ENVELOPE, so they
+** are still downloaded.  This option requires an IMAP4rev1 server.
+*/
+
+{ "imap_fetch_newest", DT_LONG, 0 },
+/*
+** .pp
+** When set to a value greater than 0, opening a mailbox only downloads the
+** headers of this many of the newest messages.  The index can be used
+** straight away.  The remaining headers are downloaded, newest first, a batch
+** at a time, whenever NeoMutt checks the mailbox.  Each batch is the size of
+** $$imap_fetch_chunk_size, or this size if that isn't set.
+** .pp
+** Until they've been downloaded, the older messages aren't shown in the index
+** and aren't counted.  Messages in the header cache are always loaded.
+** .pp
+** This is ignored if QRESYNC is enabled (see $$imap_qresync).
+*/
+
 { "imap_headers", DT_STRING, 0 },
 /*
 ** .pp
@@ -1933,6 +1961,16 @@
 ** This variable defaults to the value of $$imap_user.
 */
 
+{ "imap_notify", DT_BOOL, false },
+/*
+** .pp
+** When \fIset\fP, and the server supports the NOTIFY extension (RFC5465),
+** NeoMutt will ask the server to report changes to all the mailboxes of the
+** account, rather than polling each of them with STATUS every
+** $$mail_check seconds.  On servers without NOTIFY, the STATUS commands
+** are pipelined.
+*/
+
 { "imap_oauth_refresh_command", D_STRING_COMMAND, 0 },
 /*
 ** .pp
@@ -1964,6 +2002,19 @@
 ** is slow.
 */
 
+{ "imap_partial_fetch_size", DT_LONG, 0 },
+/*
+** .pp
+** When displaying a message larger than this many bytes, NeoMutt will
+** only fetch its text parts from the server, leaving out large
+** attachments.  The attachments are downloaded when the message is
+** opened for anything else, e.g. viewing the attachments, saving,
+** replying or forwarding.  A value of 0 disables this.
+** .pp
+** This needs the IMAP4rev1 BODYSTRUCTURE.  Signed and encrypted messages
+** are always fetched whole.
+*/
+
 { "imap_peek", DT_BOOL, true },
 /*
 ** .pp
@@ -1985,6 +2036,25 @@
 ** \fBNote:\fP Changes to this variable have no effect on open connections.
 */
 
+{ "imap_prefetch", DT_NUMBER, 0 },
+/*
+** .pp
+** When opening a message, also download up to this many of the messages
+** that follow it in the index into the message cache, so that reading on
+** through a thread doesn't wait for the server each time.  Messages are
+** only prefetched when $$message_cache_dir and $$imap_peek are \fIset\fP.
+** A value of 0 disables prefetching.
+** .pp
+** Also see $$imap_prefetch_size.
+*/
+
+{ "imap_prefetch_size", DT_LONG, 1048576 },
+/*
+** .pp
+** This variable limits the total size, in bytes, of the messages that
+** are prefetched when opening a message.  See $$imap_prefetch.
+*/
+
 { "imap_poll_timeout", DT_NUMBER, 15 },
 /*
 ** .pp
@@ -1994,6 +2064,19 @@
 ** to 0 to disable timing out.
 */
 
+{ "imap_pool_timeout", DT_NUMBER, 0 },
+/*
+** .pp
+** While a mailbox is open, NeoMutt can use a second connection to the
+** same server to check the other mailboxes and to browse folders, so
+** that those don't queue up behind the open mailbox.  The connection is
+** kept open, and alive (see $$imap_keep_alive), until it has been unused
+** for this many seconds.
+** .pp
+** Set to 0 to disable secondary connections.  Note that some servers
+** limit the number of connections per user.
+*/
+
 { "imap_qresync", DT_BOOL, false },
 /*
 ** .pp
@@ -2034,6 +2117,19 @@
 ** them at some point.
 */
 
+{ "imap_server_sort", DT_BOOL, false },
+/*
+** .pp
+** When \fIset\fP, and the server supports the SORT extension (RFC5256),
+** NeoMutt will ask the server to sort the mailbox, rather than comparing
+** every message locally.  This is only used when not threading, and only
+** when $$sort and $$sort_aux are one of: \fIdate\fP, \fIdate-received\fP,
+** \fIfrom\fP, \fIsize\fP, \fIsubject\fP or \fIto\fP.
+** .pp
+** \fBNote:\fP The server follows the rules of RFC5256, so the order may
+** differ slightly from NeoMutt's, e.g. when sorting by \fIfrom\fP.
+*/
+
 { "imap_user", DT_STRING, 0 },
 /*
 ** .pp
@@ -2691,6 +2787,17 @@
 */
 
 #ifdef USE_NOTMUCH
+{ "nm_commit_size", DT_NUMBER, 1000 },
+/*
+** .pp
+** When NeoMutt changes many messages at once, e.g. when syncing a mailbox or
+** modifying the tags of tagged messages, the changes are written to the
+** notmuch database in transactions of this many messages.  Larger values are
+** faster, but more work is lost if NeoMutt is interrupted.
+** .pp
+** If set to 0, all the changes are written in a single transaction.
+*/
+
 { "nm_config_file", DT_PATH, "auto" },
 /*
 ** .pp
@@ -2816,6 +2923,15 @@
 ** commands use standard (e.g. maildir) flags.
 */
 
+{ "nm_thread_structure", DT_BOOL, false },
+/*
+** .pp
+** When set, and a notmuch mailbox is read as threads (see $$nm_query_type),
+** each reply is attached to the parent that notmuch found for it, instead of
+** following its In-Reply-To and References headers.  Messages without a
+** parent are still threaded using their headers.
+*/
+
 { "nm_unread_tag", DT_STRING, "unread" },
 /*
 ** .pp
@@ -2855,6 +2971,18 @@
 ** articles headers will be saved in cache when you quit newsgroup.
 */
 
+#ifdef USE_ZLIB
+{ "nntp_deflate", DT_BOOL, true },
+/*
+** .pp
+** When \fIset\fP, NeoMutt will use the COMPRESS DEFLATE extension (RFC8054)
+** if advertised by the news server.
+** .pp
+** Overviews and lists of newsgroups compress well, so this speeds up
+** entering large newsgroups and loading the list of groups.
+*/
+#endif
+
 { "nntp_listgroup", DT_BOOL, true },
 /*
 ** .pp
@@ -5042,6 +5170,21 @@
 ** since it would otherwise have to abort the connection anyway. This
 ** option supersedes $$ssl_starttls.
 */
+
+{ "ssl_session_file", DT_PATH, 0 },
+/*
+** .pp
+** TLS sessions are remembered for the lifetime of NeoMutt, so that
+** reconnecting to a server can use an abbreviated handshake.  If this
+** variable is set, the sessions are also saved to this file, e.g.
+** "~/.mutt_sessions", next to your $$certificate_file.
+** .pp
+** With OpenSSL, a resumed session skips the certificate checks, so only
+** sessions whose certificates were verified by the system's trusted
+** certificates, or by $$certificate_file, are kept.  Certificates that you
+** accept at the prompt don't qualify.  With GnuTLS, the certificates are
+** checked again, as usual.  The file is only readable by you.
+*/
 #endif
 
 #ifdef USE_SSL_GNUTLS
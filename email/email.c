@@ -35,6 +35,7 @@
 #include "email.h"
 #include "body.h"
 #include "envelope.h"
+#include "mime.h"
 #include "tags.h"
 
 void nm_edata_free(void **ptr);
@@ -131,6 +132,25 @@ size_t email_size(const struct Email *e)
   return e->body->length + e->body->offset - e->body->hdr_offset;
 }
 
+/**
+ * email_structure_known - Is the MIME structure of an Email known?
+ * @param e Email
+ * @retval true The Body describes the whole structure
+ *
+ * A multipart (or message) Email has to be parsed to find its parts, unless
+ * they've already been supplied, e.g. by an IMAP BODYSTRUCTURE.
+ */
+bool email_structure_known(const struct Email *e)
+{
+  if (!e || !e->body)
+    return false;
+
+  if (e->body->parts)
+    return true;
+
+  return (e->body->type != TYPE_MULTIPART) && (e->body->type != TYPE_MESSAGE);
+}
+
 /**
  * header_find - Find a header, matching on its field, in a list of headers
  * @param hdrlist List of headers to search
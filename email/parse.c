@@ -1145,6 +1145,198 @@ size_t mutt_rfc822_read_line(FILE *fp, struct Buffer *buf)
   return read;
 }
 
+/**
+ * mutt_rfc822_read_line_str - Read a header line from a string
+ * @param str Header text, need not be NUL-terminated
+ * @param len Length of the header text
+ * @param buf Buffer to store the result
+ * @retval num Number of bytes consumed from str
+ *
+ * Like mutt_rfc822_read_line(), but for headers that are already in memory.
+ * Continuation lines are unfolded in the same way.
+ */
+size_t mutt_rfc822_read_line_str(const char *str, size_t len, struct Buffer *buf)
+{
+  if (!str || !buf)
+    return 0;
+
+  size_t pos = 0;
+
+  buf_reset(buf);
+  while (pos < len)
+  {
+    const char *line = str + pos;
+    const char *nl = memchr(line, '\n', len - pos);
+    const size_t linelen = nl ? (nl - line + 1) : (len - pos);
+
+    if (mutt_str_is_email_wsp(line[0]) && buf_is_empty(buf))
+      return pos + linelen;
+
+    pos += linelen;
+
+    if (!nl)
+    {
+      buf_addstr_n(buf, line, linelen);
+      break;
+    }
+
+    /* We got a full line: remove trailing space */
+    size_t end = linelen;
+    while ((end > 0) && mutt_str_is_email_wsp(line[end - 1]))
+      end--;
+    buf_addstr_n(buf, line, end);
+
+    /* check to see if the next line is a continuation line */
+    if ((pos >= len) || ((str[pos] != ' ') && (str[pos] != '\t')))
+      break;
+
+    /* eat tabs and spaces from the beginning of the continuation line */
+    while ((pos < len) && ((str[pos] == ' ') || (str[pos] == '\t')))
+      pos++;
+
+    buf_addch(buf, ' ');
+  }
+
+  return pos;
+}
+
+/**
+ * rfc822_header_init - Prepare an Email for header parsing
+ * @param e Email (optional)
+ */
+static void rfc822_header_init(struct Email *e)
+{
+  if (!e || e->body)
+    return;
+
+  e->body = mutt_body_new();
+
+  /* set the defaults from RFC1521 */
+  e->body->type = TYPE_TEXT;
+  e->body->subtype = mutt_str_dup("plain");
+  e->body->encoding = ENC_7BIT;
+  e->body->length = -1;
+
+  /* RFC2183 says this is arbitrary */
+  e->body->disposition = DISP_INLINE;
+}
+
+/**
+ * rfc822_header_line - Parse one unfolded header line
+ * @param env       Envelope to fill
+ * @param e         Current Email (optional)
+ * @param line      Unfolded header line, will be modified
+ * @param user_hdrs If set, store user headers
+ * @param weed      If set, honor the header weed list
+ * @retval true  The line was a header field (or was ignored)
+ * @retval false The line marks the end of the header
+ */
+static bool rfc822_header_line(struct Envelope *env, struct Email *e,
+                               struct Buffer *line, bool user_hdrs, bool weed)
+{
+  const char *lines = buf_string(line);
+  char *p = strpbrk(lines, ": \t");
+  if (!p || (*p != ':'))
+  {
+    char return_path[1024] = { 0 };
+    time_t t = 0;
+
+    /* some bogus MTAs will quote the original "From " line */
+    if (mutt_str_startswith(lines, ">From "))
+    {
+      return true; /* just ignore */
+    }
+    else if (is_from(lines, return_path, sizeof(return_path), &t))
+    {
+      /* MH sometimes has the From_ line in the middle of the header! */
+      if (e && (e->received == 0))
+        e->received = t - mutt_date_local_tz(t);
+      return true;
+    }
+
+    return false; /* end of header */
+  }
+  size_t name_len = p - lines;
+
+  char buf[1024] = { 0 };
+  if (mutt_replacelist_match(&SpamList, buf, sizeof(buf), lines))
+  {
+    if (!mutt_regexlist_match(&NoSpamList, lines))
+    {
+      /* if spam tag already exists, figure out how to amend it */
+      if ((!buf_is_empty(&env->spam)) && (*buf != '\0'))
+      {
+        /* If `$spam_separator` defined, append with separator */
+        const char *const c_spam_separator = cs_subset_string(NeoMutt->sub, "spam_separator");
+        if (c_spam_separator)
+        {
+          buf_addstr(&env->spam, c_spam_separator);
+          buf_addstr(&env->spam, buf);
+        }
+        else /* overwrite */
+        {
+          buf_reset(&env->spam);
+          buf_addstr(&env->spam, buf);
+        }
+      }
+      else if (buf_is_empty(&env->spam) && (*buf != '\0'))
+      {
+        /* spam tag is new, and match expr is non-empty; copy */
+        buf_addstr(&env->spam, buf);
+      }
+      else if (buf_is_empty(&env->spam))
+      {
+        /* match expr is empty; plug in null string if no existing tag */
+        buf_addstr(&env->spam, "");
+      }
+
+      if (!buf_is_empty(&env->spam))
+        mutt_debug(LL_DEBUG5, "spam = %s\n", env->spam.data);
+    }
+  }
+
+  *p = '\0';
+  p = mutt_str_skip_email_wsp(p + 1);
+  if (*p == '\0')
+    return true; /* skip empty header fields */
+
+  mutt_rfc822_parse_line(env, e, lines, name_len, p, user_hdrs, weed, true);
+  return true;
+}
+
+/**
+ * rfc822_header_finish - Tidy up an Email after its header has been parsed
+ * @param env Envelope that was filled
+ * @param e   Current Email
+ */
+static void rfc822_header_finish(struct Envelope *env, struct Email *e)
+{
+  rfc2047_decode_envelope(env);
+
+  if (e->received < 0)
+  {
+    mutt_debug(LL_DEBUG1, "resetting invalid received time to 0\n");
+    e->received = 0;
+  }
+
+  /* check for missing or invalid date */
+  if (e->date_sent <= 0)
+  {
+    mutt_debug(LL_DEBUG1, "no date found, using received time from msg separator\n");
+    e->date_sent = e->received;
+  }
+
+#ifdef USE_AUTOCRYPT
+  const bool c_autocrypt = cs_subset_bool(NeoMutt->sub, "autocrypt");
+  if (c_autocrypt)
+  {
+    mutt_autocrypt_process_autocrypt_header(e, env);
+    /* No sense in taking up memory after the header is processed */
+    mutt_autocrypthdr_free(&env->autocrypt);
+  }
+#endif
+}
+
 /**
  * mutt_rfc822_read_header - Parses an RFC822 header
  * @param fp        Stream to read from
@@ -1164,7 +1356,6 @@ struct Envelope *mutt_rfc822_read_header(FILE *fp, struct Email *e, bool user_hd
     return NULL;
 
   struct Envelope *env = mutt_env_new();
-  char *p = NULL;
   LOFF_T loc = e ? e->offset : ftello(fp);
   if (loc < 0)
   {
@@ -1174,22 +1365,7 @@ struct Envelope *mutt_rfc822_read_header(FILE *fp, struct Email *e, bool user_hd
 
   struct Buffer *line = buf_pool_get();
 
-  if (e)
-  {
-    if (!e->body)
-    {
-      e->body = mutt_body_new();
-
-      /* set the defaults from RFC1521 */
-      e->body->type = TYPE_TEXT;
-      e->body->subtype = mutt_str_dup("plain");
-      e->body->encoding = ENC_7BIT;
-      e->body->length = -1;
-
-      /* RFC2183 says this is arbitrary */
-      e->body->disposition = DISP_INLINE;
-    }
-  }
+  rfc822_header_init(e);
 
   while (true)
   {
@@ -1200,77 +1376,15 @@ struct Envelope *mutt_rfc822_read_header(FILE *fp, struct Email *e, bool user_hd
       break;
     }
     loc += len;
-    const char *lines = buf_string(line);
-    p = strpbrk(lines, ": \t");
-    if (!p || (*p != ':'))
-    {
-      char return_path[1024] = { 0 };
-      time_t t = 0;
-
-      /* some bogus MTAs will quote the original "From " line */
-      if (mutt_str_startswith(lines, ">From "))
-      {
-        continue; /* just ignore */
-      }
-      else if (is_from(lines, return_path, sizeof(return_path), &t))
-      {
-        /* MH sometimes has the From_ line in the middle of the header! */
-        if (e && (e->received == 0))
-          e->received = t - mutt_date_local_tz(t);
-        continue;
-      }
 
+    if (!rfc822_header_line(env, e, line, user_hdrs, weed))
+    {
       /* We need to seek back to the start of the body. Note that we
        * keep track of loc ourselves, since calling ftello() incurs
        * a syscall, which can be expensive to do for every single line */
       (void) mutt_file_seek(fp, line_start_loc, SEEK_SET);
       break; /* end of header */
     }
-    size_t name_len = p - lines;
-
-    char buf[1024] = { 0 };
-    if (mutt_replacelist_match(&SpamList, buf, sizeof(buf), lines))
-    {
-      if (!mutt_regexlist_match(&NoSpamList, lines))
-      {
-        /* if spam tag already exists, figure out how to amend it */
-        if ((!buf_is_empty(&env->spam)) && (*buf != '\0'))
-        {
-          /* If `$spam_separator` defined, append with separator */
-          const char *const c_spam_separator = cs_subset_string(NeoMutt->sub, "spam_separator");
-          if (c_spam_separator)
-          {
-            buf_addstr(&env->spam, c_spam_separator);
-            buf_addstr(&env->spam, buf);
-          }
-          else /* overwrite */
-          {
-            buf_reset(&env->spam);
-            buf_addstr(&env->spam, buf);
-          }
-        }
-        else if (buf_is_empty(&env->spam) && (*buf != '\0'))
-        {
-          /* spam tag is new, and match expr is non-empty; copy */
-          buf_addstr(&env->spam, buf);
-        }
-        else if (buf_is_empty(&env->spam))
-        {
-          /* match expr is empty; plug in null string if no existing tag */
-          buf_addstr(&env->spam, "");
-        }
-
-        if (!buf_is_empty(&env->spam))
-          mutt_debug(LL_DEBUG5, "spam = %s\n", env->spam.data);
-      }
-    }
-
-    *p = '\0';
-    p = mutt_str_skip_email_wsp(p + 1);
-    if (*p == '\0')
-      continue; /* skip empty header fields */
-
-    mutt_rfc822_parse_line(env, e, lines, name_len, p, user_hdrs, weed, true);
   }
 
   buf_pool_release(&line);
@@ -1280,30 +1394,58 @@ struct Envelope *mutt_rfc822_read_header(FILE *fp, struct Email *e, bool user_hd
     e->body->hdr_offset = e->offset;
     e->body->offset = ftello(fp);
 
-    rfc2047_decode_envelope(env);
+    rfc822_header_finish(env, e);
+  }
 
-    if (e->received < 0)
-    {
-      mutt_debug(LL_DEBUG1, "resetting invalid received time to 0\n");
-      e->received = 0;
-    }
+  return env;
+}
 
-    /* check for missing or invalid date */
-    if (e->date_sent <= 0)
-    {
-      mutt_debug(LL_DEBUG1, "no date found, using received time from msg separator\n");
-      e->date_sent = e->received;
-    }
+/**
+ * mutt_rfc822_read_header_str - Parses an RFC822 header held in memory
+ * @param str       Header text, need not be NUL-terminated
+ * @param len       Length of the header text
+ * @param e         Current Email (optional)
+ * @param user_hdrs If set, store user headers
+ * @param weed      If set, honor the header weed list for user headers
+ * @retval ptr Newly allocated envelope structure
+ *
+ * Like mutt_rfc822_read_header(), but without a stream.  The body offset is
+ * set relative to the start of str.
+ *
+ * Caller should free the Envelope using mutt_env_free().
+ */
+struct Envelope *mutt_rfc822_read_header_str(const char *str, size_t len,
+                                             struct Email *e, bool user_hdrs, bool weed)
+{
+  if (!str)
+    return NULL;
 
-#ifdef USE_AUTOCRYPT
-    const bool c_autocrypt = cs_subset_bool(NeoMutt->sub, "autocrypt");
-    if (c_autocrypt)
-    {
-      mutt_autocrypt_process_autocrypt_header(e, env);
-      /* No sense in taking up memory after the header is processed */
-      mutt_autocrypthdr_free(&env->autocrypt);
-    }
-#endif
+  struct Envelope *env = mutt_env_new();
+  struct Buffer *line = buf_pool_get();
+  size_t pos = 0;
+
+  rfc822_header_init(e);
+
+  while (pos < len)
+  {
+    const size_t used = mutt_rfc822_read_line_str(str + pos, len - pos, line);
+    if (buf_is_empty(line))
+      break;
+
+    if (!rfc822_header_line(env, e, line, user_hdrs, weed))
+      break; /* end of header */
+
+    pos += used;
+  }
+
+  buf_pool_release(&line);
+
+  if (e)
+  {
+    e->body->hdr_offset = e->offset;
+    e->body->offset = e->offset + pos;
+
+    rfc822_header_finish(env, e);
   }
 
   return env;
@@ -52,6 +52,7 @@ void         mutt_edit_file(const char *editor, const char *file);
 void         mutt_endwin(void);
 void         mutt_flushinp(void);
 struct KeyEvent mutt_getch(GetChFlags flags);
+bool         mutt_key_pending(void);
 void         mutt_need_hard_redraw(void);
 void         mutt_paddstr(struct MuttWindow *win, int n, const char *s);
 void         mutt_push_macro_event(int ch, int op);
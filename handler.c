@@ -889,6 +889,37 @@ static int external_body_handler(struct Body *b_email, struct State *state)
                     b_email->parts->offset, chflags, NULL, 0);
     }
   }
+  else if (mutt_istr_equal(access_type, "x-neomutt-partial"))
+  {
+    if (state->flags & STATE_DISPLAY)
+    {
+      char pretty_size[10] = { 0 };
+      const char *length = mutt_param_get(&b_email->parameter, "length");
+      mutt_str_pretty_size(pretty_size, sizeof(pretty_size),
+                           length ? strtol(length, NULL, 10) : 0);
+
+      /* L10N: If the translation of this string is a multi line string, then
+         each line should start with "[-- " and end with " --]".
+         The "%s/%s" is a MIME type, e.g. "text/plain".  The last %s is the
+         size of the attachment, e.g. "4.6M". */
+      snprintf(strbuf, sizeof(strbuf),
+               _("[-- This %s/%s attachment (size %s) hasn't been downloaded, --]\n[-- view the attachments to fetch it --]\n"),
+               TYPE(b_email->parts), b_email->parts->subtype, pretty_size);
+      state_attach_puts(state, strbuf);
+      if (b_email->parts->filename)
+      {
+        state_mark_attach(state);
+        state_printf(state, _("[-- name: %s --]\n"), b_email->parts->filename);
+      }
+
+      CopyHeaderFlags chflags = CH_DECODE | CH_DISPLAY;
+      if (c_weed)
+        chflags |= CH_WEED | CH_REORDER;
+
+      mutt_copy_hdr(state->fp_in, state->fp_out, ftello(state->fp_in),
+                    b_email->parts->offset, chflags, NULL, 0);
+    }
+  }
   else if (expiration && (expire < mutt_date_now()))
   {
     if (state->flags & STATE_DISPLAY)
@@ -252,6 +252,9 @@ static void *dump_email(struct HeaderCache *hc, const struct Email *e, int *off,
 
   d = serial_dump_envelope(e->env, d, off, convert);
   d = serial_dump_body(e->body, d, off, convert);
+  /* Only IMAP (with $imap_fetch_envelope) knows the parts without parsing the
+   * message; they're cheap to rebuild for local mailboxes */
+  d = serial_dump_body_parts((uidvalidity != 0) ? e->body->parts : NULL, d, off, convert);
   d = serial_dump_tags(&e->tags, d, off);
 
   return d;
@@ -299,6 +302,7 @@ static struct Email *restore_email(const unsigned char *d)
 
   e->body = mutt_body_new();
   serial_restore_body(e->body, d, &off, convert);
+  serial_restore_body_parts(&e->body->parts, d, &off, convert);
   serial_restore_tags(&e->tags, d, &off);
 
   return e;
@@ -662,6 +666,35 @@ char *hcache_fetch_raw_str(struct HeaderCache *hc, const char *key, size_t keyle
   return res;
 }
 
+/**
+ * hcache_fetch_raw - Fetch a binary blob from the cache
+ * @param[in]  hc     Pointer to the struct HeaderCache structure got by hcache_open()
+ * @param[in]  key    Message identification string
+ * @param[in]  keylen Length of the string pointed to by key
+ * @param[out] dlen   Length of the data
+ * @retval ptr  Success, a copy of the data, which the caller must free
+ * @retval NULL Otherwise
+ */
+void *hcache_fetch_raw(struct HeaderCache *hc, const char *key, size_t keylen, size_t *dlen)
+{
+  if (!hc || !dlen)
+    return NULL;
+
+  void *res = NULL;
+  size_t srclen = 0;
+
+  struct RealKey *rk = realkey(hc, key, keylen, false);
+  void *src = hc->store_ops->fetch(hc->store_handle, rk->key, rk->keylen, &srclen);
+  if (src)
+  {
+    res = mutt_mem_malloc(MAX(srclen, 1));
+    memcpy(res, src, srclen);
+    *dlen = srclen;
+    free_raw(hc, &src);
+  }
+  return res;
+}
+
 /**
  * hcache_store_email - Multiplexor for StoreOps::store
  */
@@ -157,6 +157,7 @@ int hcache_store_email(struct HeaderCache *hc, const char *key, size_t keylen, s
 struct HCacheEntry hcache_fetch_email(struct HeaderCache *hc, const char *key, size_t keylen, uint32_t uidvalidity);
 
 char *hcache_fetch_raw_str(struct HeaderCache *hc, const char *key, size_t keylen);
+void *hcache_fetch_raw    (struct HeaderCache *hc, const char *key, size_t keylen, size_t *dlen);
 bool  hcache_fetch_raw_obj_full(struct HeaderCache *hc, const char *key, size_t keylen, void *dst, size_t dstlen);
 #define hcache_fetch_raw_obj(hc, key, keylen, dst) hcache_fetch_raw_obj_full(hc, key, keylen, dst, sizeof(*dst))
 
@@ -573,6 +573,59 @@ void serial_restore_body(struct Body *b, const unsigned char *d, int *off, bool
   serial_restore_char(&b->d_filename, d, off, convert);
 }
 
+/**
+ * serial_dump_body_parts - Pack a list of MIME parts into a binary blob
+ * @param[in]     parts   First Body of the list (may be NULL)
+ * @param[in]     d       Binary blob to add to
+ * @param[in,out] off     Offset into the blob
+ * @param[in]     convert If true, the strings will be converted to utf-8
+ * @retval ptr End of the newly packed binary
+ *
+ * The sub-parts of each Body are packed recursively.
+ */
+unsigned char *serial_dump_body_parts(const struct Body *parts, unsigned char *d,
+                                      int *off, bool convert)
+{
+  unsigned int counter = 0;
+  for (const struct Body *b = parts; b; b = b->next)
+    counter++;
+
+  d = serial_dump_int(counter, d, off);
+
+  for (const struct Body *b = parts; b; b = b->next)
+  {
+    d = serial_dump_body(b, d, off, convert);
+    d = serial_dump_body_parts(b->parts, d, off, convert);
+  }
+
+  return d;
+}
+
+/**
+ * serial_restore_body_parts - Unpack a list of MIME parts from a binary blob
+ * @param[out]    parts   Store the unpacked list here
+ * @param[in]     d       Binary blob to read from
+ * @param[in,out] off     Offset into the blob
+ * @param[in]     convert If true, the strings will be converted from utf-8
+ */
+void serial_restore_body_parts(struct Body **parts, const unsigned char *d,
+                               int *off, bool convert)
+{
+  unsigned int counter = 0;
+  serial_restore_int(&counter, d, off);
+
+  while (counter > 0)
+  {
+    struct Body *b = mutt_body_new();
+    serial_restore_body(b, d, off, convert);
+    serial_restore_body_parts(&b->parts, d, off, convert);
+
+    *parts = b;
+    parts = &b->next;
+    counter--;
+  }
+}
+
 /**
  * serial_dump_envelope - Pack an Envelope into a binary blob
  * @param[in]     env     Envelope to pack
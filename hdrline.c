@@ -1494,6 +1494,9 @@ long index_X_num(const struct ExpandoNode *node, void *data, MuttFormatFlags fla
 
   struct Mailbox *m = hfi->mailbox;
 
+  if (e->attach_valid || email_structure_known(e))
+    return mutt_count_body_parts(m, e, NULL);
+
   struct Message *msg = mx_msg_open(m, e);
   if (!msg)
     return 0;
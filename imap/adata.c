@@ -59,6 +59,15 @@ static int imap_timeout_observer(struct NotifyCallback *nc)
     imap_check_mailbox(adata->mailbox, true);
   }
 
+  imap_status_flush(adata);
+
+  /* Spare connections have no Mailbox, only the main ones look after them */
+  if (adata->mailbox)
+  {
+    const short c_imap_pool_timeout = cs_subset_number(NeoMutt->sub, "imap_pool_timeout");
+    mutt_conn_pool_check(c_imap_keep_alive, c_imap_pool_timeout);
+  }
+
   mutt_debug(LL_DEBUG5, "imap timeout done\n");
   return 0;
 }
@@ -75,6 +84,8 @@ void imap_adata_free(void **ptr)
 
   notify_observer_remove(NeoMutt->notify_timeout, imap_timeout_observer, adata);
 
+  imap_secondary_put(&adata->status_sec);
+
   FREE(&adata->capstr);
   buf_dealloc(&adata->cmdbuf);
   FREE(&adata->buf);
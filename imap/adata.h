@@ -41,6 +41,7 @@ struct ImapAccountData
   struct Connection *conn; ///< Connection to IMAP server
   bool recovering;
   bool closing;         ///< If true, we are waiting for CLOSE completion
+  bool finishing;       ///< imap_cmd_finish() is updating the Mailbox, don't send commands
   unsigned char state;  ///< ImapState, e.g. #IMAP_AUTHENTICATED
   unsigned char status; ///< ImapFlags, e.g. #IMAP_FATAL
   /* let me explain capstr: SASL needs the capability string (not bits).
@@ -61,6 +62,7 @@ struct ImapAccountData
 
   bool unicode; ///< If true, we can send UTF-8, and the server will use UTF8 rather than mUTF7
   bool qresync; ///< true, if QRESYNC is successfully ENABLE'd
+  bool notify;  ///< true, if NOTIFY is watching the Account's Mailboxes
 
   // if set, the response parser will store results for complicated commands here
   struct ImapList *cmdresult;
@@ -76,6 +78,7 @@ struct ImapAccountData
   struct Mailbox *mailbox;      ///< Current selected mailbox
   struct Mailbox *prev_mailbox; ///< Previously selected mailbox
   struct Account *account;      ///< Parent Account
+  struct ImapAccountData *status_sec; ///< Secondary connection with queued STATUS commands
 };
 
 void                    imap_adata_free(void **ptr);
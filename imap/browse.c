@@ -197,6 +197,7 @@ static int browse_add_list_result(struct ImapAccountData *adata, const char *cmd
 int imap_browse(const char *path, struct BrowserState *state)
 {
   struct ImapAccountData *adata = NULL;
+  struct ImapAccountData *sec = NULL;
   struct ImapList list = { 0 };
   struct ConnAccount cac = { { 0 } };
   char buf[PATH_MAX + 16];
@@ -233,6 +234,11 @@ int imap_browse(const char *path, struct BrowserState *state)
   if (!adata)
     goto fail;
 
+  /* Don't make the selected Mailbox wait for the folder list */
+  sec = imap_secondary_get(adata);
+  if (sec)
+    adata = sec;
+
   const bool c_imap_list_subscribed = cs_subset_bool(NeoMutt->sub, "imap_list_subscribed");
   if (c_imap_list_subscribed)
   {
@@ -376,11 +382,13 @@ int imap_browse(const char *path, struct BrowserState *state)
 
   mutt_clear_error();
 
+  imap_secondary_put(&sec);
   cs_subset_str_native_set(NeoMutt->sub, "imap_check_subscribed",
                            c_imap_check_subscribed, NULL);
   return 0;
 
 fail:
+  imap_secondary_put(&sec);
   cs_subset_str_native_set(NeoMutt->sub, "imap_check_subscribed",
                            c_imap_check_subscribed, NULL);
   return -1;
@@ -87,6 +87,10 @@ static const char *const Capabilities[] = {
   "COMPRESS=DEFLATE",
   "X-GM-EXT-1",
   "ID",
+  "SORT",
+  "LITERAL+",
+  "LITERAL-",
+  "NOTIFY",
   NULL,
 };
 
@@ -266,13 +270,18 @@ static void cmd_parse_expunge(struct ImapAccountData *adata, const char *s)
 
   struct ImapMboxData *mdata = adata->mailbox->mdata;
 
-  if (!mutt_str_atoui(s, &exp_msn) || (exp_msn < 1) ||
-      (exp_msn > imap_msn_highest(&mdata->msn)))
+  /* The MSN index is compacted once the run of expunges is over,
+   * see cmd_expunge_flush() */
+  if (!mdata->expunge)
+    mdata->expunge = imap_msn_expunge_new(&mdata->msn);
+
+  if (!mutt_str_atoui(s, &exp_msn) || (exp_msn < 1) || (exp_msn > mdata->expunge->live))
   {
     return;
   }
 
-  e = imap_msn_get(&mdata->msn, exp_msn - 1);
+  const size_t idx = imap_msn_expunge_find(mdata->expunge, exp_msn);
+  e = imap_msn_get(&mdata->msn, idx);
   if (e)
   {
     /* imap_expunge_mailbox() will rewrite e->index.
@@ -282,16 +291,11 @@ static void cmd_parse_expunge(struct ImapAccountData *adata, const char *s)
     imap_edata_get(e)->msn = 0;
   }
 
-  /* decrement seqno of those above. */
-  const size_t max_msn = imap_msn_highest(&mdata->msn);
-  for (unsigned int cur = exp_msn; cur < max_msn; cur++)
-  {
-    e = imap_msn_get(&mdata->msn, cur);
-    if (e)
-      imap_edata_get(e)->msn--;
-    imap_msn_set(&mdata->msn, cur - 1, e);
-  }
-  imap_msn_shrink(&mdata->msn, 1);
+  imap_msn_expunge_mark(mdata->expunge, idx);
+
+  /* an unloaded message was removed */
+  if (exp_msn <= mdata->deferred_msn)
+    mdata->deferred_msn--;
 
   mdata->reopen |= IMAP_EXPUNGE_PENDING;
 }
@@ -367,17 +371,10 @@ static void cmd_parse_vanished(struct ImapAccountData *adata, char *s)
 
     if (!earlier)
     {
-      /* decrement seqno of those above. */
-      const size_t max_msn = imap_msn_highest(&mdata->msn);
-      for (unsigned int cur = exp_msn; cur < max_msn; cur++)
-      {
-        e = imap_msn_get(&mdata->msn, cur);
-        if (e)
-          imap_edata_get(e)->msn--;
-        imap_msn_set(&mdata->msn, cur - 1, e);
-      }
-
-      imap_msn_shrink(&mdata->msn, 1);
+      /* the slot is squeezed out by cmd_expunge_flush() */
+      if (!mdata->expunge)
+        mdata->expunge = imap_msn_expunge_new(&mdata->msn);
+      imap_msn_expunge_mark(mdata->expunge, exp_msn - 1);
     }
   }
 
@@ -389,6 +386,52 @@ static void cmd_parse_vanished(struct ImapAccountData *adata, char *s)
   mutt_seqset_iterator_free(&iter);
 }
 
+/**
+ * cmd_parse_modified - Parse a MODIFIED response code
+ * @param adata Imap Account data
+ * @param s     Tagged command completion
+ *
+ * A conditional `UID STORE ... (UNCHANGEDSINCE modseq)` (RFC7162) leaves alone
+ * any message that another client has changed.  The command completes with
+ * `OK [MODIFIED uid-set]`, listing the messages that weren't updated.  Save the
+ * UIDs, so that imap_sync_mailbox() can fetch their new flags.
+ */
+static void cmd_parse_modified(struct ImapAccountData *adata, char *s)
+{
+  struct ImapMboxData *mdata = imap_mdata_get(adata->mailbox);
+  if (!mdata)
+    return;
+
+  /* skip the tag and OK/NO */
+  s = imap_next_word(s);
+  s = imap_next_word(s);
+
+  size_t plen = mutt_istr_startswith(s, "[MODIFIED ");
+  if (plen == 0)
+    return;
+  s += plen;
+
+  char *end = strchr(s, ']');
+  if (!end)
+  {
+    mutt_debug(LL_DEBUG1, "Unterminated MODIFIED response: %s\n", s);
+    return;
+  }
+  *end = '\0';
+
+  mutt_debug(LL_DEBUG2, "Conditional STORE skipped UIDs %s\n", s);
+  struct SeqsetIterator *iter = mutt_seqset_iterator_new(s);
+  if (iter)
+  {
+    unsigned int uid = 0;
+    while (mutt_seqset_iterator_next(iter, &uid) == 0)
+      ARRAY_ADD(&mdata->modified, uid);
+    mutt_seqset_iterator_free(&iter);
+  }
+
+  *end = ']';
+}
+
 /**
  * cmd_parse_fetch - Load fetch response into ImapAccountData
  * @param adata Imap Account data
@@ -403,7 +446,6 @@ static void cmd_parse_fetch(struct ImapAccountData *adata, char *s)
   unsigned int msn, uid;
   struct Email *e = NULL;
   char *flags = NULL;
-  int uid_checked = 0;
   bool server_changes = false;
 
   struct ImapMboxData *mdata = imap_mdata_get(adata->mailbox);
@@ -448,9 +490,6 @@ static void cmd_parse_fetch(struct ImapAccountData *adata, char *s)
     if (plen != 0)
     {
       flags = s;
-      if (uid_checked)
-        break;
-
       s += plen;
       SKIPWS(s);
       if (*s != '(')
@@ -485,9 +524,6 @@ static void cmd_parse_fetch(struct ImapAccountData *adata, char *s)
         mutt_debug(LL_DEBUG1, "UID vs MSN mismatch.  Skipping update\n");
         return;
       }
-      uid_checked = 1;
-      if (flags)
-        break;
       s = imap_next_word(s);
     }
     else if ((plen = mutt_istr_startswith(s, "MODSEQ")))
@@ -500,6 +536,10 @@ static void cmd_parse_fetch(struct ImapAccountData *adata, char *s)
         return;
       }
       s++;
+      /* Remember the Email's mod-sequence, for conditional STOREs.
+       * mdata->modseq must stay at the server's HIGHESTMODSEQ, because it's
+       * saved in the header cache, along with Emails that may be stale. */
+      mutt_str_atoull(s, &imap_edata_get(e)->modseq);
       while (*s && (*s != ')'))
         s++;
       if (*s == ')')
@@ -528,6 +568,8 @@ static void cmd_parse_fetch(struct ImapAccountData *adata, char *s)
     imap_set_flags(adata->mailbox, e, flags, &server_changes);
     if (server_changes)
     {
+      imap_edata_get(e)->hcache_stale = true;
+
       /* If server flags could conflict with NeoMutt's flags, reopen the mailbox. */
       if (e->changed)
         mdata->reopen |= IMAP_EXPUNGE_PENDING;
@@ -853,6 +895,13 @@ static void cmd_parse_status(struct ImapAccountData *adata, char *s)
     mutt_debug(LL_DEBUG3, "Received status for an unexpected mailbox: %s\n", mailbox);
     return;
   }
+
+  /* The selected mailbox is kept up to date by EXISTS, EXPUNGE and FETCH */
+  if (m == adata->mailbox)
+  {
+    mutt_debug(LL_DEBUG3, "Ignoring status for the selected mailbox: %s\n", mailbox);
+    return;
+  }
   uint32_t olduv = mdata->uidvalidity;
   unsigned int oldun = mdata->uid_next;
 
@@ -1013,6 +1062,41 @@ static void cmd_parse_exists(struct ImapAccountData *adata, const char *pn)
   }
 }
 
+/**
+ * cmd_is_expunge - Is the response an EXPUNGE or VANISHED?
+ * @param adata Imap Account data
+ * @retval true The buffer holds an untagged EXPUNGE or VANISHED response
+ */
+static bool cmd_is_expunge(struct ImapAccountData *adata)
+{
+  if ((adata->state < IMAP_SELECTED) || !mutt_str_startswith(adata->buf, "* "))
+    return false;
+
+  char *s = imap_next_word(adata->buf);
+  if (mutt_istr_startswith(s, "VANISHED"))
+    return true;
+
+  return isdigit((unsigned char) *s) && mutt_istr_startswith(imap_next_word(s), "EXPUNGE");
+}
+
+/**
+ * cmd_expunge_flush - Apply a run of expunges to the MSN index
+ * @param adata Imap Account data
+ *
+ * EXPUNGE and VANISHED responses only mark the slots they remove.  Once the
+ * run is over, the MSN index is compacted in a single pass.
+ */
+static void cmd_expunge_flush(struct ImapAccountData *adata)
+{
+  struct ImapMboxData *mdata = imap_mdata_get(adata->mailbox);
+  if (!mdata || !mdata->expunge)
+    return;
+
+  mutt_debug(LL_DEBUG2, "Compacting MSN index, %zu of %zu expunged\n",
+             mdata->expunge->size - mdata->expunge->live, mdata->expunge->size);
+  imap_msn_expunge_apply(&mdata->msn, &mdata->expunge);
+}
+
 /**
  * cmd_handle_untagged - Fallback parser for otherwise unhandled messages
  * @param adata Imap Account data
@@ -1146,8 +1230,10 @@ int imap_cmd_step(struct ImapAccountData *adata)
     return IMAP_RES_BAD;
   }
 
+read_line:
   /* read into buffer, expanding buffer as necessary until we have a full
    * line */
+  len = 0;
   do
   {
     if (len == adata->blen)
@@ -1164,6 +1250,7 @@ int imap_cmd_step(struct ImapAccountData *adata)
     if (c <= 0)
     {
       mutt_debug(LL_DEBUG1, "Error reading server response\n");
+      cmd_expunge_flush(adata);
       cmd_handle_fatal(adata);
       return IMAP_RES_BAD;
     }
@@ -1185,14 +1272,28 @@ int imap_cmd_step(struct ImapAccountData *adata)
 
   adata->lastread = mutt_date_now();
 
+  /* anything other than an expunge needs an up-to-date MSN index */
+  const bool expunge = cmd_is_expunge(adata);
+  if (!expunge)
+    cmd_expunge_flush(adata);
+
   /* handle untagged messages. The caller still gets its shot afterwards. */
   if ((mutt_str_startswith(adata->buf, "* ") ||
        mutt_str_startswith(imap_next_word(adata->buf), "OK [")) &&
       cmd_handle_untagged(adata))
   {
+    cmd_expunge_flush(adata);
     return IMAP_RES_BAD;
   }
 
+  /* Soak up a storm of expunges before the caller sees the MSN index again */
+  if (expunge)
+  {
+    if (mutt_socket_poll(adata->conn, 0) > 0)
+      goto read_line;
+    cmd_expunge_flush(adata);
+  }
+
   /* server demands a continuation response from us */
   if (adata->buf[0] == '+')
     return IMAP_RES_RESPOND;
@@ -1223,6 +1324,8 @@ int imap_cmd_step(struct ImapAccountData *adata)
         }
         cmd->state = cmd_status(adata->buf);
         rc = cmd->state;
+        if (cmd->state != IMAP_RES_BAD)
+          cmd_parse_modified(adata, adata->buf);
         if (cmd->state == IMAP_RES_NO || cmd->state == IMAP_RES_BAD)
         {
           mutt_message(_("IMAP command failed: %s"), adata->buf);
@@ -1393,15 +1496,19 @@ void imap_cmd_finish(struct ImapAccountData *adata)
 
   if (mdata && mdata->reopen & IMAP_REOPEN_ALLOW)
   {
+    /* The observers of the Mailbox may resort it, but mustn't send commands */
+    adata->finishing = true;
+
     // First remove expunged emails from the msn_index
     if (mdata->reopen & IMAP_EXPUNGE_PENDING)
     {
       mutt_debug(LL_DEBUG2, "Expunging mailbox\n");
-      imap_expunge_mailbox(adata->mailbox, true);
       /* Detect whether we've gotten unexpected EXPUNGE messages */
       if (!(mdata->reopen & IMAP_EXPUNGE_EXPECTED))
         mdata->check_status |= IMAP_EXPUNGE_PENDING;
+      /* Clear the flags before the expunge notifies anyone */
       mdata->reopen &= ~(IMAP_EXPUNGE_PENDING | IMAP_EXPUNGE_EXPECTED);
+      imap_expunge_mailbox(adata->mailbox, true);
     }
 
     // Then add new emails to it
@@ -1425,6 +1532,8 @@ void imap_cmd_finish(struct ImapAccountData *adata)
 
     if (mdata->reopen & IMAP_EXPUNGE_PENDING)
       mdata->reopen &= ~(IMAP_EXPUNGE_PENDING | IMAP_EXPUNGE_EXPECTED);
+
+    adata->finishing = false;
   }
 
   adata->status = 0;
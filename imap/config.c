@@ -85,6 +85,12 @@ static struct ConfigDef ImapVars[] = {
   { "imap_fetch_chunk_size", DT_LONG|D_INTEGER_NOT_NEGATIVE, 0, 0, NULL,
     "(imap) Download headers in blocks of this size"
   },
+  { "imap_fetch_envelope", DT_BOOL, false, 0, NULL,
+    "(imap) Fetch the server-parsed ENVELOPE and BODYSTRUCTURE instead of headers"
+  },
+  { "imap_fetch_newest", DT_LONG|D_INTEGER_NOT_NEGATIVE, 0, 0, NULL,
+    "(imap) Download only the newest headers when opening a mailbox"
+  },
   { "imap_headers", DT_STRING, 0, 0, NULL,
     "(imap) Additional email headers to download when getting index"
   },
@@ -94,21 +100,36 @@ static struct ConfigDef ImapVars[] = {
   { "imap_login", DT_STRING|D_SENSITIVE, 0, 0, NULL,
     "(imap) Login name for the IMAP server (defaults to `$imap_user`)"
   },
+  { "imap_notify", DT_BOOL, false, 0, NULL,
+    "(imap) Use NOTIFY to learn of new mail, instead of polling"
+  },
   { "imap_oauth_refresh_command", DT_STRING|D_STRING_COMMAND|D_SENSITIVE, 0, 0, NULL,
     "(imap) External command to generate OAUTH refresh token"
   },
+  { "imap_partial_fetch_size", DT_LONG|D_INTEGER_NOT_NEGATIVE, 0, 0, NULL,
+    "(imap) Only fetch the text parts of larger messages for display"
+  },
   { "imap_pass", DT_STRING|D_SENSITIVE, 0, 0, NULL,
     "(imap) Password for the IMAP server"
   },
   { "imap_pipeline_depth", DT_NUMBER|D_INTEGER_NOT_NEGATIVE, 15, 0, NULL,
     "(imap) Number of IMAP commands that may be queued up"
   },
+  { "imap_prefetch", DT_NUMBER|D_INTEGER_NOT_NEGATIVE, 0, 0, NULL,
+    "(imap) Number of following messages to download when opening a message"
+  },
+  { "imap_prefetch_size", DT_LONG|D_INTEGER_NOT_NEGATIVE, 1048576, 0, NULL,
+    "(imap) Maximum number of bytes to prefetch when opening a message"
+  },
   { "imap_rfc5161", DT_BOOL, true, 0, NULL,
     "(imap) Use the IMAP ENABLE extension to select capabilities"
   },
   { "imap_server_noise", DT_BOOL, true, 0, NULL,
     "(imap) Display server warnings as error messages"
   },
+  { "imap_server_sort", DT_BOOL, false, 0, NULL,
+    "(imap) Let the server sort the mailbox, if it supports SORT"
+  },
   { "imap_keep_alive", DT_NUMBER|D_INTEGER_NOT_NEGATIVE, 300, 0, NULL,
     "(imap) Time to wait before polling an open IMAP connection"
   },
@@ -124,6 +145,9 @@ static struct ConfigDef ImapVars[] = {
   { "imap_poll_timeout", DT_NUMBER|D_INTEGER_NOT_NEGATIVE, 15, 0, NULL,
     "(imap) Maximum time to wait for a server response"
   },
+  { "imap_pool_timeout", DT_NUMBER|D_INTEGER_NOT_NEGATIVE, 0, 0, NULL,
+    "(imap) Keep an idle secondary connection open for this many seconds"
+  },
   { "imap_qresync", DT_BOOL, false, 0, NULL,
     "(imap) Enable the QRESYNC extension"
   },
@@ -46,6 +46,7 @@ void imap_edata_free(void **ptr)
   /* this should be safe even if the list wasn't used */
   FREE(&edata->flags_system);
   FREE(&edata->flags_remote);
+  mutt_body_free(&edata->parts);
 
   FREE(ptr);
 }
@@ -82,5 +83,6 @@ struct ImapEmailData *imap_edata_clone(struct ImapEmailData *src)
   memcpy(dst, src, sizeof(*src));
   dst->flags_system = mutt_str_dup(src->flags_system);
   dst->flags_remote = mutt_str_dup(src->flags_remote);
+  dst->parts = NULL;
   return dst;
 }
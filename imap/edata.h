@@ -26,6 +26,7 @@
 
 #include <stdbool.h>
 
+struct Body;
 struct Email;
 
 /**
@@ -41,12 +42,17 @@ struct ImapEmailData
   bool replied : 1; ///< Email has been replied to
 
   bool parsed : 1;
+  bool hcache_stale : 1; ///< Server flags changed since the Email was cached
+  bool partial : 1;      ///< The Email's parts come from a partial copy, only fit for display
 
   unsigned int uid; ///< 32-bit Message UID
   unsigned int msn; ///< Message Sequence Number
+  unsigned long long modseq; ///< Last mod-sequence seen for the Email
 
   char *flags_system;
   char *flags_remote;
+
+  struct Body *parts; ///< MIME parts from the BODYSTRUCTURE, kept while #partial is set
 };
 
 void                  imap_edata_free(void **ptr);
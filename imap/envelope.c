@@ -0,0 +1,604 @@
+/**
+ * @file
+ * Parse IMAP ENVELOPE and BODYSTRUCTURE responses
+ *
+ * @authors
+ * Copyright (C) 2026 Richard Russon <rich@flatcap.org>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @page imap_envelope Parse ENVELOPE and BODYSTRUCTURE
+ *
+ * Turn the server's pre-parsed ENVELOPE and BODYSTRUCTURE data (RFC3501) into
+ * an Envelope and a tree of Body parts, so that the headers don't need to be
+ * downloaded and parsed locally.
+ *
+ * The parsers work on a complete response, in which any literals have been
+ * inlined as quoted strings.
+ */
+
+#include "config.h"
+#include <ctype.h>
+#include <stdbool.h>
+#include <string.h>
+#include "private.h"
+#include "mutt/lib.h"
+#include "address/lib.h"
+#include "email/lib.h"
+
+/// Deepest nesting of MIME parts we're prepared to parse
+#define IMAP_MAX_BODY_DEPTH 20
+
+/**
+ * imap_parse_nstring - Parse an IMAP string, atom or NIL
+ * @param[in,out] s   String to parse, advanced past the token
+ * @param[out]    buf Buffer for the unquoted value (optional)
+ * @param[out]    nil Set to true if the token was NIL (optional)
+ * @retval true  Success
+ * @retval false Malformed token
+ */
+bool imap_parse_nstring(char **s, struct Buffer *buf, bool *nil)
+{
+  char *p = *s;
+  SKIPWS(p);
+
+  if (buf)
+    buf_reset(buf);
+  if (nil)
+    *nil = false;
+
+  if (*p == '"')
+  {
+    for (p++; *p && (*p != '"'); p++)
+    {
+      if ((*p == '\\') && p[1])
+        p++;
+      if (buf)
+        buf_addch(buf, *p);
+    }
+    if (*p != '"')
+      return false;
+    *s = p + 1;
+    return true;
+  }
+
+  const char *start = p;
+  while (*p && !isspace((unsigned char) *p) && (*p != '(') && (*p != ')'))
+    p++;
+
+  if (p == start)
+    return false;
+
+  if (((p - start) == 3) && mutt_istrn_equal(start, "NIL", 3))
+  {
+    if (nil)
+      *nil = true;
+  }
+  else if (buf)
+  {
+    buf_addstr_n(buf, start, p - start);
+  }
+
+  *s = p;
+  return true;
+}
+
+/**
+ * imap_skip_item - Skip over one data item in a FETCH response
+ * @param s String to parse
+ * @retval ptr  Character following the item
+ * @retval NULL Malformed item
+ *
+ * An item is a string, atom, NIL or a parenthesised list of items.
+ */
+char *imap_skip_item(char *s)
+{
+  SKIPWS(s);
+  if (*s != '(')
+    return imap_parse_nstring(&s, NULL, NULL) ? s : NULL;
+
+  int depth = 0;
+  bool quoted = false;
+  for (; *s; s++)
+  {
+    if (quoted)
+    {
+      if ((*s == '\\') && s[1])
+        s++;
+      else if (*s == '"')
+        quoted = false;
+    }
+    else if (*s == '"')
+    {
+      quoted = true;
+    }
+    else if (*s == '(')
+    {
+      depth++;
+    }
+    else if ((*s == ')') && (--depth == 0))
+    {
+      return s + 1;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * skip_to_close - Skip any remaining items in a list
+ * @param s String to parse, pointing inside a list
+ * @retval ptr  Character following the list's closing parenthesis
+ * @retval NULL Malformed list
+ */
+static char *skip_to_close(char *s)
+{
+  SKIPWS(s);
+  while (*s && (*s != ')'))
+  {
+    s = imap_skip_item(s);
+    if (!s)
+      return NULL;
+    SKIPWS(s);
+  }
+
+  return (*s == ')') ? s + 1 : NULL;
+}
+
+/**
+ * parse_address_list - Parse an ENVELOPE address list
+ * @param[in,out] s  String to parse
+ * @param[out]    al Address list to append to
+ * @retval true  Success
+ * @retval false Malformed list
+ *
+ * Each address is `(name adl mailbox host)`.  A NIL host marks the start of a
+ * group (named by mailbox) or, if mailbox is NIL too, the end of a group.
+ */
+static bool parse_address_list(char **s, struct AddressList *al)
+{
+  char *p = *s;
+  SKIPWS(p);
+
+  bool nil = false;
+  if (*p != '(')
+  {
+    if (!imap_parse_nstring(&p, NULL, &nil) || !nil)
+      return false;
+    *s = p;
+    return true;
+  }
+  p++;
+
+  bool rc = false;
+  struct Buffer *name = buf_pool_get();
+  struct Buffer *mbox = buf_pool_get();
+  struct Buffer *host = buf_pool_get();
+
+  while (true)
+  {
+    SKIPWS(p);
+    if (*p == ')')
+    {
+      p++;
+      break;
+    }
+    if (*p != '(')
+      goto done;
+    p++;
+
+    bool name_nil = false;
+    bool mbox_nil = false;
+    bool host_nil = false;
+    if (!imap_parse_nstring(&p, name, &name_nil) || !imap_parse_nstring(&p, NULL, NULL) ||
+        !imap_parse_nstring(&p, mbox, &mbox_nil) || !imap_parse_nstring(&p, host, &host_nil))
+    {
+      goto done;
+    }
+    p = skip_to_close(p);
+    if (!p)
+      goto done;
+
+    struct Address *a = mutt_addr_new();
+    if (host_nil)
+    {
+      /* group syntax: a NIL mailbox terminates the group */
+      if (!mbox_nil)
+      {
+        a->mailbox = buf_new(buf_string(mbox));
+        a->group = true;
+      }
+    }
+    else
+    {
+      buf_add_printf(mbox, "@%s", buf_string(host));
+      a->mailbox = buf_new(buf_string(mbox));
+      if (!name_nil && !buf_is_empty(name))
+        a->personal = buf_new(buf_string(name));
+    }
+    mutt_addrlist_append(al, a);
+  }
+
+  *s = p;
+  rc = true;
+
+done:
+  buf_pool_release(&name);
+  buf_pool_release(&mbox);
+  buf_pool_release(&host);
+  return rc;
+}
+
+/**
+ * parse_header_field - Parse an ENVELOPE string as if it were a header
+ * @param[in,out] s    String to parse
+ * @param[in]     env  Envelope to fill
+ * @param[in]     e    Email to fill
+ * @param[in]     name Name of the equivalent header, e.g. "subject"
+ * @retval true  Success
+ * @retval false Malformed string
+ */
+static bool parse_header_field(char **s, struct Envelope *env, struct Email *e,
+                               const char *name)
+{
+  struct Buffer *buf = buf_pool_get();
+  bool nil = false;
+
+  const bool rc = imap_parse_nstring(s, buf, &nil);
+  if (rc && !nil && !buf_is_empty(buf))
+  {
+    mutt_rfc822_parse_line(env, e, name, mutt_str_len(name), buf_string(buf),
+                           false, false, false);
+  }
+
+  buf_pool_release(&buf);
+  return rc;
+}
+
+/**
+ * imap_parse_envelope - Parse an ENVELOPE into an Email
+ * @param s ENVELOPE data, starting at the opening parenthesis
+ * @param e Email to fill
+ * @retval  0 Success
+ * @retval -1 Malformed ENVELOPE
+ *
+ * The fields are `(date subject from sender reply-to to cc bcc in-reply-to
+ * message-id)`.  Any existing Envelope of the Email supplies the fields which
+ * the ENVELOPE lacks, e.g. References.
+ */
+int imap_parse_envelope(char *s, struct Email *e)
+{
+  if (!s || !e)
+    return -1;
+
+  SKIPWS(s);
+  if (*s != '(')
+    return -1;
+  s++;
+
+  struct Envelope *env = mutt_env_new();
+
+  if (!parse_header_field(&s, env, e, "date") ||
+      !parse_header_field(&s, env, e, "subject") ||
+      !parse_address_list(&s, &env->from) || !parse_address_list(&s, &env->sender) ||
+      !parse_address_list(&s, &env->reply_to) || !parse_address_list(&s, &env->to) ||
+      !parse_address_list(&s, &env->cc) || !parse_address_list(&s, &env->bcc) ||
+      !parse_header_field(&s, env, e, "in-reply-to") ||
+      !parse_header_field(&s, env, e, "message-id") || !skip_to_close(s))
+  {
+    mutt_env_free(&env);
+    return -1;
+  }
+
+  rfc2047_decode_envelope(env);
+  mutt_env_merge(env, &e->env);
+  e->env = env;
+
+  if (e->date_sent <= 0)
+    e->date_sent = e->received;
+
+  return 0;
+}
+
+/**
+ * parse_params - Parse a BODYSTRUCTURE parameter list
+ * @param[in,out] s  String to parse
+ * @param[out]    pl Parameter list to fill
+ * @retval true  Success
+ * @retval false Malformed list
+ */
+static bool parse_params(char **s, struct ParameterList *pl)
+{
+  char *p = *s;
+  SKIPWS(p);
+
+  bool nil = false;
+  if (*p != '(')
+  {
+    if (!imap_parse_nstring(&p, NULL, &nil) || !nil)
+      return false;
+    *s = p;
+    return true;
+  }
+  p++;
+
+  bool rc = false;
+  struct Buffer *attr = buf_pool_get();
+  struct Buffer *value = buf_pool_get();
+
+  while (true)
+  {
+    SKIPWS(p);
+    if (*p == ')')
+    {
+      p++;
+      break;
+    }
+
+    if (!imap_parse_nstring(&p, attr, NULL) || !imap_parse_nstring(&p, value, NULL))
+      goto done;
+
+    struct Parameter *np = mutt_param_new();
+    np->attribute = buf_strdup(attr);
+    mutt_str_lower(np->attribute);
+    np->value = buf_strdup(value);
+    TAILQ_INSERT_TAIL(pl, np, entries);
+  }
+
+  rfc2231_decode_parameters(pl);
+  *s = p;
+  rc = true;
+
+done:
+  buf_pool_release(&attr);
+  buf_pool_release(&value);
+  return rc;
+}
+
+/**
+ * parse_disposition - Parse a BODYSTRUCTURE disposition
+ * @param[in,out] s String to parse
+ * @param[in]     b Body to fill
+ * @retval true  Success
+ * @retval false Malformed disposition
+ *
+ * The disposition is `("attachment" ("filename" "foo.pdf"))` or NIL.
+ */
+static bool parse_disposition(char **s, struct Body *b)
+{
+  char *p = *s;
+  SKIPWS(p);
+
+  bool nil = false;
+  if (*p != '(')
+  {
+    if (!imap_parse_nstring(&p, NULL, &nil) || !nil)
+      return false;
+    *s = p;
+    return true;
+  }
+  p++;
+
+  struct Buffer *buf = buf_pool_get();
+  struct ParameterList pl = TAILQ_HEAD_INITIALIZER(pl);
+  bool rc = false;
+
+  if (!imap_parse_nstring(&p, buf, NULL) || !parse_params(&p, &pl))
+    goto done;
+
+  p = skip_to_close(p);
+  if (!p)
+    goto done;
+
+  if (mutt_istr_equal(buf_string(buf), "inline"))
+    b->disposition = DISP_INLINE;
+  else if (mutt_istr_equal(buf_string(buf), "attachment"))
+    b->disposition = DISP_ATTACH;
+  else if (mutt_istr_equal(buf_string(buf), "form-data"))
+    b->disposition = DISP_FORM_DATA;
+
+  const char *filename = mutt_param_get(&pl, "filename");
+  if (filename)
+    mutt_str_replace(&b->d_filename, filename);
+
+  *s = p;
+  rc = true;
+
+done:
+  mutt_param_free(&pl);
+  buf_pool_release(&buf);
+  return rc;
+}
+
+/**
+ * parse_body - Parse one level of a BODYSTRUCTURE
+ * @param[in,out] s     String to parse
+ * @param[in]     b     Body to fill
+ * @param[out]    lines Number of lines of a text part (optional)
+ * @param[in]     depth Nesting depth of this part
+ * @retval true  Success
+ * @retval false Malformed BODYSTRUCTURE
+ */
+static bool parse_body(char **s, struct Body *b, long *lines, int depth)
+{
+  char *p = *s;
+  SKIPWS(p);
+  if ((*p != '(') || (depth > IMAP_MAX_BODY_DEPTH))
+    return false;
+  p++;
+  SKIPWS(p);
+
+  struct Buffer *buf = buf_pool_get();
+  bool nil = false;
+  bool rc = false;
+
+  if (*p == '(')
+  {
+    /* multipart: (part)(part)... subtype [params [disposition ...]] */
+    b->type = TYPE_MULTIPART;
+    b->encoding = ENC_7BIT;
+
+    struct Body **last = &b->parts;
+    while (*p == '(')
+    {
+      struct Body *part = mutt_body_new();
+      part->type = TYPE_TEXT;
+      part->encoding = ENC_7BIT;
+      part->disposition = DISP_INLINE;
+      *last = part;
+      last = &part->next;
+
+      if (!parse_body(&p, part, NULL, depth + 1))
+        goto done;
+      SKIPWS(p);
+    }
+
+    if (!imap_parse_nstring(&p, buf, NULL))
+      goto done;
+    mutt_str_replace(&b->subtype, buf_string(buf));
+    mutt_str_lower(b->subtype);
+
+    SKIPWS(p);
+    if ((*p != ')') && (!parse_params(&p, &b->parameter) ||
+                        ((*(p = mutt_str_skip_whitespace(p)) != ')') &&
+                         !parse_disposition(&p, b))))
+    {
+      goto done;
+    }
+  }
+  else
+  {
+    /* type subtype params id description encoding size ... */
+    if (!imap_parse_nstring(&p, buf, NULL))
+      goto done;
+    b->type = mutt_check_mime_type(buf_string(buf));
+    if (b->type == TYPE_OTHER)
+    {
+      mutt_str_replace(&b->xtype, buf_string(buf));
+      mutt_str_lower(b->xtype);
+    }
+
+    if (!imap_parse_nstring(&p, buf, NULL))
+      goto done;
+    mutt_str_replace(&b->subtype, buf_string(buf));
+    mutt_str_lower(b->subtype);
+
+    if (!parse_params(&p, &b->parameter) || !imap_parse_nstring(&p, NULL, NULL))
+      goto done;
+
+    if (!imap_parse_nstring(&p, buf, &nil))
+      goto done;
+    if (!nil && !buf_is_empty(buf))
+      mutt_str_replace(&b->description, buf_string(buf));
+
+    if (!imap_parse_nstring(&p, buf, NULL))
+      goto done;
+    b->encoding = mutt_check_encoding(buf_string(buf));
+
+    if (!imap_parse_nstring(&p, buf, NULL) || !mutt_str_atol(buf_string(buf), &b->length))
+      goto done;
+
+    if ((b->type == TYPE_MESSAGE) && mutt_istr_equal(b->subtype, "rfc822"))
+    {
+      /* envelope, body and lines of the encapsulated message */
+      if (!(p = imap_skip_item(p)) || !(p = imap_skip_item(p)) || !(p = imap_skip_item(p)))
+        goto done;
+    }
+    else if (b->type == TYPE_TEXT)
+    {
+      if (!imap_parse_nstring(&p, buf, NULL))
+        goto done;
+      if (lines)
+        mutt_str_atol(buf_string(buf), lines);
+    }
+
+    /* extension data: md5 [disposition ...] */
+    SKIPWS(p);
+    if ((*p != ')') && (!(p = imap_skip_item(p)) ||
+                        ((*(p = mutt_str_skip_whitespace(p)) != ')') &&
+                         !parse_disposition(&p, b))))
+    {
+      goto done;
+    }
+  }
+
+  /* language, location and future extensions */
+  p = skip_to_close(p);
+  if (!p)
+    goto done;
+
+  *s = p;
+  rc = true;
+
+done:
+  buf_pool_release(&buf);
+  return rc;
+}
+
+/**
+ * imap_parse_bodystructure - Parse a BODYSTRUCTURE into an Email
+ * @param s BODYSTRUCTURE data, starting at the opening parenthesis
+ * @param e Email to fill
+ * @retval  0 Success
+ * @retval -1 Malformed BODYSTRUCTURE
+ *
+ * The top-level Body of the Email is updated in place.  A multipart message
+ * gets its parts attached, which is enough to count attachments without
+ * downloading the message.
+ *
+ * @note The offsets of the parts are unknown.  The parts must be discarded
+ *       before the message itself is parsed.
+ */
+int imap_parse_bodystructure(char *s, struct Email *e)
+{
+  if (!s || !e || !e->body)
+    return -1;
+
+  struct Body *b = mutt_body_new();
+  b->type = TYPE_TEXT;
+  b->encoding = ENC_7BIT;
+  b->disposition = DISP_INLINE;
+
+  long lines = 0;
+  if (!parse_body(&s, b, &lines, 0))
+  {
+    mutt_body_free(&b);
+    return -1;
+  }
+
+  struct Body *eb = e->body;
+  eb->type = b->type;
+  eb->encoding = b->encoding;
+  eb->disposition = b->disposition;
+  mutt_str_replace(&eb->xtype, b->xtype);
+  mutt_str_replace(&eb->subtype, b->subtype);
+  mutt_str_replace(&eb->description, b->description);
+  mutt_str_replace(&eb->d_filename, b->d_filename);
+
+  mutt_param_free(&eb->parameter);
+  TAILQ_SWAP(&eb->parameter, &b->parameter, Parameter, entries);
+
+  mutt_body_free(&eb->parts);
+  eb->parts = b->parts;
+  b->parts = NULL;
+
+  if (lines > 0)
+    e->lines = lines;
+
+  mutt_body_free(&b);
+  return 0;
+}
@@ -73,6 +73,9 @@
 #include "muttlib.h"
 #include "mx.h"
 #include "sort.h"
+#ifdef USE_HCACHE
+#include "hcache/lib.h"
+#endif
 #ifdef ENABLE_NLS
 #include <libintl.h>
 #endif
@@ -193,6 +196,72 @@ static void set_flag(struct Mailbox *m, AclFlags aclflag, bool flag,
       mutt_str_cat(flags, flsize, str);
 }
 
+/**
+ * compile_flags - Create the STORE data item for all of an Email's flags
+ * @param m       Selected Imap Mailbox
+ * @param e       Email
+ * @param deleted Set the deleted flag
+ * @param buf     Buffer for the data item, e.g. " FLAGS.SILENT (\\Seen)"
+ * @retval true  The data item has some flags
+ * @retval false No flags could be set, e.g. no ACL rights
+ */
+static bool compile_flags(struct Mailbox *m, struct Email *e, bool deleted,
+                          struct Buffer *buf)
+{
+  char flags[1024] = { 0 };
+
+  set_flag(m, MUTT_ACL_SEEN, e->read, "\\Seen ", flags, sizeof(flags));
+  set_flag(m, MUTT_ACL_WRITE, e->old, "Old ", flags, sizeof(flags));
+  set_flag(m, MUTT_ACL_WRITE, e->flagged, "\\Flagged ", flags, sizeof(flags));
+  set_flag(m, MUTT_ACL_WRITE, e->replied, "\\Answered ", flags, sizeof(flags));
+  set_flag(m, MUTT_ACL_DELETE, deleted, "\\Deleted ", flags, sizeof(flags));
+
+  if (m->rights & MUTT_ACL_WRITE)
+  {
+    /* restore system flags */
+    if (imap_edata_get(e)->flags_system)
+      mutt_str_cat(flags, sizeof(flags), imap_edata_get(e)->flags_system);
+    /* set custom flags */
+    struct Buffer *tags = buf_pool_get();
+    driver_tags_get_with_hidden(&e->tags, tags);
+    if (!buf_is_empty(tags))
+    {
+      mutt_str_cat(flags, sizeof(flags), buf_string(tags));
+    }
+    buf_pool_release(&tags);
+  }
+
+  mutt_str_remove_trailing_ws(flags);
+
+  /* UW-IMAP is OK with null flags, Cyrus isn't. The only solution is to
+   * explicitly revoke all system flags (if we have permission) */
+  if (*flags == '\0')
+  {
+    set_flag(m, MUTT_ACL_SEEN, true, "\\Seen ", flags, sizeof(flags));
+    set_flag(m, MUTT_ACL_WRITE, true, "Old ", flags, sizeof(flags));
+    set_flag(m, MUTT_ACL_WRITE, true, "\\Flagged ", flags, sizeof(flags));
+    set_flag(m, MUTT_ACL_WRITE, true, "\\Answered ", flags, sizeof(flags));
+    set_flag(m, MUTT_ACL_DELETE, !deleted, "\\Deleted ", flags, sizeof(flags));
+
+    /* erase custom flags */
+    if ((m->rights & MUTT_ACL_WRITE) && imap_edata_get(e)->flags_remote)
+      mutt_str_cat(flags, sizeof(flags), imap_edata_get(e)->flags_remote);
+
+    mutt_str_remove_trailing_ws(flags);
+
+    buf_addstr(buf, " -FLAGS.SILENT (");
+  }
+  else
+  {
+    buf_addstr(buf, " FLAGS.SILENT (");
+  }
+
+  buf_addstr(buf, flags);
+  buf_addstr(buf, ")");
+
+  return (*flags != '\0');
+}
+
 /**
  * compare_flags_for_copy - Compare local flags against the server
  * @param e Email
@@ -337,6 +406,105 @@ static int sync_helper(struct Mailbox *m, struct Email **emails, int num_emails,
   return count;
 }
 
+/**
+ * struct CondStore - A conditional STORE for one Email
+ */
+struct CondStore
+{
+  char *item;       ///< STORE data item, e.g. "(UNCHANGEDSINCE 42) FLAGS.SILENT (\\Seen)"
+  unsigned int uid; ///< UID of the Email
+};
+ARRAY_HEAD(CondStoreArray, struct CondStore);
+
+/**
+ * cond_store_sort - Compare two conditional STOREs - Implements ::sort_t - @ingroup sort_api
+ *
+ * Group the STOREs by data item, then by UID.
+ */
+static int cond_store_sort(const void *a, const void *b, void *sdata)
+{
+  const struct CondStore *csa = a;
+  const struct CondStore *csb = b;
+
+  int rc = mutt_str_cmp(csa->item, csb->item);
+  if (rc == 0)
+    rc = mutt_numeric_cmp(csa->uid, csb->uid);
+  return rc;
+}
+
+/**
+ * sync_conditional - Sync flag changes to the server with CONDSTORE
+ * @param m          Selected Imap Mailbox
+ * @param emails     Array of Emails
+ * @param num_emails Number of Emails in the array
+ * @param modseq     Mod-sequence of the Mailbox
+ * @retval >=0 Success, number of messages
+ * @retval  -1 Failure
+ *
+ * Each Email's flag changes are combined into a single conditional STORE,
+ * `(UNCHANGEDSINCE modseq) FLAGS.SILENT (...)`, so that the server refuses
+ * all of them if another client has changed the message.  The newest
+ * mod-sequence that we've seen for the Email is used.
+ *
+ * Emails with identical STOREs share a command, using a UID set.
+ */
+static int sync_conditional(struct Mailbox *m, struct Email **emails,
+                            int num_emails, unsigned long long modseq)
+{
+  struct ImapAccountData *adata = imap_adata_get(m);
+  if (!adata)
+    return -1;
+
+  struct CondStoreArray csa = ARRAY_HEAD_INITIALIZER;
+  struct Buffer *item = buf_pool_get();
+
+  for (int i = 0; i < num_emails; i++)
+  {
+    struct Email *e = emails[i];
+    /* don't include pending expunged messages */
+    if (!e || !e->changed || !e->active || (e->index == INT_MAX))
+      continue;
+
+    struct ImapEmailData *edata = imap_edata_get(e);
+    if (!compare_flags_for_copy(e) && (e->deleted == edata->deleted))
+      continue;
+
+    buf_printf(item, "(UNCHANGEDSINCE %llu)", MAX(edata->modseq, modseq));
+    if (!compile_flags(m, e, e->deleted, item))
+      continue;
+
+    struct CondStore cs = { buf_strdup(item), edata->uid };
+    ARRAY_ADD(&csa, cs);
+  }
+  buf_pool_release(&item);
+
+  ARRAY_SORT(&csa, cond_store_sort, NULL);
+
+  int count = 0;
+  struct UidArray uida = ARRAY_HEAD_INITIALIZER;
+  size_t num = ARRAY_SIZE(&csa);
+  for (size_t i = 0; (i < num) && (count >= 0);)
+  {
+    const char *group = ARRAY_GET(&csa, i)->item;
+    for (; (i < num) && mutt_str_equal(ARRAY_GET(&csa, i)->item, group); i++)
+      ARRAY_ADD(&uida, ARRAY_GET(&csa, i)->uid);
+
+    int rc = imap_exec_msg_set(adata, "UID STORE", group, &uida);
+    count = (rc < 0) ? rc : count + rc;
+    ARRAY_SHRINK(&uida, ARRAY_SIZE(&uida));
+  }
+  ARRAY_FREE(&uida);
+
+  struct CondStore *cs = NULL;
+  ARRAY_FOREACH(cs, &csa)
+  {
+    FREE(&cs->item);
+  }
+  ARRAY_FREE(&csa);
+
+  return count;
+}
+
 /**
  * longest_common_prefix - Find longest prefix common to two strings
  * @param buf   Destination buffer
@@ -574,6 +742,101 @@ void imap_logout_all(void)
   }
 }
 
+/**
+ * imap_pool_keepalive - Keep a spare connection alive - Implements PoolConnection::keepalive() - @ingroup conn_pool_keepalive
+ */
+static int imap_pool_keepalive(void *data)
+{
+  struct ImapAccountData *adata = data;
+  if (imap_exec(adata, "NOOP", IMAP_CMD_POLL) != IMAP_EXEC_SUCCESS)
+    return -1;
+  return 0;
+}
+
+/**
+ * imap_pool_close - Log out of a spare connection - Implements PoolConnection::close() - @ingroup conn_pool_close
+ */
+static void imap_pool_close(void **ptr)
+{
+  if (!ptr || !*ptr)
+    return;
+
+  imap_logout(*ptr);
+  imap_adata_free(ptr);
+}
+
+/**
+ * imap_secondary_get - Get a secondary connection to the server
+ * @param adata Imap Account data of the main connection
+ * @retval ptr  Authenticated secondary connection
+ * @retval NULL Use the main connection
+ *
+ * While a Mailbox is selected, commands that don't concern it can use a
+ * second connection, rather than queueing up behind it.  The connection is
+ * taken from the pool, or opened, if `$imap_pool_timeout` allows.
+ *
+ * Give the connection back with imap_secondary_put().
+ */
+struct ImapAccountData *imap_secondary_get(struct ImapAccountData *adata)
+{
+  const short c_imap_pool_timeout = cs_subset_number(NeoMutt->sub, "imap_pool_timeout");
+  if ((c_imap_pool_timeout == 0) || !adata || !adata->conn ||
+      (adata->state < IMAP_SELECTED))
+  {
+    return NULL;
+  }
+
+  struct ImapAccountData *sec = mutt_conn_pool_get(&adata->conn->account);
+  if (!sec)
+  {
+    sec = imap_adata_new(NULL);
+    sec->conn = mutt_conn_new(&adata->conn->account);
+    if (!sec->conn || (imap_login(sec) < 0))
+    {
+      imap_pool_close((void **) &sec);
+      return NULL;
+    }
+    mutt_debug(LL_DEBUG2, "Opened secondary connection to %s\n",
+               adata->conn->account.host);
+  }
+
+  sec->account = adata->account;
+  return sec;
+}
+
+/**
+ * imap_secondary_put - Give back a secondary connection
+ * @param ptr Secondary connection, from imap_secondary_get()
+ *
+ * A healthy connection is kept in the pool, for next time.  One that still
+ * has commands queued is logged out instead.
+ */
+void imap_secondary_put(struct ImapAccountData **ptr)
+{
+  if (!ptr || !*ptr)
+    return;
+
+  struct ImapAccountData *sec = *ptr;
+
+  /* The Account may be gone by the time the connection is reused */
+  sec->account = NULL;
+
+  if ((sec->status == IMAP_FATAL) || (sec->state < IMAP_AUTHENTICATED) ||
+      !buf_is_empty(&sec->cmdbuf))
+  {
+    imap_pool_close((void **) ptr);
+    return;
+  }
+
+  struct PoolConnection pc = { 0 };
+  pc.conn = sec->conn;
+  pc.data = sec;
+  pc.keepalive = imap_pool_keepalive;
+  pc.close = imap_pool_close;
+  mutt_conn_pool_put(&pc);
+  *ptr = NULL;
+}
+
 /**
  * imap_read_literal - Read bytes bytes from server into file
  * @param fp       File handle for email file
@@ -641,6 +904,59 @@ int imap_read_literal(FILE *fp, struct ImapAccountData *adata,
   return 0;
 }
 
+/**
+ * imap_read_literal_buf - Read bytes bytes from server into a Buffer
+ * @param buf   Buffer for the literal, will be overwritten
+ * @param adata Imap Account data
+ * @param bytes Number of bytes to read
+ * @retval  0 Success
+ * @retval -1 Failure
+ *
+ * Like imap_read_literal(), but keeps the data in memory.
+ * The Buffer may be reused between calls to avoid reallocations.
+ *
+ * @note Strips `\r` from `\r\n`.
+ */
+int imap_read_literal_buf(struct Buffer *buf, struct ImapAccountData *adata,
+                          unsigned long bytes)
+{
+  char c;
+  bool r = false;
+
+  buf_reset(buf);
+  buf_alloc(buf, bytes + 1);
+
+  mutt_debug(LL_DEBUG2, "reading %lu bytes\n", bytes);
+
+  for (unsigned long pos = 0; pos < bytes; pos++)
+  {
+    if (mutt_socket_readchar(adata->conn, &c) != 1)
+    {
+      mutt_debug(LL_DEBUG1, "error during read, %lu bytes read\n", pos);
+      adata->status = IMAP_FATAL;
+      return -1;
+    }
+
+    if (r && (c != '\n'))
+      buf_addch(buf, '\r');
+
+    if (c == '\r')
+    {
+      r = true;
+      continue;
+    }
+    else
+    {
+      r = false;
+    }
+
+    buf_addch(buf, c);
+  }
+
+  mutt_debug(IMAP_LOG_LTRL, "\n%s", buf_string(buf));
+  return 0;
+}
+
 /**
  * imap_notify_delete_email - Inform IMAP that an Email has been deleted
  * @param m Mailbox
@@ -745,6 +1061,7 @@ int imap_open_connection(struct ImapAccountData *adata)
     return -1;
 
   adata->state = IMAP_CONNECTED;
+  adata->notify = false;
 
   if (imap_cmd_step(adata) != IMAP_RES_OK)
   {
@@ -931,7 +1248,6 @@ int imap_sync_message_for_copy(struct Mailbox *m, struct Email *e,
   if (!adata || (adata->mailbox != m))
     return -1;
 
-  char flags[1024] = { 0 };
   char uid[11] = { 0 };
 
   if (!compare_flags_for_copy(e))
@@ -946,62 +1262,11 @@ int imap_sync_message_for_copy(struct Mailbox *m, struct Email *e,
   buf_addstr(cmd, "UID STORE ");
   buf_addstr(cmd, uid);
 
-  flags[0] = '\0';
-
-  set_flag(m, MUTT_ACL_SEEN, e->read, "\\Seen ", flags, sizeof(flags));
-  set_flag(m, MUTT_ACL_WRITE, e->old, "Old ", flags, sizeof(flags));
-  set_flag(m, MUTT_ACL_WRITE, e->flagged, "\\Flagged ", flags, sizeof(flags));
-  set_flag(m, MUTT_ACL_WRITE, e->replied, "\\Answered ", flags, sizeof(flags));
-  set_flag(m, MUTT_ACL_DELETE, imap_edata_get(e)->deleted, "\\Deleted ", flags,
-           sizeof(flags));
-
-  if (m->rights & MUTT_ACL_WRITE)
-  {
-    /* restore system flags */
-    if (imap_edata_get(e)->flags_system)
-      mutt_str_cat(flags, sizeof(flags), imap_edata_get(e)->flags_system);
-    /* set custom flags */
-    struct Buffer *tags = buf_pool_get();
-    driver_tags_get_with_hidden(&e->tags, tags);
-    if (!buf_is_empty(tags))
-    {
-      mutt_str_cat(flags, sizeof(flags), buf_string(tags));
-    }
-    buf_pool_release(&tags);
-  }
-
-  mutt_str_remove_trailing_ws(flags);
-
-  /* UW-IMAP is OK with null flags, Cyrus isn't. The only solution is to
-   * explicitly revoke all system flags (if we have permission) */
-  if (*flags == '\0')
-  {
-    set_flag(m, MUTT_ACL_SEEN, true, "\\Seen ", flags, sizeof(flags));
-    set_flag(m, MUTT_ACL_WRITE, true, "Old ", flags, sizeof(flags));
-    set_flag(m, MUTT_ACL_WRITE, true, "\\Flagged ", flags, sizeof(flags));
-    set_flag(m, MUTT_ACL_WRITE, true, "\\Answered ", flags, sizeof(flags));
-    set_flag(m, MUTT_ACL_DELETE, !imap_edata_get(e)->deleted, "\\Deleted ",
-             flags, sizeof(flags));
-
-    /* erase custom flags */
-    if ((m->rights & MUTT_ACL_WRITE) && imap_edata_get(e)->flags_remote)
-      mutt_str_cat(flags, sizeof(flags), imap_edata_get(e)->flags_remote);
-
-    mutt_str_remove_trailing_ws(flags);
-
-    buf_addstr(cmd, " -FLAGS.SILENT (");
-  }
-  else
-  {
-    buf_addstr(cmd, " FLAGS.SILENT (");
-  }
-
-  buf_addstr(cmd, flags);
-  buf_addstr(cmd, ")");
+  bool has_flags = compile_flags(m, e, imap_edata_get(e)->deleted, cmd);
 
   /* after all this it's still possible to have no flags, if you
    * have no ACL rights */
-  if (*flags && (imap_exec(adata, cmd->data, IMAP_CMD_NO_FLAGS) != IMAP_EXEC_SUCCESS) &&
+  if (has_flags && (imap_exec(adata, cmd->data, IMAP_CMD_NO_FLAGS) != IMAP_EXEC_SUCCESS) &&
       err_continue && (*err_continue != MUTT_YES))
   {
     *err_continue = imap_continue("imap_sync_message: STORE failed", adata->buf);
@@ -1036,6 +1301,9 @@ enum MxStatus imap_check_mailbox(struct Mailbox *m, bool force)
   struct ImapAccountData *adata = imap_adata_get(m);
   struct ImapMboxData *mdata = imap_mdata_get(m);
 
+  /* Pick up the STATUS of the other Mailboxes, while we're here */
+  imap_status_flush(adata);
+
   /* overload keyboard timeout to avoid many mailbox checks in a row.
    * Most users don't like having to wait exactly when they press a key. */
   int rc = 0;
@@ -1077,13 +1345,23 @@ enum MxStatus imap_check_mailbox(struct Mailbox *m, bool force)
    * changes to process, since we can reopen here. */
   imap_cmd_finish(adata);
 
+  /* Carry on downloading headers that were deferred when opening */
+  int deferred = 0;
+  if (mdata->deferred_msn && (mdata->reopen & IMAP_REOPEN_ALLOW))
+  {
+    deferred = imap_read_headers_deferred(m);
+    if (deferred < 0)
+      return MX_STATUS_ERROR;
+  }
+
   enum MxStatus check = MX_STATUS_OK;
   if (mdata->check_status & IMAP_EXPUNGE_PENDING)
     check = MX_STATUS_REOPENED;
   else if (mdata->check_status & IMAP_NEWMAIL_PENDING)
     check = MX_STATUS_NEW_MAIL;
-  else if (mdata->check_status & IMAP_FLAGS_PENDING)
-    check = MX_STATUS_FLAGS;
+  else if ((mdata->check_status & IMAP_FLAGS_PENDING) || (deferred > 0))
+    check = MX_STATUS_FLAGS; // backfilled headers aren't new mail, just refresh
+
   else if (rc < 0)
     check = MX_STATUS_ERROR;
 
@@ -1094,6 +1372,101 @@ enum MxStatus imap_check_mailbox(struct Mailbox *m, bool force)
   return check;
 }
 
+/**
+ * imap_notify - Ask the server to report changes to the Account's Mailboxes
+ * @param adata IMAP Account data
+ * @retval true  NOTIFY is active, the Mailboxes don't need polling
+ * @retval false The Mailboxes need polling with STATUS
+ *
+ * With NOTIFY (RFC5465), the server sends a STATUS response whenever one of
+ * the watched Mailboxes changes.  Any notifications that have arrived since
+ * the last check are handled here.
+ */
+static bool imap_notify(struct ImapAccountData *adata)
+{
+  const bool c_imap_notify = cs_subset_bool(NeoMutt->sub, "imap_notify");
+  if (!c_imap_notify || !(adata->capabilities & IMAP_CAP_NOTIFY) ||
+      !adata->account || (adata->state < IMAP_AUTHENTICATED))
+  {
+    return false;
+  }
+
+  /* Don't read the responses to another command */
+  if (adata->nextcmd != adata->lastcmd)
+    return adata->notify;
+
+  if (!adata->notify)
+  {
+    struct Buffer *cmd = buf_pool_get();
+    buf_addstr(cmd, "NOTIFY SET STATUS (selected (MessageNew MessageExpunge FlagChange)) (mailboxes (");
+
+    int num = 0;
+    struct MailboxNode *np = NULL;
+    STAILQ_FOREACH(np, &adata->account->mailboxes, entries)
+    {
+      struct ImapMboxData *mdata = imap_mdata_get(np->mailbox);
+      if (!mdata)
+        continue;
+
+      mdata->notify = np->mailbox->poll_new_mail;
+      if (!mdata->notify)
+        continue;
+
+      if (num++ != 0)
+        buf_addch(cmd, ' ');
+      buf_addstr(cmd, mdata->munge_name);
+    }
+    buf_addstr(cmd, ") (MessageNew MessageExpunge FlagChange))");
+
+    int rc = IMAP_EXEC_ERROR;
+    if (num != 0)
+      rc = imap_exec(adata, buf_string(cmd), IMAP_CMD_NO_FLAGS);
+    buf_pool_release(&cmd);
+
+    if (rc != IMAP_EXEC_SUCCESS)
+    {
+      /* Don't try again, poll with STATUS instead */
+      if ((num != 0) && (rc == IMAP_EXEC_ERROR))
+        adata->capabilities &= ~IMAP_CAP_NOTIFY;
+      return false;
+    }
+
+    adata->notify = true;
+  }
+
+  int rc;
+  while ((rc = mutt_socket_poll(adata->conn, 0)) > 0)
+  {
+    if (imap_cmd_step(adata) < 0)
+    {
+      mutt_debug(LL_DEBUG1, "Error reading NOTIFY response\n");
+      return false;
+    }
+  }
+
+  return (rc == 0);
+}
+
+/**
+ * imap_status_flush - Read the replies to the queued STATUS commands
+ * @param adata Imap Account data of the main connection
+ *
+ * Send the STATUS commands that imap_status() queued on the secondary
+ * connection, in one batch, and give the connection back.
+ */
+void imap_status_flush(struct ImapAccountData *adata)
+{
+  if (!adata || !adata->status_sec)
+    return;
+
+  struct ImapAccountData *sec = adata->status_sec;
+  adata->status_sec = NULL;
+
+  if (!buf_is_empty(&sec->cmdbuf))
+    imap_exec(sec, NULL, IMAP_CMD_POLL);
+  imap_secondary_put(&sec);
+}
+
 /**
  * imap_status - Refresh the number of total and new messages
  * @param adata  IMAP Account data
@@ -1122,6 +1495,10 @@ static int imap_status(struct ImapAccountData *adata, struct ImapMboxData *mdata
   if (adata->mailbox && !adata->mailbox->poll_new_mail)
     return mdata->messages;
 
+  /* The server will tell us about any changes */
+  if (imap_notify(adata) && mdata->notify)
+    return mdata->messages;
+
   if (adata->capabilities & IMAP_CAP_IMAP4REV1)
   {
     uidvalidity_flag = "UIDVALIDITY";
@@ -1139,6 +1516,32 @@ static int imap_status(struct ImapAccountData *adata, struct ImapMboxData *mdata
   snprintf(cmd, sizeof(cmd), "STATUS %s (UIDNEXT %s UNSEEN RECENT MESSAGES)",
            mdata->munge_name, uidvalidity_flag);
 
+  /* Don't make the selected Mailbox wait for the STATUS.
+   * Queued ones are pipelined on a secondary connection, until imap_status_flush(). */
+  if (queue)
+  {
+    if (!adata->status_sec)
+      adata->status_sec = imap_secondary_get(adata);
+    if (adata->status_sec)
+    {
+      if (imap_exec(adata->status_sec, cmd, IMAP_CMD_QUEUE) == IMAP_EXEC_SUCCESS)
+        return mdata->messages;
+      imap_secondary_put(&adata->status_sec);
+    }
+  }
+  else
+  {
+    imap_status_flush(adata);
+    struct ImapAccountData *sec = imap_secondary_get(adata);
+    if (sec)
+    {
+      int rc = imap_exec(sec, cmd, IMAP_CMD_POLL);
+      imap_secondary_put(&sec);
+      if (rc == IMAP_EXEC_SUCCESS)
+        return mdata->messages;
+    }
+  }
+
   int rc = imap_exec(adata, cmd, queue ? IMAP_CMD_QUEUE : IMAP_CMD_POLL);
   if (rc != IMAP_EXEC_SUCCESS)
   {
@@ -1176,6 +1579,8 @@ int imap_path_status(const char *path, bool queue)
   if (is_temp)
   {
     m = mx_path_resolve(path);
+    /* it's only needed for a moment, so don't ask NOTIFY to watch it */
+    m->poll_new_mail = false;
     if (!mx_mbox_ac_link(m))
     {
       mailbox_free(&m);
@@ -1458,6 +1863,49 @@ out:
   return ((rc == IMAP_EXEC_SUCCESS) ? 0 : -1);
 }
 
+/**
+ * sync_modified - Fetch the flags of Emails that a conditional STORE skipped
+ * @param m Selected Imap Mailbox
+ * @retval  0 Success
+ * @retval -1 Failure
+ *
+ * Another client changed these messages while we had local changes to them.
+ * The server's flags win: the local changes are dropped and the current flags
+ * are fetched.
+ */
+static int sync_modified(struct Mailbox *m)
+{
+  struct ImapAccountData *adata = imap_adata_get(m);
+  struct ImapMboxData *mdata = imap_mdata_get(m);
+  if (ARRAY_EMPTY(&mdata->modified))
+    return 0;
+
+  const int count = ARRAY_SIZE(&mdata->modified);
+  unsigned int *uidp = NULL;
+  ARRAY_FOREACH(uidp, &mdata->modified)
+  {
+    struct Email *e = mutt_hash_int_find(mdata->uid_hash, *uidp);
+    if (e)
+      e->changed = false;
+  }
+
+  if (m->verbose)
+  {
+    mutt_message(ngettext("%d message was changed on the server, fetching its flags...",
+                          "%d messages were changed on the server, fetching their flags...", count),
+                 count);
+  }
+
+  ARRAY_SORT(&mdata->modified, imap_sort_uid, NULL);
+  int rc = imap_exec_msg_set(adata, "UID FETCH", "(UID FLAGS)", &mdata->modified);
+  ARRAY_FREE(&mdata->modified);
+
+  if ((rc > 0) && (imap_exec(adata, NULL, IMAP_CMD_NO_FLAGS) != IMAP_EXEC_SUCCESS))
+    rc = -1;
+
+  return (rc < 0) ? -1 : 0;
+}
+
 /**
  * imap_sync_mailbox - Sync all the changes to the server
  * @param m       Mailbox
@@ -1492,6 +1940,12 @@ enum MxStatus imap_sync_mailbox(struct Mailbox *m, bool expunge, bool close)
   if (check == MX_STATUS_ERROR)
     return check;
 
+  /* With CONDSTORE, don't overwrite flags that another client has changed */
+  unsigned long long modseq = 0;
+  const bool c_imap_condstore = cs_subset_bool(NeoMutt->sub, "imap_condstore");
+  if ((adata->capabilities & IMAP_CAP_CONDSTORE) && c_imap_condstore)
+    modseq = mdata->modseq;
+
   /* if we are expunging anyway, we can do deleted messages very quickly... */
   if (expunge && (m->rights & MUTT_ACL_DELETE))
   {
@@ -1581,15 +2035,22 @@ enum MxStatus imap_sync_mailbox(struct Mailbox *m, bool expunge, bool close)
   memcpy(emails, m->emails, m->msg_count * sizeof(struct Email *));
   mutt_qsort_r(emails, m->msg_count, sizeof(struct Email *), imap_sort_email_uid, NULL);
 
-  rc = sync_helper(m, emails, m->msg_count, MUTT_ACL_DELETE, MUTT_DELETED, "\\Deleted");
-  if (rc >= 0)
-    rc |= sync_helper(m, emails, m->msg_count, MUTT_ACL_WRITE, MUTT_FLAG, "\\Flagged");
-  if (rc >= 0)
-    rc |= sync_helper(m, emails, m->msg_count, MUTT_ACL_WRITE, MUTT_OLD, "Old");
-  if (rc >= 0)
-    rc |= sync_helper(m, emails, m->msg_count, MUTT_ACL_SEEN, MUTT_READ, "\\Seen");
-  if (rc >= 0)
-    rc |= sync_helper(m, emails, m->msg_count, MUTT_ACL_WRITE, MUTT_REPLIED, "\\Answered");
+  if (modseq)
+  {
+    rc = sync_conditional(m, emails, m->msg_count, modseq);
+  }
+  else
+  {
+    rc = sync_helper(m, emails, m->msg_count, MUTT_ACL_DELETE, MUTT_DELETED, "\\Deleted");
+    if (rc >= 0)
+      rc |= sync_helper(m, emails, m->msg_count, MUTT_ACL_WRITE, MUTT_FLAG, "\\Flagged");
+    if (rc >= 0)
+      rc |= sync_helper(m, emails, m->msg_count, MUTT_ACL_WRITE, MUTT_OLD, "Old");
+    if (rc >= 0)
+      rc |= sync_helper(m, emails, m->msg_count, MUTT_ACL_SEEN, MUTT_READ, "\\Seen");
+    if (rc >= 0)
+      rc |= sync_helper(m, emails, m->msg_count, MUTT_ACL_WRITE, MUTT_REPLIED, "\\Answered");
+  }
 
   FREE(&emails);
 
@@ -1598,6 +2059,9 @@ enum MxStatus imap_sync_mailbox(struct Mailbox *m, bool expunge, bool close)
     if (imap_exec(adata, NULL, IMAP_CMD_NO_FLAGS) != IMAP_EXEC_SUCCESS)
       rc = -1;
 
+  if ((rc >= 0) && (sync_modified(m) < 0))
+    rc = -1;
+
   if (rc < 0)
   {
     if (close)
@@ -1615,9 +2079,16 @@ enum MxStatus imap_sync_mailbox(struct Mailbox *m, bool expunge, bool close)
     return -1;
   }
 
+#ifdef USE_HCACHE
+  imap_hcache_open(adata, mdata);
+#endif
+
   /* Update local record of server state to reflect the synchronization just
-   * completed.  imap_read_headers always overwrites hcache-origin flags, so
-   * there is no need to mutate the hcache after flag-only changes. */
+   * completed.  Local flag changes were cached above.  With CONDSTORE, the
+   * flags that other clients changed are cached too.  The cached MODSEQ is
+   * the server's HIGHESTMODSEQ, so anything missed here is fetched again by
+   * the next CHANGEDSINCE resync.  Otherwise, imap_read_headers always
+   * overwrites hcache-origin flags. */
   for (int i = 0; i < m->msg_count; i++)
   {
     struct Email *e = m->emails[i];
@@ -1630,9 +2101,25 @@ enum MxStatus imap_sync_mailbox(struct Mailbox *m, bool expunge, bool close)
     edata->read = e->read;
     edata->replied = e->replied;
     e->changed = false;
+#ifdef USE_HCACHE
+    if (edata->hcache_stale && modseq && e->active)
+      imap_hcache_put(mdata, e);
+#endif
+    edata->hcache_stale = false;
   }
   m->changed = false;
 
+#ifdef USE_HCACHE
+  imap_hcache_store_uid_flags(mdata);
+  if (modseq)
+  {
+    hcache_store_raw(mdata->hcache, "MODSEQ", 6, &mdata->modseq, sizeof(mdata->modseq));
+    if (adata->qresync)
+      imap_hcache_store_uid_seqset(mdata);
+  }
+  imap_hcache_close(mdata);
+#endif
+
   /* We must send an EXPUNGE command if we're not closing. */
   if (expunge && !close && (m->rights & MUTT_ACL_DELETE))
   {
@@ -1732,6 +2219,10 @@ static bool imap_ac_add(struct Account *a, struct Mailbox *m)
     m->mdata = mdata;
     m->mdata_free = imap_mdata_free;
     url_free(&url);
+
+    /* Watch the new Mailbox too, unless it's only temporary */
+    if (m->poll_new_mail)
+      adata->notify = false;
   }
   return true;
 }
@@ -1884,6 +2375,7 @@ static enum MxOpenReturns imap_mbox_open(struct Mailbox *m)
   adata->status = 0;
   m->rights = 0;
   mdata->new_mail_count = 0;
+  mdata->deferred_msn = 0;
 
   if (m->verbose)
     mutt_message(_("Selecting %s..."), mdata->name);
@@ -112,5 +112,6 @@ void imap_clean_path(char *path, size_t plen);
 
 /* search.c */
 bool imap_search(struct Mailbox *m, const struct PatternList *pat);
+bool imap_sort(struct Mailbox *m, short sort, short sort_aux);
 
 #endif /* MUTT_IMAP_LIB_H */
@@ -45,6 +45,7 @@ void imap_mdata_free(void **ptr)
 
   imap_mdata_cache_reset(mdata);
   mutt_list_free(&mdata->flags);
+  ARRAY_FREE(&mdata->modified);
   FREE(&mdata->name);
   FREE(&mdata->real_name);
   FREE(&mdata->munge_name);
@@ -23,10 +23,12 @@
 #ifndef MUTT_IMAP_MDATA_H
 #define MUTT_IMAP_MDATA_H
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <time.h>
 #include "private.h"
 #include "mutt/lib.h"
+#include "msg_set.h"
 
 struct Mailbox;
 struct ImapAccountData;
@@ -45,6 +47,8 @@ struct ImapMboxData
   ImapOpenFlags reopen;        ///< Flags, e.g. #IMAP_REOPEN_ALLOW
   ImapOpenFlags check_status;  ///< Flags, e.g. #IMAP_NEWMAIL_PENDING
   unsigned int new_mail_count; ///< Set when EXISTS notifies of new mail
+  unsigned int deferred_msn;   ///< Headers up to this MSN haven't been downloaded yet
+  bool notify;                 ///< Mailbox is in the Account's NOTIFY set
 
   // IMAP STATUS information
   struct ListHead flags;
@@ -58,6 +62,8 @@ struct ImapMboxData
   // Cached data used only when the mailbox is opened
   struct HashTable *uid_hash;               ///< Hash Table: "uid" -> Email
   ARRAY_HEAD(MSNArray, struct Email *) msn; ///< look up headers by (MSN-1)
+  struct MsnExpunge *expunge;               ///< Expunges not yet applied to the msn index
+  struct UidArray modified;                 ///< UIDs a conditional STORE didn't change
   struct BodyCache *bcache;                 ///< Email body cache
 
   struct HeaderCache *hcache; ///< Email header cache
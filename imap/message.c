@@ -36,6 +36,7 @@
 #include "config.h"
 #include <assert.h>
 #include <ctype.h>
+#include <inttypes.h> // IWYU pragma: keep
 #include <limits.h>
 #include <stdbool.h>
 #include <stdint.h>
@@ -163,6 +164,34 @@ static int msg_cache_commit(struct Mailbox *m, struct Email *e)
   return mutt_bcache_commit(mdata->bcache, id);
 }
 
+/**
+ * msg_cache_exists - Is the email in the message cache?
+ * @param m Selected Imap Mailbox
+ * @param e Email
+ * @retval true The message has been cached
+ */
+static bool msg_cache_exists(struct Mailbox *m, struct Email *e)
+{
+  struct ImapMboxData *mdata = imap_mdata_get(m);
+
+  char id[64] = { 0 };
+  snprintf(id, sizeof(id), "%u-%u", mdata->uidvalidity, imap_edata_get(e)->uid);
+  return (mutt_bcache_exists(mdata->bcache, id) == 0);
+}
+
+/**
+ * partial_cache_id - Get the message cache id for a partially fetched email
+ * @param mdata  Imap Mailbox data
+ * @param e      Email
+ * @param id     Buffer for the id
+ * @param idlen  Length of the buffer
+ */
+static void partial_cache_id(struct ImapMboxData *mdata, struct Email *e,
+                             char *id, size_t idlen)
+{
+  snprintf(id, idlen, "%u-%u-partial", mdata->uidvalidity, imap_edata_get(e)->uid);
+}
+
 /**
  * imap_bcache_delete - Delete an entry from the message cache - Implements ::bcache_list_t - @ingroup bcache_list_api
  * @retval 0 Always
@@ -305,7 +334,10 @@ static char *msg_parse_flags(struct ImapHeader *h, char *s)
  * @param s Command string
  * @retval  0 Success
  * @retval -1 String is corrupted
- * @retval -2 Fetch contains a body or header lines that still need to be parsed
+ * @retval -2 Fetch contains a body or header literal that still needs to be read
+ *
+ * ENVELOPE, BODYSTRUCTURE and quoted header data are not parsed here.
+ * Pointers to them are stored in the ImapHeader.
  */
 static int msg_parse_fetch(struct ImapHeader *h, char *s)
 {
@@ -365,10 +397,45 @@ static int msg_parse_fetch(struct ImapHeader *h, char *s)
       if (!mutt_str_atol(tmp, &h->content_length))
         return -1;
     }
-    else if (mutt_istr_startswith(s, "BODY") || mutt_istr_startswith(s, "RFC822.HEADER"))
+    else if ((plen = mutt_istr_startswith(s, "ENVELOPE")))
     {
-      /* handle above, in msg_fetch_header */
-      return -2;
+      s += plen;
+      SKIPWS(s);
+      h->envelope = s;
+      s = imap_skip_item(s);
+      if (!s)
+        return -1;
+    }
+    else if ((plen = mutt_istr_startswith(s, "BODYSTRUCTURE")))
+    {
+      s += plen;
+      SKIPWS(s);
+      h->bodystructure = s;
+      s = imap_skip_item(s);
+      if (!s)
+        return -1;
+    }
+    else if ((plen = mutt_istr_startswith(s, "BODY")) ||
+             (plen = mutt_istr_startswith(s, "RFC822.HEADER")))
+    {
+      char *value = s + plen;
+      if (*value == '[')
+      {
+        value = strchr(value, ']');
+        if (!value)
+          return -1;
+        value++;
+      }
+      SKIPWS(value);
+
+      /* a literal is handled above, in msg_fetch_header */
+      if (*value != '"')
+        return -2;
+
+      h->header = value;
+      s = imap_skip_item(value);
+      if (!s)
+        return -1;
     }
     else if ((plen = mutt_istr_startswith(s, "MODSEQ")))
     {
@@ -380,6 +447,7 @@ static int msg_parse_fetch(struct ImapHeader *h, char *s)
         return -1;
       }
       s++;
+      mutt_str_atoull(s, &h->edata->modseq);
       while (*s && (*s != ')'))
         s++;
       if (*s == ')')
@@ -407,19 +475,80 @@ static int msg_parse_fetch(struct ImapHeader *h, char *s)
   return 0;
 }
 
+/**
+ * read_fetch_response - Read a complete FETCH response into memory
+ * @param[in]  adata Imap Account data, holding the first line of the response
+ * @param[out] resp  Buffer for the response
+ * @retval  0 Success
+ * @retval -1 Failure
+ *
+ * A response line ending with `{n}` is followed by a literal of n bytes and
+ * then the rest of the response.  Each literal is read and inlined as a
+ * quoted string, so the whole response can be parsed in one go.
+ */
+static int read_fetch_response(struct ImapAccountData *adata, struct Buffer *resp)
+{
+  int rc = -1;
+  struct Buffer *lit = buf_pool_get();
+
+  buf_strcpy(resp, adata->buf);
+  while (true)
+  {
+    const size_t len = buf_len(resp);
+    if ((len == 0) || (buf_at(resp, len - 1) != '}'))
+      break;
+
+    char *open = strrchr(resp->data, '{');
+    unsigned int bytes = 0;
+    if (!open || (imap_get_literal_count(open, &bytes) < 0))
+      goto done;
+
+    *open = '\0';
+    buf_fix_dptr(resp);
+
+    if (imap_read_literal_buf(lit, adata, bytes) < 0)
+      goto done;
+
+    buf_addch(resp, '"');
+    for (const char *p = buf_string(lit); p < lit->dptr; p++)
+    {
+      if (*p == '\0')
+        continue;
+      if ((*p == '"') || (*p == '\\'))
+        buf_addch(resp, '\\');
+      buf_addch(resp, *p);
+    }
+    buf_addch(resp, '"');
+
+    /* pick up the rest of the response */
+    if (imap_cmd_step(adata) != IMAP_RES_CONTINUE)
+      goto done;
+    buf_addstr(resp, adata->buf);
+  }
+
+  rc = 0;
+
+done:
+  buf_pool_release(&lit);
+  return rc;
+}
+
 /**
  * msg_fetch_header - Import IMAP FETCH response into an ImapHeader
  * @param m   Mailbox
  * @param ih  ImapHeader
  * @param buf Server string containing FETCH response
- * @param fp  Connection to server
+ * @param hdr Buffer for the header literal (optional)
  * @retval  0 Success
  * @retval -1 String is not a fetch response
  * @retval -2 String is a corrupt fetch response
  *
  * Expects string beginning with * n FETCH.
+ *
+ * If hdr is supplied, any header literal is read into it, ready for parsing.
  */
-static int msg_fetch_header(struct Mailbox *m, struct ImapHeader *ih, char *buf, FILE *fp)
+static int msg_fetch_header(struct Mailbox *m, struct ImapHeader *ih, char *buf,
+                            struct Buffer *hdr)
 {
   int rc = -1; /* default now is that string isn't FETCH response */
 
@@ -448,14 +577,25 @@ static int msg_fetch_header(struct Mailbox *m, struct ImapHeader *ih, char *buf,
    *   read header lines and call it again. Silly. */
   int parse_rc = msg_parse_fetch(ih, buf);
   if (parse_rc == 0)
+  {
+    /* the header was inlined as a quoted string */
+    if (hdr && ih->header)
+    {
+      char *value = ih->header;
+      if (!imap_parse_nstring(&value, hdr, NULL))
+        return rc;
+      ih->content_length -= buf_len(hdr);
+    }
     return 0;
-  if ((parse_rc != -2) || !fp)
+  }
+  if ((parse_rc != -2) || !hdr)
     return rc;
 
   unsigned int bytes = 0;
   if (imap_get_literal_count(buf, &bytes) == 0)
   {
-    imap_read_literal(fp, adata, bytes, NULL);
+    if (imap_read_literal_buf(hdr, adata, bytes) < 0)
+      return rc;
 
     /* we may have other fields of the FETCH _after_ the literal
      * (eg Domino puts FLAGS here). Nothing wrong with that, either.
@@ -814,6 +954,205 @@ fail:
   return rc;
 }
 
+/**
+ * read_uid_search_all - Get all the UIDs in the Mailbox
+ * @param[in]  adata Imap Account data
+ * @param[out] uida  Array for the UIDs, sorted into MSN order
+ * @retval  0 Success
+ * @retval -1 Error
+ *
+ * A `UID SEARCH ALL` response is far smaller than a `FETCH 1:* (UID)`.
+ */
+static int read_uid_search_all(struct ImapAccountData *adata, struct UidArray *uida)
+{
+  int rc;
+
+  imap_cmd_start(adata, "UID SEARCH ALL");
+  while ((rc = imap_cmd_step(adata)) == IMAP_RES_CONTINUE)
+  {
+    const char *s = adata->buf;
+    if (!mutt_istr_startswith(s, "* SEARCH"))
+      continue;
+
+    s += 8;
+    while (*s)
+    {
+      SKIPWS(s);
+      unsigned int uid = 0;
+      const char *end = mutt_str_atoui(s, &uid);
+      if (!end || (end == s))
+        break;
+      ARRAY_ADD(uida, uid);
+      s = end;
+    }
+  }
+
+  if (rc != IMAP_RES_OK)
+    return -1;
+
+  /* UIDs are ascending in MSN order */
+  ARRAY_SORT(uida, imap_sort_uid, NULL);
+  return 0;
+}
+
+/**
+ * read_headers_uid_flags_eval_cache - Retrieve data from the header cache
+ * @param adata          Imap Account data
+ * @param msn_end        Last Message Sequence number
+ * @param ufa            UIDs and flags from the header cache
+ * @param cached_uid_next UIDNEXT when the UIDs were cached
+ * @param eval_condstore If true, use CONDSTORE to fetch flags
+ * @retval  0 Success
+ * @retval  1 Cache can't be used
+ * @retval -1 Error
+ *
+ * Without QRESYNC, rebuild the MSN index from the cached UIDs.
+ *
+ * If UIDNEXT and the number of messages are unchanged, nothing has arrived,
+ * so nothing can have been expunged, and the cached UIDs are still correct.
+ * Otherwise a `UID SEARCH` finds the current UIDs.  Any new messages are
+ * left for read_headers_fetch_new().
+ *
+ * For CONDSTORE, the flags of the cached Emails are brought up to date in
+ * read_headers_condstore_qresync_updates().  Otherwise, the system flags
+ * are refreshed by searching for them.
+ */
+static int read_headers_uid_flags_eval_cache(struct ImapAccountData *adata,
+                                             unsigned int msn_end, struct UidFlagsArray *ufa,
+                                             unsigned int cached_uid_next, bool eval_condstore)
+{
+  static const char *const flag_searches[] = { "UNSEEN", "FLAGGED", "ANSWERED", "DELETED" };
+
+  struct Mailbox *m = adata->mailbox;
+  struct ImapMboxData *mdata = imap_mdata_get(m);
+  struct UidArray uida = ARRAY_HEAD_INITIALIZER;
+  char buf[64] = { 0 };
+  int rc = -1;
+
+  mutt_debug(LL_DEBUG2, "Reading uid flags from header cache\n");
+  if (m->verbose)
+    mutt_message(_("Evaluating cache..."));
+
+  if ((cached_uid_next == mdata->uid_next) && (ARRAY_SIZE(ufa) == msn_end))
+  {
+    struct ImapUidFlags *uf = NULL;
+    ARRAY_FOREACH(uf, ufa)
+    {
+      ARRAY_ADD(&uida, uf->uid);
+    }
+  }
+  else
+  {
+    if (read_uid_search_all(adata, &uida) < 0)
+      goto done;
+
+    if (ARRAY_SIZE(&uida) != msn_end)
+    {
+      mutt_debug(LL_DEBUG1, "UID SEARCH found %zu messages, expected %u\n",
+                 ARRAY_SIZE(&uida), msn_end);
+      rc = 1;
+      goto done;
+    }
+  }
+
+  size_t idx = 0;
+  unsigned int *uidp = NULL;
+  ARRAY_FOREACH(uidp, &uida)
+  {
+    const unsigned int uid = *uidp;
+    const unsigned int msn = ARRAY_FOREACH_IDX + 1;
+
+    /* Both lists are in UID order */
+    while ((idx < ARRAY_SIZE(ufa)) && (ARRAY_GET(ufa, idx)->uid < uid))
+      idx++;
+    struct ImapUidFlags *uf = ARRAY_GET(ufa, idx);
+    if (uf && (uf->uid != uid))
+      uf = NULL;
+
+    /* Without the flags, treat the message as new */
+    if (!uf && !eval_condstore)
+      continue;
+
+    struct Email *e = imap_hcache_get(mdata, uid);
+    if (!e)
+      continue;
+
+    struct ImapEmailData *edata = imap_edata_new();
+    e->edata = edata;
+    e->edata_free = imap_edata_free;
+
+    e->index = uid;
+    e->active = true;
+    e->changed = false;
+    if (eval_condstore)
+    {
+      edata->read = e->read;
+      edata->old = e->old;
+      edata->deleted = e->deleted;
+      edata->flagged = e->flagged;
+      edata->replied = e->replied;
+    }
+    else
+    {
+      e->read = edata->read = uf->read;
+      e->old = edata->old = uf->old;
+      e->deleted = edata->deleted = uf->deleted;
+      e->flagged = edata->flagged = uf->flagged;
+      e->replied = edata->replied = uf->replied;
+    }
+
+    edata->msn = msn;
+    edata->uid = uid;
+    imap_msn_set(&mdata->msn, msn - 1, e);
+    mutt_hash_int_insert(mdata->uid_hash, uid, e);
+
+    mailbox_size_add(m, e);
+    m->emails[m->msg_count++] = e;
+  }
+
+  if (!eval_condstore)
+  {
+    /* The SEARCH results are marked in e->matched by cmd_parse_search() */
+    for (size_t i = 0; i < mutt_array_size(flag_searches); i++)
+    {
+      for (int j = 0; j < m->msg_count; j++)
+        m->emails[j]->matched = false;
+
+      snprintf(buf, sizeof(buf), "UID SEARCH %s", flag_searches[i]);
+      if (imap_exec(adata, buf, IMAP_CMD_NO_FLAGS) != IMAP_EXEC_SUCCESS)
+        goto done;
+
+      for (int j = 0; j < m->msg_count; j++)
+      {
+        struct Email *e = m->emails[j];
+        struct ImapEmailData *edata = imap_edata_get(e);
+        switch (i)
+        {
+          case 0:
+            e->read = edata->read = !e->matched;
+            break;
+          case 1:
+            e->flagged = edata->flagged = e->matched;
+            break;
+          case 2:
+            e->replied = edata->replied = e->matched;
+            break;
+          case 3:
+            e->deleted = edata->deleted = e->matched;
+            break;
+        }
+        e->matched = false;
+      }
+    }
+  }
+
+  rc = 0;
+
+done:
+  ARRAY_FREE(&uida);
+  return rc;
+}
+
 /**
  * read_headers_qresync_eval_cache - Retrieve data from the header cache
  * @param adata Imap Account data
@@ -1096,14 +1435,17 @@ static int read_headers_fetch_new(struct Mailbox *m, unsigned int msn_begin,
   unsigned int fetch_msn_end = 0;
   struct Progress *progress = NULL;
   char *hdrreq = NULL;
-  struct Buffer *tempfile = NULL;
-  FILE *fp = NULL;
+  struct Buffer *hdr = NULL;
   struct ImapHeader h = { 0 };
   struct Buffer *buf = NULL;
+  struct Buffer *resp = NULL;
   static const char *const want_headers = "DATE FROM SENDER SUBJECT TO CC MESSAGE-ID REFERENCES "
                                           "CONTENT-TYPE CONTENT-DESCRIPTION IN-REPLY-TO REPLY-TO "
                                           "LINES LIST-POST LIST-SUBSCRIBE LIST-UNSUBSCRIBE X-LABEL "
                                           "X-ORIGINAL-TO";
+  /* headers that the ENVELOPE and BODYSTRUCTURE don't cover */
+  static const char *const extra_headers = "REFERENCES LIST-POST LIST-SUBSCRIBE "
+                                           "LIST-UNSUBSCRIBE X-LABEL X-ORIGINAL-TO";
 
   struct ImapAccountData *adata = imap_adata_get(m);
   struct ImapMboxData *mdata = imap_mdata_get(m);
@@ -1112,8 +1454,13 @@ static int read_headers_fetch_new(struct Mailbox *m, unsigned int msn_begin,
   if (!adata || (adata->mailbox != m))
     return -1;
 
+  /* Let the server parse the envelope and MIME structure for us */
+  const bool c_imap_fetch_envelope = cs_subset_bool(NeoMutt->sub, "imap_fetch_envelope");
+  const bool use_envelope = c_imap_fetch_envelope &&
+                            (adata->capabilities & IMAP_CAP_IMAP4REV1);
+
   struct Buffer *hdr_list = buf_pool_get();
-  buf_strcpy(hdr_list, want_headers);
+  buf_strcpy(hdr_list, use_envelope ? extra_headers : want_headers);
   const char *const c_imap_headers = cs_subset_string(NeoMutt->sub, "imap_headers");
   if (c_imap_headers)
   {
@@ -1146,17 +1493,9 @@ static int read_headers_fetch_new(struct Mailbox *m, unsigned int msn_begin,
   buf_pool_release(&hdr_list);
 
   /* instead of downloading all headers and then parsing them, we parse them
-   * as they come in. */
-  tempfile = buf_pool_get();
-  buf_mktemp(tempfile);
-  fp = mutt_file_fopen(buf_string(tempfile), "w+");
-  if (!fp)
-  {
-    mutt_error(_("Could not create temporary file %s"), buf_string(tempfile));
-    goto bail;
-  }
-  unlink(buf_string(tempfile));
-  buf_pool_release(&tempfile);
+   * as they come in.  The literal is kept in memory and the Buffer is reused
+   * for each message. */
+  hdr = buf_pool_get();
 
   if (m->verbose)
   {
@@ -1165,6 +1504,8 @@ static int read_headers_fetch_new(struct Mailbox *m, unsigned int msn_begin,
   }
 
   buf = buf_pool_get();
+  if (use_envelope)
+    resp = buf_pool_get();
 
   /* NOTE:
    *   The (fetch_msn_end < msn_end) used to be important to prevent
@@ -1181,8 +1522,9 @@ static int read_headers_fetch_new(struct Mailbox *m, unsigned int msn_begin,
          imap_fetch_msn_seqset(buf, adata, evalhc, msn_begin, msn_end, &fetch_msn_end))
   {
     char *cmd = NULL;
-    mutt_str_asprintf(&cmd, "FETCH %s (UID FLAGS INTERNALDATE RFC822.SIZE %s)",
-                      buf_string(buf), hdrreq);
+    mutt_str_asprintf(&cmd, "FETCH %s (UID FLAGS INTERNALDATE RFC822.SIZE %s%s)",
+                      buf_string(buf), use_envelope ? "ENVELOPE BODYSTRUCTURE " : "",
+                      hdrreq);
     imap_cmd_start(adata, cmd);
     FREE(&cmd);
 
@@ -1190,7 +1532,7 @@ static int read_headers_fetch_new(struct Mailbox *m, unsigned int msn_begin,
 
     while (true)
     {
-      rewind(fp);
+      buf_reset(hdr);
       memset(&h, 0, sizeof(h));
       h.edata = edata;
 
@@ -1209,7 +1551,16 @@ static int read_headers_fetch_new(struct Mailbox *m, unsigned int msn_begin,
         break;
       }
 
-      switch (msg_fetch_header(m, &h, adata->buf, fp))
+      /* The ENVELOPE may contain literals, so read the whole response first */
+      char *line = adata->buf;
+      if (resp)
+      {
+        if (read_fetch_response(adata, resp) < 0)
+          goto bail;
+        line = resp->data;
+      }
+
+      switch (msg_fetch_header(m, &h, line, hdr))
       {
         case 0:
           break;
@@ -1219,15 +1570,12 @@ static int read_headers_fetch_new(struct Mailbox *m, unsigned int msn_begin,
           goto bail;
       }
 
-      if (!ftello(fp))
+      if (buf_is_empty(hdr) && !h.envelope)
       {
         mutt_debug(LL_DEBUG2, "ignoring fetch response with no body\n");
         continue;
       }
 
-      /* make sure we don't get remnants from older larger message headers */
-      fputs("\n\n", fp);
-
       if ((h.edata->msn < 1) || (h.edata->msn > fetch_msn_end))
       {
         mutt_debug(LL_DEBUG1, "skipping FETCH response for unknown message number %d\n",
@@ -1276,12 +1624,16 @@ static int read_headers_fetch_new(struct Mailbox *m, unsigned int msn_begin,
       if (*maxuid < h.edata->uid)
         *maxuid = h.edata->uid;
 
-      rewind(fp);
-      /* NOTE: if Date: header is missing, mutt_rfc822_read_header depends
+      /* NOTE: if Date: header is missing, mutt_rfc822_read_header_str depends
        *   on h.received being set */
-      e->env = mutt_rfc822_read_header(fp, e, false, false);
+      e->env = mutt_rfc822_read_header_str(buf_string(hdr), buf_len(hdr), e, false, false);
       /* body built as a side-effect of mutt_rfc822_read_header */
       e->body->length = h.content_length;
+
+      if (h.envelope && (imap_parse_envelope(h.envelope, e) < 0))
+        mutt_debug(LL_DEBUG1, "bogus ENVELOPE for message %u\n", h.edata->uid);
+      if (h.bodystructure && (imap_parse_bodystructure(h.bodystructure, e) < 0))
+        mutt_debug(LL_DEBUG1, "bogus BODYSTRUCTURE for message %u\n", h.edata->uid);
       mailbox_size_add(m, e);
 
 #ifdef USE_HCACHE
@@ -1316,8 +1668,8 @@ static int read_headers_fetch_new(struct Mailbox *m, unsigned int msn_begin,
 bail:
   buf_pool_release(&hdr_list);
   buf_pool_release(&buf);
-  buf_pool_release(&tempfile);
-  mutt_file_fclose(&fp);
+  buf_pool_release(&hdr);
+  buf_pool_release(&resp);
   FREE(&hdrreq);
   imap_edata_free((void **) &edata);
   progress_free(&progress);
@@ -1354,6 +1706,8 @@ int imap_read_headers(struct Mailbox *m, unsigned int msn_begin,
   bool eval_condstore = false;
   bool eval_qresync = false;
   char *uid_seqset = NULL;
+  struct UidFlagsArray ufa = ARRAY_HEAD_INITIALIZER;
+  unsigned int ufa_uid_next = 0;
   const unsigned int msn_begin_save = msn_begin;
 #endif /* USE_HCACHE */
 
@@ -1408,6 +1762,9 @@ retry:
         if (!eval_qresync && has_condstore)
           eval_condstore = true;
       }
+
+      if (!eval_qresync)
+        imap_hcache_get_uid_flags(mdata, &ufa, &ufa_uid_next);
     }
   }
   if (evalhc)
@@ -1419,9 +1776,20 @@ retry:
     }
     else
     {
-      if (read_headers_normal_eval_cache(adata, msn_end, uid_next, has_condstore || has_qresync,
-                                         eval_condstore) < 0)
+      int rc2 = 1;
+      if (!ARRAY_EMPTY(&ufa))
+      {
+        rc2 = read_headers_uid_flags_eval_cache(adata, msn_end, &ufa,
+                                                ufa_uid_next, eval_condstore);
+      }
+      if (rc2 < 0)
         goto bail;
+      if ((rc2 > 0) && (read_headers_normal_eval_cache(adata, msn_end, uid_next,
+                                                       has_condstore || has_qresync,
+                                                       eval_condstore) < 0))
+      {
+        goto bail;
+      }
     }
 
     if ((eval_condstore || eval_qresync) && (modseq != mdata->modseq))
@@ -1443,6 +1811,18 @@ retry:
   }
 #endif /* USE_HCACHE */
 
+  /* Download the newest headers now, and the rest later.
+   * Not with QRESYNC: VANISHED gives UIDs, which can't be matched to the
+   * MSNs of the headers that haven't been downloaded yet. */
+  const long c_imap_fetch_newest = cs_subset_long(NeoMutt->sub, "imap_fetch_newest");
+  if (initial_download && !adata->qresync && (c_imap_fetch_newest > 0) &&
+      (msn_end >= msn_begin) && ((msn_end - msn_begin) >= c_imap_fetch_newest))
+  {
+    mdata->deferred_msn = msn_end - c_imap_fetch_newest;
+    mutt_debug(LL_DEBUG2, "Deferring headers %u to %u\n", msn_begin, mdata->deferred_msn);
+    msn_begin = mdata->deferred_msn + 1;
+  }
+
   if (read_headers_fetch_new(m, msn_begin, msn_end, evalhc, &maxuid, initial_download) < 0)
     goto bail;
 
@@ -1457,6 +1837,7 @@ retry:
       modseq = 0;
       maxuid = 0;
       FREE(&uid_seqset);
+      ARRAY_FREE(&ufa);
       uidvalidity = 0;
       uid_next = 0;
       msn_begin = msn_begin_save;
@@ -1501,6 +1882,8 @@ retry:
       imap_hcache_store_uid_seqset(mdata);
     else
       imap_hcache_clear_uid_seqset(mdata);
+
+    imap_hcache_store_uid_flags(mdata);
   }
 #endif /* USE_HCACHE */
 
@@ -1515,11 +1898,95 @@ bail:
 #ifdef USE_HCACHE
   imap_hcache_close(mdata);
   FREE(&uid_seqset);
+  ARRAY_FREE(&ufa);
 #endif /* USE_HCACHE */
 
   return rc;
 }
 
+/**
+ * imap_read_headers_deferred - Download a batch of deferred headers
+ * @param m Mailbox
+ * @retval num Number of Emails added
+ * @retval -1  Error
+ *
+ * With `$imap_fetch_newest`, the older headers aren't downloaded when the
+ * Mailbox is opened.  Fetch the next batch of them, working backwards.
+ */
+int imap_read_headers_deferred(struct Mailbox *m)
+{
+  struct ImapAccountData *adata = imap_adata_get(m);
+  struct ImapMboxData *mdata = imap_mdata_get(m);
+  if (!adata || (adata->mailbox != m) || !mdata || (mdata->deferred_msn == 0))
+    return 0;
+
+  long batch = cs_subset_long(NeoMutt->sub, "imap_fetch_chunk_size");
+  if (batch <= 0)
+    batch = cs_subset_long(NeoMutt->sub, "imap_fetch_newest");
+  if (batch <= 0)
+    batch = mdata->deferred_msn;
+
+  const unsigned int msn_end = mdata->deferred_msn;
+  const unsigned int msn_begin = (msn_end > batch) ? (msn_end - batch + 1) : 1;
+  const int old_count = m->msg_count;
+  unsigned int maxuid = 0;
+
+  mutt_debug(LL_DEBUG2, "Fetching deferred headers %u to %u\n", msn_begin, msn_end);
+
+#ifdef USE_HCACHE
+  imap_hcache_open(adata, mdata);
+#endif /* USE_HCACHE */
+
+  /* Skip any MSNs that the header cache has already filled in */
+  const bool verbose = m->verbose;
+  m->verbose = false;
+  int rc = read_headers_fetch_new(m, msn_begin, msn_end, true, &maxuid, false);
+  m->verbose = verbose;
+
+#ifdef USE_HCACHE
+  imap_hcache_close(mdata);
+#endif /* USE_HCACHE */
+
+  if (rc < 0)
+    return -1;
+
+  mdata->deferred_msn = msn_begin - 1;
+
+  /* The backfilled Emails are older than everything we already have.
+   * Move them to the front, in MSN order, so that e->index matches the
+   * server's order. */
+  const int num_new = m->msg_count - old_count;
+  if ((num_new > 0) && (old_count > 0))
+  {
+    struct Email **emails = mutt_mem_calloc(m->msg_count, sizeof(struct Email *));
+    int count = 0;
+    for (unsigned int msn = msn_begin; msn <= msn_end; msn++)
+    {
+      struct Email *e = imap_msn_get(&mdata->msn, msn - 1);
+      if (e && (e->index >= old_count) && (e->index < m->msg_count))
+        emails[count++] = e;
+    }
+    for (int i = 0; i < old_count; i++)
+      emails[count++] = m->emails[i];
+
+    if (count == m->msg_count)
+    {
+      for (int i = 0; i < count; i++)
+      {
+        m->emails[i] = emails[i];
+        m->emails[i]->index = i;
+      }
+    }
+    FREE(&emails);
+  }
+
+  /* The caller reports MX_STATUS_FLAGS, so tell the view about the Emails */
+  if (num_new > 0)
+    mailbox_changed(m, NT_MAILBOX_INVALID);
+
+  return num_new;
+}
+
 /**
  * imap_append_message - Write an email back to the server
  * @param m   Mailbox
@@ -1587,18 +2054,28 @@ int imap_append_message(struct Mailbox *m, struct Message *msg)
   if (msg->flags.draft)
     mutt_str_cat(imap_flags, sizeof(imap_flags), " \\Draft");
 
-  snprintf(buf, sizeof(buf), "APPEND %s (%s) \"%s\" {%lu}", mdata->munge_name,
-           imap_flags + 1, internaldate, (unsigned long) len);
+  /* With a non-synchronizing literal, we don't need to wait for the server's
+   * continuation before sending the message, saving a round trip */
+  const bool nonsync = (adata->capabilities & IMAP_CAP_LITERAL_PLUS) ||
+                       ((adata->capabilities & IMAP_CAP_LITERAL_MINUS) &&
+                        (len <= IMAP_LITERAL_MINUS_MAX));
 
-  imap_cmd_start(adata, buf);
+  snprintf(buf, sizeof(buf), "APPEND %s (%s) \"%s\" {%lu%s}", mdata->munge_name,
+           imap_flags + 1, internaldate, (unsigned long) len, nonsync ? "+" : "");
 
-  do
+  if (imap_cmd_start(adata, buf) < 0)
+    goto fail;
+
+  if (!nonsync)
   {
-    rc = imap_cmd_step(adata);
-  } while (rc == IMAP_RES_CONTINUE);
+    do
+    {
+      rc = imap_cmd_step(adata);
+    } while (rc == IMAP_RES_CONTINUE);
 
-  if (rc != IMAP_RES_RESPOND)
-    goto cmd_step_fail;
+    if (rc != IMAP_RES_RESPOND)
+      goto cmd_step_fail;
+  }
 
   for (last = EOF, sent = len = 0; (c = fgetc(fp)) != EOF; last = c)
   {
@@ -1874,6 +2351,9 @@ int imap_cache_del(struct Mailbox *m, struct Email *e)
 
   mdata->bcache = imap_bcache_open(m);
   char id[64] = { 0 };
+  partial_cache_id(mdata, e, id, sizeof(id));
+  mutt_bcache_del(mdata->bcache, id);
+
   snprintf(id, sizeof(id), "%u-%u", mdata->uidvalidity, imap_edata_get(e)->uid);
   return mutt_bcache_del(mdata->bcache, id);
 }
@@ -1969,6 +2449,452 @@ char *imap_set_flags(struct Mailbox *m, struct Email *e, char *s, bool *server_c
   return s;
 }
 
+/**
+ * prefetch_select - Choose the Emails to fetch along with the one being opened
+ * @param[in]  m  Selected Imap Mailbox
+ * @param[in]  e  Email being opened
+ * @param[out] ea Emails to prefetch
+ *
+ * The user is likely to read the messages following this one, in the order
+ * of the index (which follows the threads).  Pick up to `$imap_prefetch` of
+ * them that aren't yet cached, within a total of `$imap_prefetch_size` bytes.
+ */
+static void prefetch_select(struct Mailbox *m, struct Email *e, struct EmailArray *ea)
+{
+  const short c_imap_prefetch = cs_subset_number(NeoMutt->sub, "imap_prefetch");
+  if ((c_imap_prefetch <= 0) || (e->vnum < 0) || !m->v2r)
+    return;
+
+  struct ImapMboxData *mdata = imap_mdata_get(m);
+  mdata->bcache = imap_bcache_open(m);
+  if (!mdata->bcache)
+    return;
+
+  const long c_imap_prefetch_size = cs_subset_long(NeoMutt->sub, "imap_prefetch_size");
+  long budget = c_imap_prefetch_size;
+
+  for (int v = e->vnum + 1; (v < m->vcount) && (ARRAY_SIZE(ea) < c_imap_prefetch); v++)
+  {
+    struct Email *e_next = m->emails[m->v2r[v]];
+    if (!e_next || !e_next->active || !e_next->body || msg_cache_exists(m, e_next))
+      continue;
+
+    /* Stop at the first message that doesn't fit, to keep to the index order */
+    budget -= e_next->body->length;
+    if (budget < 0)
+      break;
+
+    ARRAY_ADD(ea, e_next);
+  }
+}
+
+/**
+ * prefetch_store - Save a prefetched message into the message cache
+ * @param m     Selected Imap Mailbox
+ * @param e     Email
+ * @param bytes Size of the literal
+ * @retval  0 Success
+ * @retval -1 Failure reading from the server
+ */
+static int prefetch_store(struct Mailbox *m, struct Email *e, unsigned long bytes)
+{
+  struct ImapAccountData *adata = imap_adata_get(m);
+
+  FILE *fp = msg_cache_put(m, e);
+  if (!fp)
+  {
+    /* Keep the connection in step, but discard the message */
+    struct Buffer *buf = buf_pool_get();
+    int rc = imap_read_literal_buf(buf, adata, bytes);
+    buf_pool_release(&buf);
+    return rc;
+  }
+
+  int rc = imap_read_literal(fp, adata, bytes, NULL);
+  if ((mutt_file_fclose(&fp) != 0) || (rc < 0))
+  {
+    imap_cache_del(m, e);
+    return rc;
+  }
+
+  if (msg_cache_commit(m, e) < 0)
+    mutt_debug(LL_DEBUG1, "failed to add message to cache\n");
+
+  return 0;
+}
+
+/**
+ * prefetch_skip - Discard a FETCH response that wasn't asked for
+ * @param adata Imap Account data
+ * @retval  0 Success
+ * @retval -1 Failure reading from the server
+ *
+ * Any literals in the response are read and thrown away, so that the
+ * connection stays in step.
+ */
+static int prefetch_skip(struct ImapAccountData *adata)
+{
+  while (true)
+  {
+    const size_t len = mutt_str_len(adata->buf);
+    if ((len == 0) || (adata->buf[len - 1] != '}'))
+      return 0;
+
+    unsigned int bytes = 0;
+    char *open = strrchr(adata->buf, '{');
+    if (!open || (imap_get_literal_count(open, &bytes) < 0))
+      return -1;
+
+    FILE *fp = mutt_file_fopen("/dev/null", "w");
+    if (!fp)
+      return -1;
+    int rc = imap_read_literal(fp, adata, bytes, NULL);
+    mutt_file_fclose(&fp);
+    if (rc < 0)
+      return -1;
+
+    /* pick up the rest of the response */
+    if (imap_cmd_step(adata) != IMAP_RES_CONTINUE)
+      return -1;
+  }
+}
+
+/**
+ * prefetch_set_active - Set the active flag on the prefetched Emails
+ * @param ea     Emails
+ * @param active Value to set
+ */
+static void prefetch_set_active(struct EmailArray *ea, bool active)
+{
+  struct Email **ep = NULL;
+  ARRAY_FOREACH(ep, ea)
+  {
+    (*ep)->active = active;
+  }
+}
+
+/**
+ * partial_split - Should the parts of a multipart be fetched separately?
+ * @param b Body
+ * @retval true The parts can be fetched separately
+ *
+ * Signed and encrypted multiparts must be kept intact.
+ */
+static bool partial_split(const struct Body *b)
+{
+  return (b->type == TYPE_MULTIPART) && b->parts &&
+         !mutt_istr_equal(b->subtype, "signed") && !mutt_istr_equal(b->subtype, "encrypted");
+}
+
+/**
+ * partial_wanted - Should a part be included in a partial fetch?
+ * @param b Body
+ * @retval true The part should be downloaded
+ */
+static bool partial_wanted(const struct Body *b)
+{
+  if ((b->type == TYPE_TEXT) && (b->disposition != DISP_ATTACH))
+    return true;
+
+  return (b->length <= IMAP_PARTIAL_SMALL_PART);
+}
+
+/**
+ * partial_add_sections - List the sections needed for a partial fetch
+ * @param b      Multipart Body
+ * @param prefix Section number of the multipart, e.g. "2.", or "" for the message
+ * @param cmd    Buffer for the FETCH items
+ * @retval num Number of parts left out
+ */
+static int partial_add_sections(const struct Body *b, const char *prefix, struct Buffer *cmd)
+{
+  char section[128] = { 0 };
+  int skipped = 0;
+  int num = 1;
+
+  for (const struct Body *part = b->parts; part; part = part->next, num++)
+  {
+    snprintf(section, sizeof(section), "%s%d", prefix, num);
+    buf_add_printf(cmd, " BODY.PEEK[%s.MIME]", section);
+
+    if (partial_split(part))
+    {
+      mutt_str_cat(section, sizeof(section), ".");
+      skipped += partial_add_sections(part, section, cmd);
+    }
+    else if (partial_wanted(part))
+    {
+      buf_add_printf(cmd, " BODY.PEEK[%s]", section);
+    }
+    else
+    {
+      skipped++;
+    }
+  }
+
+  return skipped;
+}
+
+/**
+ * partial_parse_sections - Collect the sections from a FETCH response
+ * @param s        FETCH response, with the literals inlined
+ * @param sections Hash Table for the sections, keyed by section name
+ * @param buf      Temporary Buffer
+ */
+static void partial_parse_sections(char *s, struct HashTable *sections, struct Buffer *buf)
+{
+  s = strchr(s, '(');
+  if (!s)
+    return;
+  s++;
+
+  while (true)
+  {
+    SKIPWS(s);
+    if ((*s == ')') || (*s == '\0'))
+      break;
+
+    if (mutt_istr_startswith(s, "BODY["))
+    {
+      char *key = s + 5;
+      char *end = strchr(key, ']');
+      if (!end)
+        break;
+      *end = '\0';
+      s = end + 1;
+
+      if (!imap_parse_nstring(&s, buf, NULL))
+        break;
+      if (!mutt_hash_find(sections, key))
+        mutt_hash_insert(sections, key, buf_strdup(buf));
+    }
+    else if (!(s = imap_skip_item(s)) || !(s = imap_skip_item(s)))
+    {
+      break;
+    }
+  }
+}
+
+/**
+ * partial_section_free - Free a section of a message - Implements ::hash_hdata_free_t - @ingroup hash_hdata_free_api
+ */
+static void partial_section_free(int type, void *obj, intptr_t data)
+{
+  FREE(&obj);
+}
+
+/**
+ * partial_write - Write the parts of a multipart, leaving out the large ones
+ * @param fp       File to write to
+ * @param b        Multipart Body
+ * @param prefix   Section number of the multipart, e.g. "2.", or "" for the message
+ * @param sections Sections fetched from the server
+ * @retval true  Success
+ * @retval false A section is missing
+ *
+ * Parts that weren't fetched are replaced by a message/external-body, which
+ * keeps their original MIME headers, like a deleted attachment.
+ */
+static bool partial_write(FILE *fp, const struct Body *b, const char *prefix,
+                          struct HashTable *sections)
+{
+  const char *boundary = mutt_param_get(&b->parameter, "boundary");
+  if (!boundary)
+    return false;
+
+  char section[128] = { 0 };
+  char key[160] = { 0 };
+  int num = 1;
+
+  for (const struct Body *part = b->parts; part; part = part->next, num++)
+  {
+    snprintf(section, sizeof(section), "%s%d", prefix, num);
+    snprintf(key, sizeof(key), "%s.MIME", section);
+    const char *mime = mutt_hash_find(sections, key);
+    if (!mime)
+      return false;
+
+    fprintf(fp, "\n--%s\n", boundary);
+
+    if (partial_split(part))
+    {
+      fputs(mime, fp);
+      mutt_str_cat(section, sizeof(section), ".");
+      if (!partial_write(fp, part, section, sections))
+        return false;
+    }
+    else if (partial_wanted(part))
+    {
+      const char *data = mutt_hash_find(sections, section);
+      if (!data)
+        return false;
+      fputs(mime, fp);
+      fputs(data, fp);
+    }
+    else
+    {
+      fprintf(fp,
+              "Content-Type: message/external-body; access-type=x-neomutt-partial;\n"
+              "\tlength=" OFF_T_FMT "\n"
+              "\n",
+              part->length);
+      fputs(mime, fp);
+    }
+  }
+
+  fprintf(fp, "\n--%s--\n", boundary);
+  return true;
+}
+
+/**
+ * partial_fetch_cmd - Run a FETCH command and collect the responses
+ * @param adata Imap Account data
+ * @param cmd   Command to run
+ * @param resp  Buffer for the FETCH response, with literals inlined
+ * @param func  Callback for each FETCH response
+ * @param data  Private data for the callback
+ * @retval  0 Success
+ * @retval -1 Failure
+ */
+static int partial_fetch_cmd(struct ImapAccountData *adata, const char *cmd,
+                             struct Buffer *resp, void (*func)(struct Buffer *resp, void *data),
+                             void *data)
+{
+  int rc;
+
+  imap_cmd_start(adata, cmd);
+  while ((rc = imap_cmd_step(adata)) == IMAP_RES_CONTINUE)
+  {
+    char *pc = imap_next_word(imap_next_word(adata->buf));
+    if (!mutt_istr_startswith(pc, "FETCH"))
+      continue;
+
+    if (read_fetch_response(adata, resp) < 0)
+      return -1;
+
+    func(resp, data);
+  }
+
+  return (rc == IMAP_RES_OK) ? 0 : -1;
+}
+
+/**
+ * partial_parse_bodystructure - Parse the BODYSTRUCTURE of a FETCH response
+ * @param resp FETCH response
+ * @param data Email to fill
+ */
+static void partial_parse_bodystructure(struct Buffer *resp, void *data)
+{
+  const char *s = mutt_istr_find(resp->data, "BODYSTRUCTURE ");
+  if (s)
+    imap_parse_bodystructure((char *) s + 14, data);
+}
+
+/**
+ * partial_store_sections - Save the sections of a FETCH response
+ * @param resp FETCH response
+ * @param data Hash Table of sections
+ */
+static void partial_store_sections(struct Buffer *resp, void *data)
+{
+  struct Buffer *buf = buf_pool_get();
+  partial_parse_sections(resp->data, data, buf);
+  buf_pool_release(&buf);
+}
+
+/**
+ * msg_fetch_partial - Fetch a message without its large attachments
+ * @param[in]  m  Selected Imap Mailbox
+ * @param[in]  e  Email
+ * @param[out] fp File containing the partial message
+ * @retval  0 Success
+ * @retval  1 The message can't be split, fetch it all
+ * @retval -1 Error
+ *
+ * Fetch the BODYSTRUCTURE, then only the header, the MIME headers of each
+ * part, and the parts that are worth displaying.  The result is a valid
+ * message, which is saved in the message cache separately from the full
+ * message.
+ */
+static int msg_fetch_partial(struct Mailbox *m, struct Email *e, FILE **fp)
+{
+  struct ImapAccountData *adata = imap_adata_get(m);
+  struct ImapMboxData *mdata = imap_mdata_get(m);
+  const unsigned int uid = imap_edata_get(e)->uid;
+
+  struct Buffer *cmd = buf_pool_get();
+  struct Buffer *resp = buf_pool_get();
+  struct HashTable *sections = NULL;
+  struct Email *e_tmp = email_new();
+  e_tmp->body = mutt_body_new();
+  char id[64] = { 0 };
+  int rc = -1;
+
+  buf_printf(cmd, "UID FETCH %u BODYSTRUCTURE", uid);
+  if (partial_fetch_cmd(adata, buf_string(cmd), resp, partial_parse_bodystructure, e_tmp) < 0)
+    goto done;
+
+  rc = 1;
+  if (!partial_split(e_tmp->body))
+    goto done;
+
+  buf_printf(cmd, "UID FETCH %u (BODY.PEEK[HEADER]", uid);
+  if (partial_add_sections(e_tmp->body, "", cmd) == 0)
+    goto done;
+  buf_addch(cmd, ')');
+
+  sections = mutt_hash_new(64, MUTT_HASH_STRCASECMP | MUTT_HASH_STRDUP_KEYS);
+  mutt_hash_set_destructor(sections, partial_section_free, 0);
+
+  if (partial_fetch_cmd(adata, buf_string(cmd), resp, partial_store_sections, sections) < 0)
+  {
+    rc = -1;
+    goto done;
+  }
+
+  const char *header = mutt_hash_find(sections, "HEADER");
+  if (!header)
+    goto done;
+
+  mdata->bcache = imap_bcache_open(m);
+  partial_cache_id(mdata, e, id, sizeof(id));
+  *fp = mutt_bcache_put(mdata->bcache, id);
+  if (!*fp)
+  {
+    struct Buffer *path = buf_pool_get();
+    buf_mktemp(path);
+    *fp = mutt_file_fopen(buf_string(path), "w+");
+    unlink(buf_string(path));
+    buf_pool_release(&path);
+
+    if (!*fp)
+    {
+      rc = -1;
+      goto done;
+    }
+  }
+
+  fputs(header, *fp);
+  if (!partial_write(*fp, e_tmp->body, "", sections) || (fflush(*fp) != 0) || ferror(*fp))
+  {
+    mutt_file_fclose(fp);
+    mutt_bcache_del(mdata->bcache, id);
+    goto done;
+  }
+
+  if (mutt_bcache_commit(mdata->bcache, id) < 0)
+    mutt_debug(LL_DEBUG1, "failed to add partial message to cache\n");
+
+  rc = 0;
+
+done:
+  mutt_hash_free(&sections);
+  email_free(&e_tmp);
+  buf_pool_release(&cmd);
+  buf_pool_release(&resp);
+  return rc;
+}
+
 /**
  * imap_msg_open - Open an email message in a Mailbox - Implements MxOps::msg_open() - @ingroup mx_msg_open
  */
@@ -1988,10 +2914,21 @@ bool imap_msg_open(struct Mailbox *m, struct Message *msg, struct Email *e)
   bool fetched = false;
 
   struct ImapAccountData *adata = imap_adata_get(m);
+  struct EmailArray prefetch = ARRAY_HEAD_INITIALIZER;
 
   if (!adata || (adata->mailbox != m))
     return false;
 
+  struct ImapMboxData *mdata = imap_mdata_get(m);
+  char id[64] = { 0 };
+
+  /* The caller will accept a message without its large attachments */
+  const long c_imap_partial_fetch_size = cs_subset_long(NeoMutt->sub, "imap_partial_fetch_size");
+  const bool partial = msg->partial && (c_imap_partial_fetch_size > 0) &&
+                       (e->body->length > c_imap_partial_fetch_size) &&
+                       (adata->capabilities & IMAP_CAP_IMAP4REV1);
+  msg->partial = false;
+
   msg->fp = msg_cache_get(m, e);
   if (msg->fp)
   {
@@ -2000,12 +2937,35 @@ bool imap_msg_open(struct Mailbox *m, struct Message *msg, struct Email *e)
     goto parsemsg;
   }
 
+  if (partial)
+  {
+    partial_cache_id(mdata, e, id, sizeof(id));
+    msg->fp = mutt_bcache_get(mdata->bcache, id);
+    if (msg->fp)
+    {
+      msg->partial = true;
+      goto parsemsg;
+    }
+  }
+
   /* This function is called in a few places after endwin()
    * e.g. mutt_pipe_message(). */
   bool output_progress = !isendwin() && m->verbose;
   if (output_progress)
     mutt_message(_("Fetching message..."));
 
+  if (partial)
+  {
+    rc = msg_fetch_partial(m, e, &msg->fp);
+    if (rc < 0)
+      return false;
+    if (rc == 0)
+    {
+      msg->partial = true;
+      goto parsemsg;
+    }
+  }
+
   msg->fp = msg_cache_put(m, e);
   if (!msg->fp)
   {
@@ -2024,13 +2984,26 @@ bool imap_msg_open(struct Mailbox *m, struct Message *msg, struct Email *e)
    * command handler */
   e->active = false;
 
+  /* Messages are only prefetched if it won't mark them as read */
   const bool c_imap_peek = cs_subset_bool(NeoMutt->sub, "imap_peek");
-  snprintf(buf, sizeof(buf), "UID FETCH %u %s", imap_edata_get(e)->uid,
-           ((adata->capabilities & IMAP_CAP_IMAP4REV1) ?
-                (c_imap_peek ? "BODY.PEEK[]" : "BODY[]") :
-                "RFC822"));
+  if (c_imap_peek && (adata->capabilities & IMAP_CAP_IMAP4REV1))
+    prefetch_select(m, e, &prefetch);
+  prefetch_set_active(&prefetch, false);
 
-  imap_cmd_start(adata, buf);
+  struct Buffer *cmd = buf_pool_get();
+  buf_printf(cmd, "UID FETCH %u", imap_edata_get(e)->uid);
+  struct Email **ep = NULL;
+  ARRAY_FOREACH(ep, &prefetch)
+  {
+    buf_add_printf(cmd, ",%u", imap_edata_get(*ep)->uid);
+  }
+  buf_add_printf(cmd, " %s",
+                 ((adata->capabilities & IMAP_CAP_IMAP4REV1) ?
+                      (c_imap_peek ? "BODY.PEEK[]" : "BODY[]") :
+                      "RFC822"));
+
+  imap_cmd_start(adata, buf_string(cmd));
+  buf_pool_release(&cmd);
   do
   {
     rc = imap_cmd_step(adata);
@@ -2043,6 +3016,34 @@ bool imap_msg_open(struct Mailbox *m, struct Message *msg, struct Email *e)
 
     if (mutt_istr_startswith(pc, "FETCH"))
     {
+      /* Work out which of the requested messages this is */
+      struct Email *e_fetch = e;
+      if (!ARRAY_EMPTY(&prefetch))
+      {
+        unsigned int msn = 0;
+        if (mutt_str_atoui(adata->buf + 2, &msn) && (msn > 0))
+          e_fetch = imap_msn_get(&mdata->msn, msn - 1);
+
+        if (e_fetch != e)
+        {
+          bool found = false;
+          ARRAY_FOREACH(ep, &prefetch)
+          {
+            if (*ep == e_fetch)
+            {
+              found = true;
+              break;
+            }
+          }
+          if (!found)
+          {
+            if (prefetch_skip(adata) < 0)
+              goto bail;
+            continue;
+          }
+        }
+      }
+
       while (*pc)
       {
         pc = imap_next_word(pc);
@@ -2053,7 +3054,7 @@ bool imap_msg_open(struct Mailbox *m, struct Message *msg, struct Email *e)
           pc = imap_next_word(pc);
           if (!mutt_str_atoui(pc, &uid))
             goto bail;
-          if (uid != imap_edata_get(e)->uid)
+          if (uid != imap_edata_get(e_fetch)->uid)
           {
             mutt_error(_("The message index is incorrect. Try reopening the mailbox."));
           }
@@ -2067,8 +3068,15 @@ bool imap_msg_open(struct Mailbox *m, struct Message *msg, struct Email *e)
             goto bail;
           }
 
-          const int res = imap_read_literal(msg->fp, adata, bytes, NULL);
-          if (res < 0)
+          if (e_fetch == e)
+          {
+            const int res = imap_read_literal(msg->fp, adata, bytes, NULL);
+            if (res < 0)
+            {
+              goto bail;
+            }
+          }
+          else if (prefetch_store(m, e_fetch, bytes) < 0)
           {
             goto bail;
           }
@@ -2078,9 +3086,10 @@ bool imap_msg_open(struct Mailbox *m, struct Message *msg, struct Email *e)
             goto bail;
           pc = adata->buf;
 
-          fetched = true;
+          if (e_fetch == e)
+            fetched = true;
         }
-        else if (!e->changed && mutt_istr_startswith(pc, "FLAGS"))
+        else if ((e_fetch == e) && !e->changed && mutt_istr_startswith(pc, "FLAGS"))
         {
           /* UW-IMAP will provide a FLAGS update here if the FETCH causes a
            * change (eg from \Unseen to \Seen).
@@ -2096,6 +3105,8 @@ bool imap_msg_open(struct Mailbox *m, struct Message *msg, struct Email *e)
 
   /* see comment before command start. */
   e->active = true;
+  prefetch_set_active(&prefetch, true);
+  ARRAY_FREE(&prefetch);
 
   fflush(msg->fp);
   if (ferror(msg->fp))
@@ -2110,6 +3121,10 @@ bool imap_msg_open(struct Mailbox *m, struct Message *msg, struct Email *e)
   if (msg_cache_commit(m, e) < 0)
     mutt_debug(LL_DEBUG1, "failed to add message to cache\n");
 
+  /* The full message supersedes any partial copy */
+  partial_cache_id(mdata, e, id, sizeof(id));
+  mutt_bcache_del(mdata->bcache, id);
+
 parsemsg:
   /* Update the header information.  Previously, we only downloaded a
    * portion of the headers, those required for the main display.  */
@@ -2123,6 +3138,26 @@ parsemsg:
   newenv = mutt_rfc822_read_header(msg->fp, e, false, false);
   mutt_env_merge(e->env, &newenv);
 
+  /* Parts from a BODYSTRUCTURE have no offsets, so let them be rebuilt from
+   * the message itself.  The parts of a partial copy are only fit for display,
+   * so keep the originals, for the header cache. */
+  struct ImapEmailData *edata = imap_edata_get(e);
+  if (msg->partial && !edata->partial)
+  {
+    edata->parts = e->body->parts;
+    e->body->parts = NULL;
+    edata->partial = true;
+  }
+  else
+  {
+    mutt_body_free(&e->body->parts);
+    if (!msg->partial)
+    {
+      mutt_body_free(&edata->parts);
+      edata->partial = false;
+    }
+  }
+
   /* see above. We want the new status in e->read, so we unset it manually
    * and let mutt_set_flag set it correctly, updating context. */
   if (read != e->read)
@@ -2131,6 +3166,15 @@ parsemsg:
     mutt_set_flag(m, e, MUTT_NEW, read, true);
   }
 
+  /* Keep the size and line count of the full message.  It isn't marked as
+   * parsed, so the next full open will parse it again. */
+  if (msg->partial)
+  {
+    mutt_clear_error();
+    rewind(msg->fp);
+    return true;
+  }
+
   e->lines = 0;
   while (fgets(buf, sizeof(buf), msg->fp) && !feof(msg->fp))
   {
@@ -2155,6 +3199,8 @@ parsemsg:
 
 bail:
   e->active = true;
+  prefetch_set_active(&prefetch, true);
+  ARRAY_FREE(&prefetch);
   mutt_file_fclose(&msg->fp);
   imap_cache_del(m, e);
   return false;
@@ -36,6 +36,10 @@ struct ImapHeader
 
   time_t received;
   long content_length;
+
+  char *envelope;      ///< ENVELOPE data, pointing into the response
+  char *bodystructure; ///< BODYSTRUCTURE data, pointing into the response
+  char *header;        ///< Quoted header data, pointing into the response
 };
 
 #endif /* MUTT_IMAP_MESSAGE_H */
@@ -32,6 +32,7 @@
 #include <stdlib.h>
 #include "mutt/lib.h"
 #include "msn.h"
+#include "edata.h"
 #include "mdata.h" // IWYU pragma: keep
 
 /**
@@ -117,3 +118,121 @@ void imap_msn_remove(struct MSNArray *msn, size_t idx)
   if (ep)
     *ep = NULL;
 }
+
+/**
+ * imap_msn_expunge_new - Start a batch of expunges
+ * @param msn MSN structure
+ * @retval ptr New batch, covering every slot of the MSN index
+ */
+struct MsnExpunge *imap_msn_expunge_new(const struct MSNArray *msn)
+{
+  struct MsnExpunge *mx = mutt_mem_calloc(1, sizeof(struct MsnExpunge));
+  mx->size = imap_msn_highest(msn);
+  mx->live = mx->size;
+  mx->tree = mutt_mem_calloc(mx->size + 1, sizeof(unsigned int));
+  mx->gone = mutt_mem_calloc(mx->size + 1, sizeof(bool));
+
+  /* Build the tree in linear time; every slot starts out alive */
+  for (size_t i = 1; i <= mx->size; i++)
+  {
+    mx->tree[i]++;
+    const size_t parent = i + (i & -i);
+    if (parent <= mx->size)
+      mx->tree[parent] += mx->tree[i];
+  }
+
+  return mx;
+}
+
+/**
+ * imap_msn_expunge_free - Free a batch of expunges
+ * @param ptr Batch to free
+ */
+void imap_msn_expunge_free(struct MsnExpunge **ptr)
+{
+  if (!ptr || !*ptr)
+    return;
+
+  struct MsnExpunge *mx = *ptr;
+  FREE(&mx->tree);
+  FREE(&mx->gone);
+  FREE(ptr);
+}
+
+/**
+ * imap_msn_expunge_find - Find the slot of a server MSN
+ * @param mx  Batch of expunges
+ * @param num MSN, as currently numbered by the server
+ * @retval num Index of the slot in the MSN index
+ * @retval -1  MSN is out of range
+ */
+size_t imap_msn_expunge_find(const struct MsnExpunge *mx, size_t num)
+{
+  if (!mx || (num < 1) || (num > mx->live))
+    return (size_t) -1;
+
+  size_t step = 1;
+  while ((step << 1) <= mx->size)
+    step <<= 1;
+
+  size_t pos = 0;
+  for (; step > 0; step >>= 1)
+  {
+    if (((pos + step) <= mx->size) && (mx->tree[pos + step] < num))
+    {
+      pos += step;
+      num -= mx->tree[pos];
+    }
+  }
+
+  return pos;
+}
+
+/**
+ * imap_msn_expunge_mark - Mark a slot as expunged
+ * @param mx  Batch of expunges
+ * @param idx Index of the slot in the MSN index
+ */
+void imap_msn_expunge_mark(struct MsnExpunge *mx, size_t idx)
+{
+  if (!mx || (idx >= mx->size) || mx->gone[idx])
+    return;
+
+  mx->gone[idx] = true;
+  mx->live--;
+  for (size_t i = idx + 1; i <= mx->size; i += (i & -i))
+    mx->tree[i]--;
+}
+
+/**
+ * imap_msn_expunge_apply - Apply a batch of expunges to the MSN index
+ * @param msn MSN structure
+ * @param ptr Batch to apply, will be freed
+ *
+ * The expunged slots are squeezed out and the surviving Emails renumbered in
+ * a single pass.
+ */
+void imap_msn_expunge_apply(struct MSNArray *msn, struct MsnExpunge **ptr)
+{
+  if (!msn || !ptr || !*ptr)
+    return;
+
+  struct MsnExpunge *mx = *ptr;
+  const size_t max_msn = imap_msn_highest(msn);
+
+  size_t j = 0;
+  for (size_t i = 0; i < max_msn; i++)
+  {
+    if ((i < mx->size) && mx->gone[i])
+      continue;
+
+    struct Email *e = imap_msn_get(msn, i);
+    if (e)
+      imap_edata_get(e)->msn = j + 1;
+    imap_msn_set(msn, j, e);
+    j++;
+  }
+
+  imap_msn_shrink(msn, max_msn - j);
+  imap_msn_expunge_free(ptr);
+}
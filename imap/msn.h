@@ -24,12 +24,33 @@
 #ifndef MUTT_IMAP_MSN_H
 #define MUTT_IMAP_MSN_H
 
+#include <stdbool.h>
 #include <stdlib.h>
 
 struct MSNArray;
 struct Email;
 
+/**
+ * struct MsnExpunge - A batch of expunges waiting to be applied to the MSN index
+ *
+ * While a batch is open, the MSN index isn't shifted.  Expunged slots are
+ * marked and a Fenwick tree of the surviving slots maps the server's current
+ * MSNs back onto the index.
+ */
+struct MsnExpunge
+{
+  size_t size;        ///< Number of slots in the MSN index when the batch began
+  size_t live;        ///< Number of slots that haven't been expunged
+  unsigned int *tree; ///< Fenwick tree counting the surviving slots
+  bool *gone;         ///< Slots that have been expunged
+};
+
 void          imap_msn_free   (struct MSNArray *msn);
+void          imap_msn_expunge_apply(struct MSNArray *msn, struct MsnExpunge **ptr);
+size_t        imap_msn_expunge_find (const struct MsnExpunge *mx, size_t num);
+void          imap_msn_expunge_free (struct MsnExpunge **ptr);
+void          imap_msn_expunge_mark (struct MsnExpunge *mx, size_t idx);
+struct MsnExpunge *imap_msn_expunge_new(const struct MSNArray *msn);
 struct Email *imap_msn_get    (const struct MSNArray *msn, size_t idx);
 size_t        imap_msn_highest(const struct MSNArray *msn);
 void          imap_msn_remove (struct MSNArray *msn, size_t idx);
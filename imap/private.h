@@ -87,6 +87,12 @@ enum ImapExecResult
 /* length of "DD-MMM-YYYY HH:MM:SS +ZZzz" (null-terminated) */
 #define IMAP_DATELEN 27
 
+/* largest non-synchronizing literal allowed by LITERAL- (RFC7888) */
+#define IMAP_LITERAL_MINUS_MAX 4096
+
+/* non-text parts up to this size are always included in a partial fetch */
+#define IMAP_PARTIAL_SMALL_PART 65536
+
 /**
  * enum ImapFlags - IMAP server responses
  */
@@ -139,8 +145,12 @@ typedef uint32_t ImapCapFlags;              ///< Flags, e.g. #IMAP_CAP_IMAP4
 #define IMAP_CAP_COMPRESS         (1 << 18) ///< RFC4978: COMPRESS=DEFLATE
 #define IMAP_CAP_X_GM_EXT_1       (1 << 19) ///< https://developers.google.com/gmail/imap/imap-extensions
 #define IMAP_CAP_ID               (1 << 20) ///< RFC2971: IMAP4 ID extension
+#define IMAP_CAP_SORT             (1 << 21) ///< RFC5256: SORT extension
+#define IMAP_CAP_LITERAL_PLUS     (1 << 22) ///< RFC7888: LITERAL+
+#define IMAP_CAP_LITERAL_MINUS    (1 << 23) ///< RFC7888: LITERAL-
+#define IMAP_CAP_NOTIFY           (1 << 24) ///< RFC5465: NOTIFY
 
-#define IMAP_CAP_ALL             ((1 << 21) - 1)
+#define IMAP_CAP_ALL             ((1 << 25) - 1)
 
 /**
  * struct ImapList - Items in an IMAP browser
@@ -177,6 +187,20 @@ struct SeqsetIterator
   char *substr_end;
 };
 
+/**
+ * struct ImapUidFlags - The UID and server flags of an Email, kept in the header cache
+ */
+struct ImapUidFlags
+{
+  unsigned int uid; ///< 32-bit Message UID
+  bool read    : 1; ///< Email has been read
+  bool old     : 1; ///< Email has been seen
+  bool deleted : 1; ///< Email has been deleted
+  bool flagged : 1; ///< Email has been flagged
+  bool replied : 1; ///< Email has been replied to
+};
+ARRAY_HEAD(UidFlagsArray, struct ImapUidFlags);
+
 /* -- private IMAP functions -- */
 /* imap.c */
 int imap_create_mailbox(struct ImapAccountData *adata, const char *mailbox);
@@ -184,8 +208,12 @@ int imap_rename_mailbox(struct ImapAccountData *adata, char *oldname, const char
 int imap_open_connection(struct ImapAccountData *adata);
 void imap_close_connection(struct ImapAccountData *adata);
 int imap_read_literal(FILE *fp, struct ImapAccountData *adata, unsigned long bytes, struct Progress *progress);
+int imap_read_literal_buf(struct Buffer *buf, struct ImapAccountData *adata, unsigned long bytes);
 void imap_expunge_mailbox(struct Mailbox *m, bool resort);
 int imap_login(struct ImapAccountData *adata);
+struct ImapAccountData *imap_secondary_get(struct ImapAccountData *adata);
+void imap_secondary_put(struct ImapAccountData **ptr);
+void imap_status_flush(struct ImapAccountData *adata);
 int imap_sync_message_for_copy(struct Mailbox *m, struct Email *e, struct Buffer *cmd, enum QuadOption *err_continue);
 bool imap_has_flag(struct ListHead *flag_list, const char *flag);
 int imap_adata_find(const char *path, struct ImapAccountData **adata, struct ImapMboxData **mdata);
@@ -202,8 +230,15 @@ const char *imap_cmd_trailer(struct ImapAccountData *adata);
 int imap_exec(struct ImapAccountData *adata, const char *cmdstr, ImapCmdFlags flags);
 int imap_cmd_idle(struct ImapAccountData *adata);
 
+/* envelope.c */
+bool imap_parse_nstring(char **s, struct Buffer *buf, bool *nil);
+char *imap_skip_item(char *s);
+int imap_parse_envelope(char *s, struct Email *e);
+int imap_parse_bodystructure(char *s, struct Email *e);
+
 /* message.c */
 int imap_read_headers(struct Mailbox *m, unsigned int msn_begin, unsigned int msn_end, bool initial_download);
+int imap_read_headers_deferred(struct Mailbox *m);
 char *imap_set_flags(struct Mailbox *m, struct Email *e, char *s, bool *server_changes);
 int imap_cache_del(struct Mailbox *m, struct Email *e);
 int imap_cache_clean(struct Mailbox *m);
@@ -224,6 +259,9 @@ int imap_hcache_del(struct ImapMboxData *mdata, unsigned int uid);
 int imap_hcache_store_uid_seqset(struct ImapMboxData *mdata);
 int imap_hcache_clear_uid_seqset(struct ImapMboxData *mdata);
 char *imap_hcache_get_uid_seqset(struct ImapMboxData *mdata);
+int imap_hcache_store_uid_flags(struct ImapMboxData *mdata);
+int imap_hcache_clear_uid_flags(struct ImapMboxData *mdata);
+int imap_hcache_get_uid_flags(struct ImapMboxData *mdata, struct UidFlagsArray *ufa, unsigned int *uid_next);
 #endif
 
 enum QuadOption imap_continue(const char *msg, const char *resp);
@@ -32,6 +32,7 @@
 #include <string.h>
 #include "private.h"
 #include "mutt/lib.h"
+#include "config/lib.h"
 #include "email/lib.h"
 #include "core/lib.h"
 #include "lib.h"
@@ -248,6 +249,144 @@ bool imap_search(struct Mailbox *m, const struct PatternList *pat)
   return ok;
 }
 
+/**
+ * sort_key - Get the IMAP SORT key for a sort method
+ * @param sort Sort method, e.g. #SORT_DATE
+ * @retval ptr  SORT key, e.g. "DATE"
+ * @retval NULL The server can't sort by this method
+ */
+static const char *sort_key(short sort)
+{
+  switch (sort & SORT_MASK)
+  {
+    case SORT_DATE:
+      return "DATE";
+    case SORT_FROM:
+      return "FROM";
+    case SORT_RECEIVED:
+      return "ARRIVAL";
+    case SORT_SIZE:
+      return "SIZE";
+    case SORT_SUBJECT:
+      return "SUBJECT";
+    case SORT_TO:
+      return "TO";
+    default:
+      return NULL;
+  }
+}
+
+/**
+ * add_sort_key - Add a sort criterion to a SORT command
+ * @param buf  Buffer for the command
+ * @param sort Sort method, e.g. #SORT_DATE
+ * @param key  SORT key, e.g. "DATE"
+ */
+static void add_sort_key(struct Buffer *buf, short sort, const char *key)
+{
+  if (sort & SORT_REVERSE)
+    buf_addstr(buf, "REVERSE ");
+  buf_addstr(buf, key);
+}
+
+/**
+ * imap_sort - Let the server sort the Mailbox
+ * @param m        Mailbox
+ * @param sort     Primary sort, e.g. #SORT_DATE
+ * @param sort_aux Secondary sort
+ * @retval true  Emails have been sorted
+ * @retval false The server can't sort them, sort them locally
+ *
+ * RFC5256 SORT breaks ties by sequence number, which matches `$sort_aux=order`.
+ *
+ * The Mailbox is also resorted when imap_cmd_finish() applies an EXPUNGE.
+ * No command may be sent then, so the Emails are sorted locally.
+ */
+bool imap_sort(struct Mailbox *m, short sort, short sort_aux)
+{
+  const bool c_imap_server_sort = cs_subset_bool(NeoMutt->sub, "imap_server_sort");
+  if (!c_imap_server_sort || !m || (m->type != MUTT_IMAP))
+    return false;
+
+  struct ImapAccountData *adata = imap_adata_get(m);
+  struct ImapMboxData *mdata = imap_mdata_get(m);
+  if (!adata || !mdata || (adata->mailbox != m) || !(adata->capabilities & IMAP_CAP_SORT))
+    return false;
+
+  if (adata->finishing || (adata->status == IMAP_FATAL))
+    return false;
+
+  const char *key = sort_key(sort);
+  const char *key_aux = sort_key(sort_aux);
+  if (!key || (!key_aux && (sort_aux != SORT_ORDER)))
+    return false;
+
+  struct Buffer *buf = buf_pool_get();
+  buf_addstr(buf, "UID SORT (");
+  add_sort_key(buf, sort, key);
+  if (key_aux && ((sort & SORT_MASK) != (sort_aux & SORT_MASK)))
+  {
+    buf_addch(buf, ' ');
+    add_sort_key(buf, sort_aux, key_aux);
+  }
+  buf_addstr(buf, ") UTF-8 ALL");
+
+  struct Email **sorted = mutt_mem_calloc(m->msg_count, sizeof(struct Email *));
+  bool *seen = mutt_mem_calloc(m->msg_count, sizeof(bool));
+  bool ok = true;
+  int num = 0;
+  int rc;
+
+  /* Don't let the Mailbox change under us, the expunges will wait */
+  const bool reopen = (mdata->reopen & IMAP_REOPEN_ALLOW);
+  imap_disallow_reopen(m);
+
+  imap_cmd_start(adata, buf_string(buf));
+  while ((rc = imap_cmd_step(adata)) == IMAP_RES_CONTINUE)
+  {
+    char *s = adata->buf;
+    if (!ok || !mutt_istr_startswith(s, "* SORT"))
+      continue;
+
+    s = imap_next_word(s);
+    while ((s = imap_next_word(s)) && (*s != '\0'))
+    {
+      unsigned int uid = 0;
+      if (!mutt_str_atoui(s, &uid))
+        continue;
+
+      /* Ignore messages that we haven't downloaded yet */
+      struct Email *e = mutt_hash_int_find(mdata->uid_hash, uid);
+      if (!e)
+        continue;
+
+      if ((e->msgno < 0) || (e->msgno >= m->msg_count) ||
+          (m->emails[e->msgno] != e) || seen[e->msgno] || (num >= m->msg_count))
+      {
+        ok = false;
+        break;
+      }
+      seen[e->msgno] = true;
+      sorted[num++] = e;
+    }
+  }
+
+  if (reopen)
+    imap_allow_reopen(m);
+
+  /* Every Email must be accounted for */
+  ok = ok && (rc == IMAP_RES_OK) && (num == m->msg_count);
+  if (ok)
+    memcpy(m->emails, sorted, num * sizeof(struct Email *));
+  else
+    mutt_debug(LL_DEBUG1, "Server sort failed, sorting locally\n");
+
+  FREE(&seen);
+  FREE(&sorted);
+  buf_pool_release(&buf);
+  return ok;
+}
+
 /**
  * cmd_parse_search - Store SEARCH response for later use
  * @param adata Imap Account data
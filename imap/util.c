@@ -107,6 +107,7 @@ int imap_adata_find(const char *path, struct ImapAccountData **adata,
 void imap_mdata_cache_reset(struct ImapMboxData *mdata)
 {
   mutt_hash_free(&mdata->uid_hash);
+  imap_msn_expunge_free(&mdata->expunge);
   imap_msn_free(&mdata->msn);
   mutt_bcache_close(&mdata->bcache);
 }
@@ -383,9 +384,18 @@ int imap_hcache_put(struct ImapMboxData *mdata, struct Email *e)
     return -1;
 
   char key[16] = { 0 };
+  struct ImapEmailData *edata = imap_edata_get(e);
 
-  snprintf(key, sizeof(key), "%u", imap_edata_get(e)->uid);
-  return hcache_store_email(mdata->hcache, key, mutt_str_len(key), e, mdata->uidvalidity);
+  /* Don't cache the parts of a partial copy, see imap_msg_open() */
+  struct Body *parts = e->body->parts;
+  if (edata->partial)
+    e->body->parts = edata->parts;
+
+  snprintf(key, sizeof(key), "%u", edata->uid);
+  int rc = hcache_store_email(mdata->hcache, key, mutt_str_len(key), e, mdata->uidvalidity);
+
+  e->body->parts = parts;
+  return rc;
 }
 
 /**
@@ -457,6 +467,137 @@ char *imap_hcache_get_uid_seqset(struct ImapMboxData *mdata)
 
   return seqset;
 }
+
+/// Size of one record of the UIDFLAGS blob: UID + packed flags
+#define UIDFLAGS_RECORD (sizeof(uint32_t) + 1)
+
+/**
+ * imap_hcache_store_uid_flags - Store the UIDs and flags of a Mailbox in the header cache
+ * @param mdata Imap Mailbox data
+ * @retval  0 Success
+ * @retval -1 Error
+ *
+ * The blob is the Mailbox's UIDNEXT, followed by the UID and server flags of
+ * each message, in MSN order.  Together with the counts from SELECT, it lets
+ * a later open rebuild the MSN index without fetching every UID.
+ *
+ * If any MSN is unknown, the blob can't be trusted, so it's deleted.
+ */
+int imap_hcache_store_uid_flags(struct ImapMboxData *mdata)
+{
+  if (!mdata->hcache)
+    return -1;
+
+  const size_t max_msn = imap_msn_highest(&mdata->msn);
+  const size_t dlen = sizeof(uint32_t) + (max_msn * UIDFLAGS_RECORD);
+  unsigned char *data = mutt_mem_malloc(dlen);
+  unsigned char *d = data;
+
+  uint32_t num = mdata->uid_next;
+  memcpy(d, &num, sizeof(num));
+  d += sizeof(num);
+
+  for (size_t msn = 0; msn < max_msn; msn++)
+  {
+    struct Email *e = imap_msn_get(&mdata->msn, msn);
+    if (!e)
+    {
+      FREE(&data);
+      return imap_hcache_clear_uid_flags(mdata);
+    }
+
+    struct ImapEmailData *edata = imap_edata_get(e);
+    num = edata->uid;
+    memcpy(d, &num, sizeof(num));
+    d += sizeof(num);
+    *d++ = edata->read + (edata->old << 1) + (edata->deleted << 2) +
+           (edata->flagged << 3) + (edata->replied << 4);
+  }
+
+  int rc = hcache_store_raw(mdata->hcache, "UIDFLAGS", 8, data, dlen);
+  mutt_debug(LL_DEBUG3, "Stored UIDFLAGS for %zu messages\n", max_msn);
+  FREE(&data);
+  return rc;
+}
+
+/**
+ * imap_hcache_clear_uid_flags - Delete the UIDs and flags from the header cache
+ * @param mdata Imap Mailbox data
+ * @retval  0 Success
+ * @retval -1 Error
+ */
+int imap_hcache_clear_uid_flags(struct ImapMboxData *mdata)
+{
+  if (!mdata->hcache)
+    return -1;
+
+  return hcache_delete_raw(mdata->hcache, "UIDFLAGS", 8);
+}
+
+/**
+ * imap_hcache_get_uid_flags - Get the UIDs and flags from the header cache
+ * @param[in]  mdata    Imap Mailbox data
+ * @param[out] ufa      Array for the UIDs and flags, in MSN order
+ * @param[out] uid_next UIDNEXT of the Mailbox when the blob was stored
+ * @retval  0 Success
+ * @retval -1 Error, or no usable data
+ */
+int imap_hcache_get_uid_flags(struct ImapMboxData *mdata,
+                              struct UidFlagsArray *ufa, unsigned int *uid_next)
+{
+  if (!mdata->hcache)
+    return -1;
+
+  size_t dlen = 0;
+  unsigned char *data = hcache_fetch_raw(mdata->hcache, "UIDFLAGS", 8, &dlen);
+  if (!data)
+    return -1;
+
+  int rc = -1;
+  if ((dlen < sizeof(uint32_t)) || (((dlen - sizeof(uint32_t)) % UIDFLAGS_RECORD) != 0))
+    goto done;
+
+  const unsigned char *d = data;
+  uint32_t num = 0;
+  memcpy(&num, d, sizeof(num));
+  d += sizeof(num);
+  *uid_next = num;
+
+  const size_t count = (dlen - sizeof(uint32_t)) / UIDFLAGS_RECORD;
+  ARRAY_RESERVE(ufa, count);
+
+  unsigned int last_uid = 0;
+  for (size_t i = 0; i < count; i++)
+  {
+    memcpy(&num, d, sizeof(num));
+    d += sizeof(num);
+
+    /* UIDs are strictly ascending in MSN order */
+    if ((num <= last_uid) || (num >= *uid_next))
+    {
+      ARRAY_FREE(ufa);
+      goto done;
+    }
+    last_uid = num;
+
+    struct ImapUidFlags uf = { 0 };
+    uf.uid = num;
+    uf.read = (*d & (1 << 0));
+    uf.old = (*d & (1 << 1));
+    uf.deleted = (*d & (1 << 2));
+    uf.flagged = (*d & (1 << 3));
+    uf.replied = (*d & (1 << 4));
+    d++;
+    ARRAY_ADD(ufa, uf);
+  }
+
+  mutt_debug(LL_DEBUG3, "Retrieved UIDFLAGS for %zu messages\n", count);
+  rc = 0;
+
+done:
+  FREE(&data);
+  return rc;
+}
 #endif
 
 /**
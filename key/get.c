@@ -191,6 +191,30 @@ static int mutt_monitor_getch(void)
 }
 #endif /* USE_INOTIFY */
 
+/**
+ * mutt_key_pending - Is there any input waiting?
+ * @retval true A keystroke or an event is waiting to be read
+ *
+ * The input isn't consumed, so the next mutt_getch() will return it.
+ */
+bool mutt_key_pending(void)
+{
+  if (OptNoCurses)
+    return false;
+
+  if (!ARRAY_EMPTY(&UngetKeyEvents) || !ARRAY_EMPTY(&MacroEvents))
+    return true;
+
+  timeout(0);
+  int ch = getch();
+  timeout(1000); // 1 second
+  if (ch == ERR)
+    return false;
+
+  ungetch(ch);
+  return true;
+}
+
 /**
  * mutt_getch - Read a character from the input buffer
  * @param flags Flags, e.g. #GETCH_IGNORE_MACRO
@@ -1395,6 +1395,10 @@ main
       repeat_error = false;
     }
     imap_logout_all();
+    mutt_conn_pool_cleanup();
+#ifdef USE_SSL
+    mutt_ssl_session_cleanup();
+#endif
 #ifdef USE_SASL_CYRUS
     mutt_sasl_cleanup();
 #endif
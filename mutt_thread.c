@@ -47,6 +47,9 @@
 #include "mx.h"
 #include "protos.h"
 #include "sort.h"
+#ifdef USE_NOTMUCH
+#include "notmuch/lib.h"
+#endif
 
 /**
  * UseThreadsMethods - Choices for '$use_threads' for the index
@@ -1162,6 +1165,11 @@ void mutt_sort_threads(struct ThreadsContext *tctx, bool init)
     }
   }
 
+#ifdef USE_NOTMUCH
+  const bool c_nm_thread_structure = (m->type == MUTT_NOTMUCH) &&
+                                     cs_subset_bool(NeoMutt->sub, "nm_thread_structure");
+#endif
+
   /* thread by references */
   for (i = 0; i < m->msg_count; i++)
   {
@@ -1178,6 +1186,24 @@ void mutt_sort_threads(struct ThreadsContext *tctx, bool init)
       continue;
     using_refs = 0;
 
+#ifdef USE_NOTMUCH
+    /* notmuch has already found the message's parent */
+    const char *parent_id = c_nm_thread_structure ? nm_email_get_parent_id(e) : NULL;
+    if (parent_id)
+    {
+      tnew = mutt_hash_find(tctx->hash, parent_id);
+      if (tnew && tnew->duplicate_thread)
+        tnew = tnew->parent;
+      if (tnew && tnew->message && !is_descendant(tnew, thread))
+      {
+        if (thread->parent)
+          unlink_message(&top.child, thread);
+        insert_message(&tnew->child, tnew, thread);
+        continue;
+      }
+    }
+#endif
+
     while (true)
     {
       if (using_refs == 0)
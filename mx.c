@@ -1123,13 +1123,14 @@ enum MxStatus mx_mbox_check(struct Mailbox *m)
 }
 
 /**
- * mx_msg_open - Return a stream pointer for a message
- * @param m Mailbox
- * @param e Email
+ * msg_open - Open a message - Wrapper for MxOps::msg_open()
+ * @param m       Mailbox
+ * @param e       Email
+ * @param partial The message may omit large attachments
  * @retval ptr  Message
  * @retval NULL Error
  */
-struct Message *mx_msg_open(struct Mailbox *m, struct Email *e)
+static struct Message *msg_open(struct Mailbox *m, struct Email *e, bool partial)
 {
   if (!m || !e)
     return NULL;
@@ -1141,12 +1142,41 @@ struct Message *mx_msg_open(struct Mailbox *m, struct Email *e)
   }
 
   struct Message *msg = message_new();
+  msg->partial = partial;
   if (!m->mx_ops->msg_open(m, msg, e))
     message_free(&msg);
 
   return msg;
 }
 
+/**
+ * mx_msg_open - Return a stream pointer for a message
+ * @param m Mailbox
+ * @param e Email
+ * @retval ptr  Message
+ * @retval NULL Error
+ */
+struct Message *mx_msg_open(struct Mailbox *m, struct Email *e)
+{
+  return msg_open(m, e, false);
+}
+
+/**
+ * mx_msg_open_partial - Return a stream pointer for a message, for display
+ * @param m Mailbox
+ * @param e Email
+ * @retval ptr  Message
+ * @retval NULL Error
+ *
+ * The backend may leave out large attachments, e.g. IMAP with
+ * `$imap_partial_fetch_size`.  If it does, Message::partial will be set.
+ * The Message must only be used for display.
+ */
+struct Message *mx_msg_open_partial(struct Mailbox *m, struct Email *e)
+{
+  return msg_open(m, e, true);
+}
+
 /**
  * mx_msg_commit - Commit a message to a folder - Wrapper for MxOps::msg_commit()
  * @param m   Mailbox
@@ -50,6 +50,7 @@ int                  mx_msg_close         (struct Mailbox *m, struct Message **p
 int                  mx_msg_commit        (struct Mailbox *m, struct Message *msg);
 struct Message *     mx_msg_open_new      (struct Mailbox *m, const struct Email *e, MsgOpenFlags flags);
 struct Message *     mx_msg_open          (struct Mailbox *m, struct Email *e);
+struct Message *     mx_msg_open_partial  (struct Mailbox *m, struct Email *e);
 int                  mx_msg_padding_size  (struct Mailbox *m);
 int                  mx_save_hcache       (struct Mailbox *m, struct Email *e);
 int                  mx_path_canon        (struct Buffer *path, const char *folder, enum MailboxType *type);
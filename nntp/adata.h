@@ -43,10 +43,12 @@ struct NntpAccountData
   bool hasLISTGROUPrange  : 1; ///< Server supports LISTGROUPrange command
   bool hasOVER            : 1; ///< Server supports OVER command
   bool hasXOVER           : 1; ///< Server supports XOVER command
+  bool hasCOMPRESS        : 1; ///< Server supports COMPRESS DEFLATE command
   unsigned int use_tls    : 3;
   unsigned int status     : 3;
   bool cacheable          : 1;
   bool newsrc_modified    : 1;
+  bool newsrc_dirty       : 1; ///< .newsrc entries have changed and need writing
   FILE *fp_newsrc;
   char *newsrc_file;
   char *authenticators;
@@ -113,10 +113,30 @@ static struct ConfigDef NntpVars[] = {
   // clang-format on
 };
 
+#if defined(USE_ZLIB)
+/**
+ * NntpVarsZlib - Config definitions for NNTP compression
+ */
+static struct ConfigDef NntpVarsZlib[] = {
+  // clang-format off
+  { "nntp_deflate", DT_BOOL, true, 0, NULL,
+    "(nntp) Compress network traffic"
+  },
+  { NULL },
+  // clang-format on
+};
+#endif
+
 /**
  * config_init_nntp - Register nntp config variables - Implements ::module_init_config_t - @ingroup cfg_module_api
  */
 bool config_init_nntp(struct ConfigSet *cs)
 {
-  return cs_register_variables(cs, NntpVars);
+  bool rc = cs_register_variables(cs, NntpVars);
+
+#if defined(USE_ZLIB)
+  rc |= cs_register_variables(cs, NntpVarsZlib);
+#endif
+
+  return rc;
 }
@@ -33,10 +33,13 @@
 #include "config.h"
 #include <dirent.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <limits.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include "private.h"
@@ -65,6 +68,35 @@ struct BodyCache;
 
 const struct ExpandoRenderData NntpRenderData[];
 
+/// Identifies a binary list of newsgroups, see nntp_active_save_cache()
+#define ACTIVE_CACHE_MAGIC "NMACTIVE"
+/// Change this if the layout of the binary list of newsgroups changes
+#define ACTIVE_CACHE_VERSION 1
+
+/**
+ * struct ActiveCacheHeader - Start of the binary list of newsgroups
+ */
+struct ActiveCacheHeader
+{
+  char magic[8];          ///< #ACTIVE_CACHE_MAGIC
+  uint32_t version;       ///< #ACTIVE_CACHE_VERSION
+  uint32_t count;         ///< Number of ActiveCacheRecord
+  int64_t newgroups_time; ///< Time of the last check for new newsgroups
+};
+
+/**
+ * struct ActiveCacheRecord - A newsgroup in the binary list of newsgroups
+ */
+struct ActiveCacheRecord
+{
+  int64_t first;    ///< First article number
+  int64_t last;     ///< Last article number
+  uint32_t name;    ///< Offset of the name in the string table
+  uint32_t desc;    ///< Offset of the description in the string table, 0 if none
+  uint32_t allowed; ///< Posting is allowed
+  uint32_t unused;  ///< Padding, always 0
+};
+
 /**
  * mdata_find - Find NntpMboxData for given newsgroup or add it
  * @param adata NNTP server
@@ -98,6 +130,64 @@ static struct NntpMboxData *mdata_find(struct NntpAccountData *adata, const char
   return mdata;
 }
 
+/**
+ * groups_reserve - Make room for a number of newsgroups
+ * @param adata NNTP server
+ * @param num   Number of newsgroups expected
+ *
+ * The Hash Table has a fixed number of buckets, so it's rebuilt if it's too
+ * small for this many newsgroups.
+ */
+static void groups_reserve(struct NntpAccountData *adata, unsigned int num)
+{
+  if (num > adata->groups_max)
+  {
+    adata->groups_max = num;
+    mutt_mem_realloc(&adata->groups_list, adata->groups_max * sizeof(struct NntpMboxData *));
+  }
+
+  if (num <= adata->groups_hash->num_elems)
+    return;
+
+  struct HashTable *hash = mutt_hash_new(num, MUTT_HASH_NO_FLAGS);
+  mutt_hash_set_destructor(hash, nntp_hashelem_free, 0);
+  for (unsigned int i = 0; i < adata->groups_num; i++)
+  {
+    struct NntpMboxData *mdata = adata->groups_list[i];
+    if (mdata)
+      mutt_hash_insert(hash, mdata->group, mdata);
+  }
+
+  /* the newsgroups now belong to the new table */
+  mutt_hash_set_destructor(adata->groups_hash, NULL, 0);
+  mutt_hash_free(&adata->groups_hash);
+  adata->groups_hash = hash;
+}
+
+/**
+ * group_set_active - Set a newsgroup's details from the server's list
+ * @param mdata   NNTP Mailbox data
+ * @param first   First article number
+ * @param last    Last article number
+ * @param allowed Posting is allowed
+ * @param desc    Description (OPTIONAL)
+ */
+static void group_set_active(struct NntpMboxData *mdata, anum_t first,
+                             anum_t last, bool allowed, const char *desc)
+{
+  mdata->deleted = false;
+  mdata->first_message = first;
+  mdata->last_message = last;
+  mdata->allowed = allowed;
+  mutt_str_replace(&mdata->desc, desc);
+  if (mdata->newsrc_ent || (mdata->last_cached != 0))
+    nntp_group_unread_stat(mdata);
+  else if (mdata->last_message && (mdata->first_message <= mdata->last_message))
+    mdata->unread = mdata->last_message - mdata->first_message + 1;
+  else
+    mdata->unread = 0;
+}
+
 /**
  * nntp_acache_free - Remove all temporarily cache files
  * @param mdata NNTP Mailbox data
@@ -211,6 +301,7 @@ int nntp_newsrc_parse(struct NntpAccountData *adata)
   adata->size = st.st_size;
   adata->mtime = st.st_mtime;
   adata->newsrc_modified = true;
+  adata->newsrc_dirty = false;
   mutt_debug(LL_DEBUG1, "Parsing %s\n", adata->newsrc_file);
 
   /* .newsrc has been externally modified or hasn't been loaded yet */
@@ -309,6 +400,15 @@ void nntp_newsrc_gen_entries(struct Mailbox *m)
   bool series;
   unsigned int entries;
 
+  /* keep the old entries, to see if anything changes */
+  const unsigned int old_len = mdata->newsrc_len;
+  struct NewsrcEntry *old_ent = NULL;
+  if (old_len)
+  {
+    old_ent = mutt_mem_malloc(old_len * sizeof(struct NewsrcEntry));
+    memcpy(old_ent, mdata->newsrc_ent, old_len * sizeof(struct NewsrcEntry));
+  }
+
   const enum SortType c_sort = cs_subset_sort(NeoMutt->sub, "sort");
   if (c_sort != SORT_ORDER)
   {
@@ -377,6 +477,14 @@ void nntp_newsrc_gen_entries(struct Mailbox *m)
   }
   mutt_mem_realloc(&mdata->newsrc_ent, mdata->newsrc_len * sizeof(struct NewsrcEntry));
 
+  if ((mdata->newsrc_len != old_len) ||
+      ((old_len != 0) &&
+       (memcmp(old_ent, mdata->newsrc_ent, old_len * sizeof(struct NewsrcEntry)) != 0)))
+  {
+    mdata->adata->newsrc_dirty = true;
+  }
+  FREE(&old_ent);
+
   if (c_sort != SORT_ORDER)
   {
     cs_subset_str_native_set(NeoMutt->sub, "sort", c_sort, NULL);
@@ -440,12 +548,20 @@ static int update_file(char *filename, char *buf)
  * @param adata NNTP server
  * @retval  0 Success
  * @retval -1 Failure
+ *
+ * The file is only rewritten if some newsgroup's entries have changed.
  */
 int nntp_newsrc_update(struct NntpAccountData *adata)
 {
   if (!adata)
     return -1;
 
+  if (!adata->newsrc_dirty)
+  {
+    mutt_debug(LL_DEBUG2, "%s is up to date\n", adata->newsrc_file);
+    return 0;
+  }
+
   int rc = -1;
 
   size_t buflen = 10240;
@@ -505,6 +621,7 @@ int nntp_newsrc_update(struct NntpAccountData *adata)
     {
       adata->size = st.st_size;
       adata->mtime = st.st_mtime;
+      adata->newsrc_dirty = false;
     }
     else
     {
@@ -601,69 +718,165 @@ int nntp_add_group(char *line, void *data)
   }
 
   mdata = mdata_find(adata, group);
-  mdata->deleted = false;
-  mdata->first_message = first;
-  mdata->last_message = last;
-  mdata->allowed = (mod == 'y') || (mod == 'm');
-  mutt_str_replace(&mdata->desc, desc);
-  if (mdata->newsrc_ent || (mdata->last_cached != 0))
-    nntp_group_unread_stat(mdata);
-  else if (mdata->last_message && (mdata->first_message <= mdata->last_message))
-    mdata->unread = mdata->last_message - mdata->first_message + 1;
-  else
-    mdata->unread = 0;
+  group_set_active(mdata, first, last, (mod == 'y') || (mod == 'm'), desc);
   return 0;
 }
 
 /**
- * active_get_cache - Load list of all newsgroups from cache
+ * active_parse_binary - Load the binary list of newsgroups
  * @param adata NNTP server
+ * @param fd    File descriptor of the cache
  * @retval  0 Success
  * @retval -1 Failure
+ *
+ * The file is mapped into memory, checked, then each record is turned into an
+ * NntpMboxData, without any parsing.
  */
-static int active_get_cache(struct NntpAccountData *adata)
+static int active_parse_binary(struct NntpAccountData *adata, int fd)
+{
+  struct stat st = { 0 };
+  if ((fstat(fd, &st) != 0) || (st.st_size <= (off_t) sizeof(struct ActiveCacheHeader)))
+    return -1;
+
+  const size_t size = st.st_size;
+  const char *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (map == MAP_FAILED)
+    return -1;
+
+  int rc = -1;
+  const struct ActiveCacheHeader *hdr = (const struct ActiveCacheHeader *) map;
+  const struct ActiveCacheRecord *recs = (const struct ActiveCacheRecord *) (hdr + 1);
+
+  /* there must be room for the records and at least one string */
+  if ((hdr->version != ACTIVE_CACHE_VERSION) || (hdr->newgroups_time == 0) ||
+      (hdr->count > ((size - sizeof(*hdr) - 1) / sizeof(*recs))))
+  {
+    goto done;
+  }
+
+  /* the string table must start with "" and end with a NUL */
+  const char *strings = (const char *) (recs + hdr->count);
+  const size_t strings_len = map + size - strings;
+  if ((*strings != '\0') || (map[size - 1] != '\0'))
+    goto done;
+
+  for (uint32_t i = 0; i < hdr->count; i++)
+  {
+    if ((recs[i].name >= strings_len) || (recs[i].desc >= strings_len) ||
+        (strings[recs[i].name] == '\0'))
+    {
+      goto done;
+    }
+  }
+
+  mutt_message(_("Loading list of groups from cache..."));
+  groups_reserve(adata, adata->groups_num + hdr->count);
+  adata->newgroups_time = hdr->newgroups_time;
+  for (uint32_t i = 0; i < hdr->count; i++)
+  {
+    const struct ActiveCacheRecord *rec = &recs[i];
+    struct NntpMboxData *mdata = mdata_find(adata, strings + rec->name);
+    group_set_active(mdata, rec->first, rec->last, rec->allowed,
+                     (rec->desc != 0) ? strings + rec->desc : NULL);
+  }
+  mutt_clear_error();
+  rc = 0;
+
+done:
+  munmap((void *) map, size);
+  return rc;
+}
+
+/**
+ * active_parse_text - Load the text list of newsgroups
+ * @param adata NNTP server
+ * @param fp    File handle of the cache
+ * @retval  0 Success
+ * @retval -1 Failure
+ *
+ * Older versions of NeoMutt saved the newsgroups as text, one per line.
+ */
+static int active_parse_text(struct NntpAccountData *adata, FILE *fp)
 {
   char buf[8192] = { 0 };
   char file[4096] = { 0 };
   time_t t = 0;
 
-  cache_expand(file, sizeof(file), &adata->conn->account, ".active");
-  mutt_debug(LL_DEBUG1, "Parsing %s\n", file);
-  FILE *fp = mutt_file_fopen(file, "r");
-  if (!fp)
-    return -1;
-
   if (!fgets(buf, sizeof(buf), fp) || (sscanf(buf, "%jd%4095s", &t, file) != 1) || (t == 0))
-  {
-    mutt_file_fclose(&fp);
     return -1;
-  }
   adata->newgroups_time = t;
 
   mutt_message(_("Loading list of groups from cache..."));
   while (fgets(buf, sizeof(buf), fp))
     nntp_add_group(buf, adata);
   nntp_add_group(NULL, NULL);
-  mutt_file_fclose(&fp);
   mutt_clear_error();
   return 0;
 }
 
+/**
+ * active_get_cache - Load list of all newsgroups from cache
+ * @param adata NNTP server
+ * @retval  0 Success
+ * @retval -1 Failure
+ */
+static int active_get_cache(struct NntpAccountData *adata)
+{
+  char file[4096] = { 0 };
+  char magic[sizeof(ACTIVE_CACHE_MAGIC) - 1] = { 0 };
+
+  cache_expand(file, sizeof(file), &adata->conn->account, ".active");
+  mutt_debug(LL_DEBUG1, "Parsing %s\n", file);
+  FILE *fp = mutt_file_fopen(file, "r");
+  if (!fp)
+    return -1;
+
+  int rc;
+  if ((fread(magic, sizeof(magic), 1, fp) == 1) &&
+      (memcmp(magic, ACTIVE_CACHE_MAGIC, sizeof(magic)) == 0))
+  {
+    rc = active_parse_binary(adata, fileno(fp));
+  }
+  else
+  {
+    rewind(fp);
+    rc = active_parse_text(adata, fp);
+    /* convert it, so it's quicker to load next time */
+    if (rc == 0)
+      nntp_active_save_cache(adata);
+  }
+
+  mutt_file_fclose(&fp);
+  return rc;
+}
+
 /**
  * nntp_active_save_cache - Save list of all newsgroups to cache
  * @param adata NNTP server
  * @retval  0 Success
  * @retval -1 Failure
+ *
+ * The list is saved in a binary form, so that it can be loaded without any
+ * parsing:
+ * - ActiveCacheHeader
+ * - An ActiveCacheRecord for each newsgroup
+ * - A table of NUL-terminated strings, starting with ""
  */
 int nntp_active_save_cache(struct NntpAccountData *adata)
 {
   if (!adata->cacheable)
     return 0;
 
-  size_t buflen = 10240;
-  char *buf = mutt_mem_calloc(1, buflen);
-  snprintf(buf, buflen, "%lu\n", (unsigned long) adata->newgroups_time);
-  size_t off = strlen(buf);
+  struct ActiveCacheHeader hdr = { 0 };
+  memcpy(hdr.magic, ACTIVE_CACHE_MAGIC, sizeof(hdr.magic));
+  hdr.version = ACTIVE_CACHE_VERSION;
+  hdr.newgroups_time = adata->newgroups_time;
+
+  ARRAY_HEAD(ActiveCacheRecordArray, struct ActiveCacheRecord) recs = ARRAY_HEAD_INITIALIZER;
+  ARRAY_RESERVE(&recs, adata->groups_num);
+
+  struct Buffer *strings = buf_pool_get();
+  buf_addch(strings, '\0');
 
   for (unsigned int i = 0; i < adata->groups_num; i++)
   {
@@ -672,23 +885,47 @@ int nntp_active_save_cache(struct NntpAccountData *adata)
     if (!mdata || mdata->deleted)
       continue;
 
-    if ((off + strlen(mdata->group) + (mdata->desc ? strlen(mdata->desc) : 0) + 50) > buflen)
+    struct ActiveCacheRecord rec = { 0 };
+    rec.first = mdata->first_message;
+    rec.last = mdata->last_message;
+    rec.allowed = mdata->allowed;
+    rec.name = buf_len(strings);
+    buf_addstr(strings, mdata->group);
+    buf_addch(strings, '\0');
+    if (mdata->desc && (*mdata->desc != '\0'))
     {
-      buflen *= 2;
-      mutt_mem_realloc(&buf, buflen);
+      rec.desc = buf_len(strings);
+      buf_addstr(strings, mdata->desc);
+      buf_addch(strings, '\0');
     }
-    snprintf(buf + off, buflen - off, "%s " ANUM_FMT " " ANUM_FMT " %c%s%s\n",
-             mdata->group, mdata->last_message, mdata->first_message,
-             mdata->allowed ? 'y' : 'n', mdata->desc ? " " : "",
-             mdata->desc ? mdata->desc : "");
-    off += strlen(buf + off);
+    ARRAY_ADD(&recs, rec);
   }
+  hdr.count = ARRAY_SIZE(&recs);
 
   char file[PATH_MAX] = { 0 };
+  char tmpfile[PATH_MAX] = { 0 };
+  int rc = -1;
+
   cache_expand(file, sizeof(file), &adata->conn->account, ".active");
   mutt_debug(LL_DEBUG1, "Updating %s\n", file);
-  int rc = update_file(file, buf);
-  FREE(&buf);
+  snprintf(tmpfile, sizeof(tmpfile), "%s.tmp", file);
+  FILE *fp = mutt_file_fopen(tmpfile, "w");
+  if (fp && (fwrite(&hdr, sizeof(hdr), 1, fp) == 1) &&
+      (fwrite(recs.entries, sizeof(struct ActiveCacheRecord), hdr.count, fp) == hdr.count) &&
+      (fwrite(strings->data, buf_len(strings), 1, fp) == 1) &&
+      (mutt_file_fclose(&fp) == 0) && (rename(tmpfile, file) == 0))
+  {
+    rc = 0;
+  }
+  else
+  {
+    mutt_perror("%s", file);
+    mutt_file_fclose(&fp);
+    unlink(tmpfile);
+  }
+
+  ARRAY_FREE(&recs);
+  buf_pool_release(&strings);
   return rc;
 }
 
@@ -1303,6 +1540,7 @@ struct NntpMboxData *mutt_newsgroup_subscribe(struct NntpAccountData *adata, cha
 
   struct NntpMboxData *mdata = mdata_find(adata, group);
   mdata->subscribed = true;
+  adata->newsrc_dirty = true;
   if (!mdata->newsrc_ent)
   {
     mdata->newsrc_ent = mutt_mem_calloc(1, sizeof(struct NewsrcEntry));
@@ -1330,6 +1568,7 @@ struct NntpMboxData *mutt_newsgroup_unsubscribe(struct NntpAccountData *adata, c
     return NULL;
 
   mdata->subscribed = false;
+  adata->newsrc_dirty = true;
   const bool c_save_unsubscribed = cs_subset_bool(NeoMutt->sub, "save_unsubscribed");
   if (!c_save_unsubscribed)
   {
@@ -1363,6 +1602,7 @@ struct NntpMboxData *mutt_newsgroup_catchup(struct Mailbox *m,
     mdata->newsrc_len = 1;
     mdata->newsrc_ent[0].first = 1;
     mdata->newsrc_ent[0].last = mdata->last_message;
+    adata->newsrc_dirty = true;
   }
   mdata->unread = 0;
   if (m && (m->mdata == mdata))
@@ -1402,6 +1642,7 @@ struct NntpMboxData *mutt_newsgroup_uncatchup(struct Mailbox *m,
     mdata->newsrc_len = 1;
     mdata->newsrc_ent[0].first = 1;
     mdata->newsrc_ent[0].last = mdata->first_message - 1;
+    adata->newsrc_dirty = true;
   }
   if (m && (m->mdata == mdata))
   {
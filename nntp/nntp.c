@@ -86,6 +86,16 @@ static const char *OverviewFmt = "Subject:\0"
                                  "Lines:\0"
                                  "\0";
 
+/**
+ * struct OverRange - A range of articles for an OVER command
+ */
+struct OverRange
+{
+  anum_t first; ///< First article
+  anum_t last;  ///< Last article
+};
+ARRAY_HEAD(OverRangeArray, struct OverRange);
+
 /**
  * struct FetchCtx - Keep track when getting data from a server
  */
@@ -98,6 +108,9 @@ struct FetchCtx
   unsigned char *messages;
   struct Progress *progress;
   struct HeaderCache *hc;
+  ARRAY_HEAD(AnumArray, anum_t) missing; ///< Articles to fetch from the server
+  struct OverRangeArray ranges;          ///< Windows of missing articles for OVER
+  FILE *fp;                              ///< Temporary file for HEAD
 };
 
 /**
@@ -152,6 +165,7 @@ static int nntp_capabilities(struct NntpAccountData *adata)
   adata->hasLISTGROUP = false;
   adata->hasLISTGROUPrange = false;
   adata->hasOVER = false;
+  adata->hasCOMPRESS = false;
   FREE(&adata->authenticators);
 
   if ((mutt_socket_send(conn, "CAPABILITIES\r\n") < 0) ||
@@ -203,6 +217,13 @@ static int nntp_capabilities(struct NntpAccountData *adata)
     {
       adata->hasOVER = true;
     }
+    else if ((plen = mutt_str_startswith(buf, "COMPRESS ")))
+    {
+      /* RFC8054: list of algorithms, e.g. "COMPRESS DEFLATE SHRINK" */
+      mutt_str_cat(buf, sizeof(buf), " ");
+      if (strstr(buf + plen - 1, " DEFLATE "))
+        adata->hasCOMPRESS = true;
+    }
     else if (mutt_str_startswith(buf, "LIST "))
     {
       char *p = strstr(buf, " NEWSGROUPS");
@@ -763,6 +784,69 @@ static int nntp_query(struct NntpMboxData *mdata, char *line, size_t linelen)
   return 0;
 }
 
+/**
+ * nntp_read_lines - Read the lines of a multi-line response
+ * @param adata    NNTP Account data
+ * @param progress Progress bar (OPTIONAL)
+ * @param func     Callback function
+ * @param data     Data for callback function
+ * @retval  0 Success
+ * @retval -1 Connection lost
+ * @retval -2 Error in func(*line, *data)
+ *
+ * The lines are read up to the terminating ".", even if func() fails.
+ */
+static int nntp_read_lines(struct NntpAccountData *adata, struct Progress *progress,
+                           int (*func)(char *, void *), void *data)
+{
+  char buf[1024] = { 0 };
+  unsigned int lines = 0;
+  size_t off = 0;
+  int rc = 0;
+
+  char *line = mutt_mem_malloc(sizeof(buf));
+
+  while (true)
+  {
+    char *p = NULL;
+    int chunk = mutt_socket_readln_d(buf, sizeof(buf), adata->conn, MUTT_SOCK_LOG_FULL);
+    if (chunk < 0)
+    {
+      adata->status = NNTP_NONE;
+      rc = -1;
+      break;
+    }
+
+    p = buf;
+    if (!off && (buf[0] == '.'))
+    {
+      if (buf[1] == '\0')
+        break;
+      if (buf[1] == '.')
+        p++;
+    }
+
+    mutt_str_copy(line + off, p, sizeof(buf));
+
+    if (chunk >= sizeof(buf))
+    {
+      off += strlen(p);
+    }
+    else
+    {
+      progress_update(progress, ++lines, -1);
+
+      if ((rc == 0) && (func(line, data) < 0))
+        rc = -2;
+      off = 0;
+    }
+
+    mutt_mem_realloc(&line, off + sizeof(buf));
+  }
+  FREE(&line);
+  return rc;
+}
+
 /**
  * nntp_fetch_lines - Read lines, calling a callback function for each
  * @param mdata NNTP Mailbox data
@@ -782,15 +866,12 @@ static int nntp_query(struct NntpMboxData *mdata, char *line, size_t linelen)
 static int nntp_fetch_lines(struct NntpMboxData *mdata, char *query, size_t qlen,
                             const char *msg, int (*func)(char *, void *), void *data)
 {
-  bool done = false;
-  int rc;
+  int rc = -1;
 
-  while (!done)
+  /* retry if the connection is lost while reading */
+  while (rc == -1)
   {
     char buf[1024] = { 0 };
-    char *line = NULL;
-    unsigned int lines = 0;
-    size_t off = 0;
     struct Progress *progress = NULL;
 
     mutt_str_copy(buf, query, sizeof(buf));
@@ -802,59 +883,104 @@ static int nntp_fetch_lines(struct NntpMboxData *mdata, char *query, size_t qlen
       return 1;
     }
 
-    line = mutt_mem_malloc(sizeof(buf));
-    rc = 0;
-
     if (msg)
     {
       progress = progress_new(MUTT_PROGRESS_READ, 0);
       progress_set_message(progress, "%s", msg);
     }
 
-    while (true)
-    {
-      char *p = NULL;
-      int chunk = mutt_socket_readln_d(buf, sizeof(buf), mdata->adata->conn, MUTT_SOCK_LOG_FULL);
-      if (chunk < 0)
-      {
-        mdata->adata->status = NNTP_NONE;
-        break;
-      }
+    rc = nntp_read_lines(mdata->adata, progress, func, data);
+    func(NULL, data);
+    progress_free(&progress);
+  }
 
-      p = buf;
-      if (!off && (buf[0] == '.'))
-      {
-        if (buf[1] == '\0')
-        {
-          done = true;
-          break;
-        }
-        if (buf[1] == '.')
-          p++;
-      }
+  return rc;
+}
 
-      mutt_str_copy(line + off, p, sizeof(buf));
+/**
+ * nntp_pipeline - Send a series of commands, without waiting for each response
+ * @param mdata   NNTP Mailbox data
+ * @param count   Number of commands
+ * @param cmd_cb  Function to create command number `num`, including "\r\n"
+ * @param func    Function called for each line of a multi-line response
+ * @param done_cb Function called with the status line of each response
+ * @param data    Data for the callback functions
+ * @retval  0 Success
+ * @retval -1 Connection lost
+ * @retval -2 Stopped by done_cb()
+ *
+ * RFC3977 lets a client send several commands before reading the responses.
+ * Up to #NNTP_PIPELINE_DEPTH commands are kept in flight.
+ *
+ * The responses are handled in order.  For a "2xx" response, func() is called
+ * for each line, then done_cb().  If done_cb() returns < 0, no more commands
+ * are sent, but the responses to those in flight are read.
+ *
+ * If the connection is lost, reconnect and resend the commands whose
+ * responses are missing, after calling func(NULL, data) to discard any
+ * partial response.
+ */
+static int nntp_pipeline(struct NntpMboxData *mdata, int count,
+                         void (*cmd_cb)(int, struct Buffer *, void *),
+                         int (*func)(char *, void *),
+                         int (*done_cb)(int, const char *, void *), void *data)
+{
+  struct NntpAccountData *adata = mdata->adata;
+  struct Buffer *cmd = buf_pool_get();
+  char buf[1024] = { 0 };
+  int sent = 0;
+  int received = 0;
+  int rc = 0;
 
-      if (chunk >= sizeof(buf))
+  while (received < ((rc == 0) ? count : sent))
+  {
+    /* reconnect, select the group, then resend what's outstanding */
+    if (adata->status != NNTP_OK)
+    {
+      buf[0] = '\0';
+      if (nntp_query(mdata, buf, sizeof(buf)) < 0)
       {
-        off += strlen(p);
+        rc = -1;
+        break;
       }
-      else
-      {
-        progress_update(progress, ++lines, -1);
+      sent = received;
+    }
 
-        if ((rc == 0) && (func(line, data) < 0))
-          rc = -2;
-        off = 0;
+    bool lost = false;
+    while ((rc == 0) && (sent < count) && ((sent - received) < NNTP_PIPELINE_DEPTH))
+    {
+      buf_reset(cmd);
+      cmd_cb(sent, cmd, data);
+      if (mutt_socket_send(adata->conn, buf_string(cmd)) < 0)
+      {
+        lost = true;
+        break;
       }
+      sent++;
+    }
 
-      mutt_mem_realloc(&line, off + sizeof(buf));
+    int rc_resp = 0;
+    if (!lost && (mutt_socket_readln(buf, sizeof(buf), adata->conn) < 0))
+      lost = true;
+    if (!lost && (buf[0] == '2'))
+    {
+      rc_resp = nntp_read_lines(adata, NULL, func, data);
+      if (rc_resp == -1)
+        lost = true;
     }
-    FREE(&line);
-    func(NULL, data);
-    progress_free(&progress);
+    if (lost)
+    {
+      adata->status = NNTP_NONE;
+      func(NULL, data);
+      continue;
+    }
+
+    if ((rc == 0) && ((rc_resp < 0) || (done_cb(received, buf, data) < 0)))
+      rc = -2;
+    received++;
   }
 
+  buf_pool_release(&cmd);
   return rc;
 }
 
@@ -1006,6 +1132,48 @@ static int fetch_numbers(char *line, void *data)
   return 0;
 }
 
+/**
+ * fetch_add_email - Add a fetched Email to the Mailbox
+ * @param fc   FetchCtx
+ * @param e    Email
+ * @param anum Article number
+ */
+static void fetch_add_email(struct FetchCtx *fc, struct Email *e, anum_t anum)
+{
+  struct Mailbox *m = fc->mailbox;
+  struct NntpMboxData *mdata = m->mdata;
+
+  e->index = m->msg_count++;
+  e->read = false;
+  e->old = false;
+  e->deleted = false;
+  e->edata = nntp_edata_new();
+  e->edata_free = nntp_edata_free;
+  nntp_edata_get(e)->article_num = anum;
+  if (fc->restore)
+  {
+    e->changed = true;
+  }
+  else
+  {
+    nntp_article_status(m, e, NULL, anum);
+    if (!e->read)
+      nntp_parse_xref(m, e);
+  }
+  if (anum > mdata->last_loaded)
+    mdata->last_loaded = anum;
+}
+
+/**
+ * fetch_sort_anum - Compare two Emails by article number - Implements ::sort_t - @ingroup sort_api
+ */
+static int fetch_sort_anum(const void *a, const void *b, void *sdata)
+{
+  const struct Email *ea = *(struct Email const *const *) a;
+  const struct Email *eb = *(struct Email const *const *) b;
+  return nntp_compare_order(ea, eb, false);
+}
+
 /**
  * parse_overview_line - Parse overview line
  * @param line String to parse
@@ -1128,35 +1296,137 @@ static int parse_overview_line(char *line, void *data)
   }
 #endif
 
+  /* don't add it twice if the OVER is resent after a reconnect */
+  fc->messages[anum - fc->first] = 0;
+
   if (save)
+    fetch_add_email(fc, e, anum);
+  else
+    email_free(&e);
+
+  progress_update(fc->progress, anum - fc->first + 1, -1);
+  return 0;
+}
+
+/**
+ * over_cmd - Create an OVER command for a window of articles
+ * @param num  Number of the command
+ * @param cmd  Buffer for the command
+ * @param data FetchCtx
+ *
+ * Each window starts at a missing article and ends at the last missing
+ * article less than #NNTP_OVER_WINDOW after it.
+ */
+static void over_cmd(int num, struct Buffer *cmd, void *data)
+{
+  struct FetchCtx *fc = data;
+  struct NntpMboxData *mdata = fc->mailbox->mdata;
+  struct OverRange *range = ARRAY_GET(&fc->ranges, num);
+
+  buf_printf(cmd, "%s " ANUM_FMT "-" ANUM_FMT "\r\n",
+             mdata->adata->hasOVER ? "OVER" : "XOVER", range->first, range->last);
+}
+
+/**
+ * over_done - Check the response to an OVER command
+ * @param num    Number of the command
+ * @param status Status line of the response
+ * @param data   FetchCtx
+ * @retval  0 Success
+ * @retval -1 Failure
+ */
+static int over_done(int num, const char *status, void *data)
+{
+  struct FetchCtx *fc = data;
+  struct NntpMboxData *mdata = fc->mailbox->mdata;
+
+  /* 423: no articles in the range */
+  if ((status[0] == '2') || mutt_str_startswith(status, "423"))
+    return 0;
+
+  mutt_error("%s: %s", mdata->adata->hasOVER ? "OVER" : "XOVER", status);
+  return -1;
+}
+
+/**
+ * head_cmd - Create a HEAD command for a missing article
+ * @param num  Number of the command
+ * @param cmd  Buffer for the command
+ * @param data FetchCtx
+ */
+static void head_cmd(int num, struct Buffer *cmd, void *data)
+{
+  struct FetchCtx *fc = data;
+  buf_printf(cmd, "HEAD " ANUM_FMT "\r\n", *ARRAY_GET(&fc->missing, num));
+}
+
+/**
+ * head_line - Save a header line to a temporary file
+ * @param line Header line, or NULL to empty the file
+ * @param data FetchCtx
+ * @retval  0 Success
+ * @retval -1 Failure
+ */
+static int head_line(char *line, void *data)
+{
+  struct FetchCtx *fc = data;
+
+  if (!line)
+  {
+    rewind(fc->fp);
+    return ftruncate(fileno(fc->fp), 0);
+  }
+
+  return fetch_tempfile(line, fc->fp);
+}
+
+/**
+ * head_done - Parse the header of a missing article
+ * @param num    Number of the command
+ * @param status Status line of the response
+ * @param data   FetchCtx
+ * @retval  0 Success
+ * @retval -1 Failure
+ */
+static int head_done(int num, const char *status, void *data)
+{
+  struct FetchCtx *fc = data;
+  struct Mailbox *m = fc->mailbox;
+  struct NntpMboxData *mdata = m->mdata;
+  const anum_t anum = *ARRAY_GET(&fc->missing, num);
+
+  progress_update(fc->progress, num + 1, -1);
+
+  if (status[0] != '2')
   {
-    e->index = m->msg_count++;
-    e->read = false;
-    e->old = false;
-    e->deleted = false;
-    e->edata = nntp_edata_new();
-    e->edata_free = nntp_edata_free;
-    nntp_edata_get(e)->article_num = anum;
-    if (fc->restore)
+    /* invalid response */
+    if (!mutt_str_startswith(status, "423"))
     {
-      e->changed = true;
+      mutt_error("HEAD: %s", status);
+      return -1;
     }
-    else
+
+    /* no such article */
+    if (mdata->bcache)
     {
-      nntp_article_status(m, e, NULL, anum);
-      if (!e->read)
-        nntp_parse_xref(m, e);
+      char buf[16] = { 0 };
+      snprintf(buf, sizeof(buf), ANUM_FMT, anum);
+      mutt_debug(LL_DEBUG2, "#3 mutt_bcache_del %s\n", buf);
+      mutt_bcache_del(mdata->bcache, buf);
     }
-    if (anum > mdata->last_loaded)
-      mdata->last_loaded = anum;
-  }
-  else
-  {
-    email_free(&e);
+    return 0;
   }
 
-  progress_update(fc->progress, anum - fc->first + 1, -1);
-  return 0;
+  /* parse header */
+  rewind(fc->fp);
+  mx_alloc_memory(m, m->msg_count);
+  struct Email *e = email_new();
+  m->emails[m->msg_count] = e;
+  e->env = mutt_rfc822_read_header(fc->fp, e, false, false);
+  e->received = e->date_sent;
+  fetch_add_email(fc, e, anum);
+
+  return head_line(NULL, fc);
 }
 
 /**
@@ -1176,11 +1446,10 @@ static int nntp_fetch_headers(struct Mailbox *m, void *hc, anum_t first, anum_t
 
   struct NntpMboxData *mdata = m->mdata;
   struct FetchCtx fc = { 0 };
-  struct Email *e = NULL;
   char buf[8192] = { 0 };
   int rc = 0;
   anum_t current;
-  anum_t first_over = first;
+  const int old_count = m->msg_count;
 
   /* if empty group or nothing to do */
   if (!last || (first > last))
@@ -1246,7 +1515,7 @@ static int nntp_fetch_headers(struct Mailbox *m, void *hc, anum_t first, anum_t
       fc.messages[current - first] = 1;
   }
 
-  /* fetching header from cache or server, or fallback to fetch overview */
+  /* fetching header from cache, making a list of the rest */
   if (m->verbose)
   {
     fc.progress = progress_new(MUTT_PROGRESS_READ, last - first + 1);
@@ -1256,25 +1525,19 @@ static int nntp_fetch_headers(struct Mailbox *m, void *hc, anum_t first, anum_t
   {
     progress_update(fc.progress, current - first + 1, -1);
 
-#ifdef USE_HCACHE
-    snprintf(buf, sizeof(buf), ANUM_FMT, current);
-#endif
-
     /* delete header from cache that does not exist on server */
     if (!fc.messages[current - first])
       continue;
 
-    /* allocate memory for headers */
-    mx_alloc_memory(m, m->msg_count);
-
 #ifdef USE_HCACHE
     /* try to fetch header from cache */
+    snprintf(buf, sizeof(buf), ANUM_FMT, current);
     struct HCacheEntry hce = hcache_fetch_email(fc.hc, buf, strlen(buf), 0);
     if (hce.email)
     {
       mutt_debug(LL_DEBUG2, "hcache_fetch_email %s\n", buf);
-      e = hce.email;
-      m->emails[m->msg_count] = e;
+      fc.messages[current - first] = 0;
+      struct Email *e = hce.email;
       e->edata = NULL;
 
       /* skip header marked as deleted in cache */
@@ -1289,109 +1552,83 @@ static int nntp_fetch_headers(struct Mailbox *m, void *hc, anum_t first, anum_t
         continue;
       }
 
-      e->read = false;
-      e->old = false;
-    }
-    else
-#endif
-        if (mdata->deleted)
-    {
-      /* don't try to fetch header from removed newsgroup */
+      /* save header in context */
+      mx_alloc_memory(m, m->msg_count);
+      m->emails[m->msg_count] = e;
+      fetch_add_email(&fc, e, current);
       continue;
     }
-    else if (mdata->adata->hasOVER || mdata->adata->hasXOVER)
-    {
-      /* fallback to fetch overview */
-      if (c_nntp_listgroup && mdata->adata->hasLISTGROUP)
-        break;
-      else
-        continue;
-    }
-    else
+#endif
+
+    /* don't try to fetch header from removed newsgroup */
+    if (!mdata->deleted)
+      ARRAY_ADD(&fc.missing, current);
+  }
+  progress_free(&fc.progress);
+
+  /* fetch overview information, a window at a time */
+  if (!ARRAY_EMPTY(&fc.missing) && (mdata->adata->hasOVER || mdata->adata->hasXOVER))
+  {
+    anum_t *anum = NULL;
+    ARRAY_FOREACH(anum, &fc.missing)
     {
-      /* fetch header from server */
-      FILE *fp = mutt_file_mkstemp();
-      if (!fp)
+      struct OverRange *range = ARRAY_LAST(&fc.ranges);
+      if (range && (*anum < (range->first + NNTP_OVER_WINDOW)))
       {
-        mutt_perror(_("Can't create temporary file"));
-        rc = -1;
-        break;
+        range->last = *anum;
       }
-
-      snprintf(buf, sizeof(buf), "HEAD " ANUM_FMT "\r\n", current);
-      rc = nntp_fetch_lines(mdata, buf, sizeof(buf), NULL, fetch_tempfile, fp);
-      if (rc)
+      else
       {
-        mutt_file_fclose(&fp);
-        if (rc < 0)
-          break;
-
-        /* invalid response */
-        if (!mutt_str_startswith(buf, "423"))
-        {
-          mutt_error("HEAD: %s", buf);
-          break;
-        }
-
-        /* no such article */
-        if (mdata->bcache)
-        {
-          snprintf(buf, sizeof(buf), ANUM_FMT, current);
-          mutt_debug(LL_DEBUG2, "#3 mutt_bcache_del %s\n", buf);
-          mutt_bcache_del(mdata->bcache, buf);
-        }
-        rc = 0;
-        continue;
+        struct OverRange range_new = { *anum, *anum };
+        ARRAY_ADD(&fc.ranges, range_new);
       }
-
-      /* parse header */
-      m->emails[m->msg_count] = email_new();
-      e = m->emails[m->msg_count];
-      e->env = mutt_rfc822_read_header(fp, e, false, false);
-      e->received = e->date_sent;
-      mutt_file_fclose(&fp);
     }
 
-    /* save header in context */
-    e->index = m->msg_count++;
-    e->read = false;
-    e->old = false;
-    e->deleted = false;
-    e->edata = nntp_edata_new();
-    e->edata_free = nntp_edata_free;
-    nntp_edata_get(e)->article_num = current;
-    if (restore)
+    if (m->verbose)
+    {
+      fc.progress = progress_new(MUTT_PROGRESS_READ, last - first + 1);
+      progress_set_message(fc.progress, _("Fetching message headers..."));
+    }
+    rc = nntp_pipeline(mdata, ARRAY_SIZE(&fc.ranges), over_cmd,
+                       parse_overview_line, over_done, &fc);
+  }
+  /* or fetch the headers, one article at a time */
+  else if (!ARRAY_EMPTY(&fc.missing))
+  {
+    fc.fp = mutt_file_mkstemp();
+    if (fc.fp)
     {
-      e->changed = true;
+      if (m->verbose)
+      {
+        fc.progress = progress_new(MUTT_PROGRESS_READ, ARRAY_SIZE(&fc.missing));
+        progress_set_message(fc.progress, _("Fetching message headers..."));
+      }
+      rc = nntp_pipeline(mdata, ARRAY_SIZE(&fc.missing), head_cmd, head_line,
+                         head_done, &fc);
+      mutt_file_fclose(&fc.fp);
     }
     else
     {
-      nntp_article_status(m, e, NULL, nntp_edata_get(e)->article_num);
-      if (!e->read)
-        nntp_parse_xref(m, e);
+      mutt_perror(_("Can't create temporary file"));
+      rc = -1;
     }
-    if (current > mdata->last_loaded)
-      mdata->last_loaded = current;
-    first_over = current + 1;
   }
 
-  if (!c_nntp_listgroup || !mdata->adata->hasLISTGROUP)
-    current = first_over;
+  ARRAY_FREE(&fc.missing);
+  ARRAY_FREE(&fc.ranges);
+  FREE(&fc.messages);
+  progress_free(&fc.progress);
 
-  /* fetch overview information */
-  if ((current <= last) && (rc == 0) && !mdata->deleted)
+  /* The cached headers were added before the fetched ones.  Put them all in
+   * article order, which nntp_newsrc_gen_entries() relies on. */
+  if ((m->msg_count - old_count) > 1)
   {
-    char *cmd = mdata->adata->hasOVER ? "OVER" : "XOVER";
-    snprintf(buf, sizeof(buf), "%s " ANUM_FMT "-" ANUM_FMT "\r\n", cmd, current, last);
-    rc = nntp_fetch_lines(mdata, buf, sizeof(buf), NULL, parse_overview_line, &fc);
-    if (rc > 0)
-    {
-      mutt_error("%s: %s", cmd, buf);
-    }
+    mutt_qsort_r(m->emails + old_count, m->msg_count - old_count,
+                 sizeof(struct Email *), fetch_sort_anum, NULL);
+    for (int i = old_count; i < m->msg_count; i++)
+      m->emails[i]->index = i;
   }
 
-  FREE(&fc.messages);
-  progress_free(&fc.progress);
   if (rc != 0)
     return -1;
   mutt_clear_error();
@@ -1429,6 +1666,7 @@ static int nntp_group_poll(struct NntpMboxData *mdata, bool update_stat)
       mdata->newsrc_len = 1;
       mdata->newsrc_ent[0].first = 1;
       mdata->newsrc_ent[0].last = 0;
+      mdata->adata->newsrc_dirty = true;
     }
   }
   mdata->first_message = first;
@@ -1886,6 +2124,25 @@ int nntp_open_connection(struct NntpAccountData *adata)
     }
   }
 
+#ifdef USE_ZLIB
+  /* RFC8054 */
+  const bool c_nntp_deflate = cs_subset_bool(NeoMutt->sub, "nntp_deflate");
+  if (adata->hasCOMPRESS && c_nntp_deflate)
+  {
+    if ((mutt_socket_send(conn, "COMPRESS DEFLATE\r\n") < 0) ||
+        (mutt_socket_readln(buf, sizeof(buf), conn) < 0))
+    {
+      return nntp_connect_error(adata);
+    }
+    if (mutt_str_startswith(buf, "206"))
+    {
+      mutt_debug(LL_DEBUG2, "NNTP compression is enabled on connection to %s\n",
+                 conn->account.host);
+      mutt_zstrm_wrap_conn(conn);
+    }
+  }
+#endif
+
   /* attempt features */
   if (nntp_attempt_features(adata) < 0)
     return -1;
@@ -2423,6 +2680,7 @@ static enum MxOpenReturns nntp_mbox_open(struct Mailbox *m)
     {
       FREE(&mdata->newsrc_ent);
       mdata->newsrc_len = 0;
+      adata->newsrc_dirty = true;
       nntp_delete_group_cache(mdata);
       nntp_newsrc_update(adata);
     }
@@ -36,6 +36,11 @@ struct NntpMboxData;
 #define NNTP_PORT 119
 #define NNTP_SSL_PORT 563
 
+/* number of commands in flight when pipelining (RFC3977 3.5) */
+#define NNTP_PIPELINE_DEPTH 16
+/* number of articles requested by each OVER command */
+#define NNTP_OVER_WINDOW 1000
+
 /**
  * enum NntpStatus - NNTP server return values
  */
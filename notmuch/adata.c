@@ -33,6 +33,25 @@
 #include "core/lib.h"
 #include "adata.h"
 
+/**
+ * nm_timeout_observer - Notification that a timeout has occurred - Implements ::observer_t - @ingroup observer_api
+ *
+ * While the user is idle, carry on loading the results of a query.
+ */
+static int nm_timeout_observer(struct NotifyCallback *nc)
+{
+  if (nc->event_type != NT_TIMEOUT)
+    return 0;
+  if (!nc->global_data)
+    return -1;
+
+  struct NmAccountData *adata = nc->global_data;
+  if (adata->loading)
+    nm_load_continue(adata->loading);
+
+  return 0;
+}
+
 /**
  * nm_adata_free - Free the private Account data - Implements Account::adata_free() - @ingroup account_adata_free
  */
@@ -42,12 +61,20 @@ void nm_adata_free(void **ptr)
     return;
 
   struct NmAccountData *adata = *ptr;
+
+  notify_observer_remove(NeoMutt->notify_timeout, nm_timeout_observer, adata);
+
   if (adata->db)
   {
     nm_db_free(adata->db);
     adata->db = NULL;
   }
 
+  if (adata->stats_db)
+    nm_db_free(adata->stats_db);
+  FREE(&adata->stats_filename);
+  mutt_hash_free(&adata->counts);
+
   FREE(ptr);
 }
 
@@ -59,6 +86,8 @@ struct NmAccountData *nm_adata_new(void)
 {
   struct NmAccountData *adata = mutt_mem_calloc(1, sizeof(struct NmAccountData));
 
+  notify_observer_add(NeoMutt->notify_timeout, NT_TIMEOUT, nm_timeout_observer, adata);
+
   return adata;
 }
 
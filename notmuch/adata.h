@@ -25,7 +25,9 @@
 
 #include <notmuch.h>
 #include <stdbool.h>
+#include <time.h>
 
+struct HashTable;
 struct Mailbox;
 
 /**
@@ -36,6 +38,13 @@ struct NmAccountData
   notmuch_database_t *db; ///< Connection to Notmuch database
   bool longrun : 1;       ///< A long-lived action is in progress
   bool trans : 1;         ///< Atomic transaction in progress
+  int trans_count;        ///< Messages changed in the current transaction
+  struct Mailbox *loading; ///< Mailbox holding the database open to load a query
+
+  notmuch_database_t *stats_db; ///< Read-only database for counting messages
+  char *stats_filename;         ///< Filename of stats_db
+  time_t stats_opened;          ///< Time stats_db was opened
+  struct HashTable *counts;     ///< Cached counts, #NmCount, keyed by query
 };
 
 void                  nm_adata_free(void **ptr);
@@ -108,6 +108,9 @@ static struct ConfigDef NotmuchVars[] = {
   { "nm_config_file", DT_PATH|D_PATH_FILE, IP "auto", 0, NULL,
     "(notmuch) Configuration file for notmuch. Use 'auto' to detect configuration."
   },
+  { "nm_commit_size", DT_NUMBER|D_INTEGER_NOT_NEGATIVE, 1000, 0, NULL,
+    "(notmuch) Number of messages to change in each database transaction"
+  },
   { "nm_config_profile", DT_STRING, 0, 0, NULL,
     "(notmuch) Configuration profile for notmuch."
   },
@@ -153,6 +156,9 @@ static struct ConfigDef NotmuchVars[] = {
   { "nm_replied_tag", DT_STRING, IP "replied", 0, NULL,
     "(notmuch) Tag to use for replied messages"
   },
+  { "nm_thread_structure", DT_BOOL, false, 0, NULL,
+    "(notmuch) Use Notmuch's threads, rather than the References headers"
+  },
   { "nm_unread_tag", DT_STRING, IP "unread", 0, NULL,
     "(notmuch) Tag to use for unread messages"
   },
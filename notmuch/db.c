@@ -212,6 +212,10 @@ notmuch_database_t *nm_db_get(struct Mailbox *m, bool writable)
   if (!adata)
     return NULL;
 
+  // A Mailbox that's still loading a query holds the database open read-only
+  if (writable && adata->loading)
+    nm_load_suspend(adata->loading);
+
   // Use an existing open db if we have one.
   if (adata->db)
     return adata->db;
@@ -232,7 +236,7 @@ notmuch_database_t *nm_db_get(struct Mailbox *m, bool writable)
 int nm_db_release(struct Mailbox *m)
 {
   struct NmAccountData *adata = nm_adata_get(m);
-  if (!adata || !adata->db || nm_db_is_longrun(m))
+  if (!adata || !adata->db || nm_db_is_longrun(m) || adata->loading)
     return -1;
 
   mutt_debug(LL_DEBUG1, "nm: db close\n");
@@ -275,6 +279,7 @@ int nm_db_trans_begin(struct Mailbox *m)
   if (notmuch_database_begin_atomic(adata->db))
     return -1;
   adata->trans = true;
+  adata->trans_count = 0;
   return 1;
 }
 
@@ -301,6 +306,32 @@ int nm_db_trans_end(struct Mailbox *m)
   return 0;
 }
 
+/**
+ * nm_db_trans_step - Count a change in the current transaction
+ * @param m Mailbox
+ * @retval true The transaction was committed
+ *
+ * Once `$nm_commit_size` messages have been changed, the transaction is
+ * committed and a new one started.  This keeps a long run of changes from
+ * committing every message, without holding them all in memory.
+ */
+bool nm_db_trans_step(struct Mailbox *m)
+{
+  struct NmAccountData *adata = nm_adata_get(m);
+  if (!adata || !adata->trans)
+    return false;
+
+  adata->trans_count++;
+  const short c_nm_commit_size = cs_subset_number(NeoMutt->sub, "nm_commit_size");
+  if ((c_nm_commit_size == 0) || (adata->trans_count < c_nm_commit_size))
+    return false;
+
+  mutt_debug(LL_DEBUG2, "nm: db trans commit [%d messages]\n", adata->trans_count);
+  nm_db_trans_end(m);
+  nm_db_trans_begin(m);
+  return true;
+}
+
 /**
  * nm_db_get_mtime - Get the database modification time
  * @param[in]  m     Mailbox
@@ -313,12 +344,26 @@ int nm_db_trans_end(struct Mailbox *m)
  */
 int nm_db_get_mtime(struct Mailbox *m, time_t *mtime)
 {
-  if (!m || !mtime)
+  if (!m)
+    return -1;
+
+  return nm_db_get_file_mtime(nm_db_get_filename(m), mtime);
+}
+
+/**
+ * nm_db_get_file_mtime - Get the modification time of a database file
+ * @param[in]  db_filename Database filename
+ * @param[out] mtime       Save the modification time
+ * @retval  0 Success (result in mtime)
+ * @retval -1 Error
+ */
+int nm_db_get_file_mtime(const char *db_filename, time_t *mtime)
+{
+  if (!db_filename || !mtime)
     return -1;
 
   struct stat st = { 0 };
   char path[PATH_MAX] = { 0 };
-  const char *db_filename = nm_db_get_filename(m);
 
   mutt_debug(LL_DEBUG2, "nm: checking database mtime '%s'\n", db_filename);
 
@@ -381,10 +426,11 @@ void nm_db_longrun_done(struct Mailbox *m)
 
   if (adata)
   {
+    nm_db_trans_end(m);
     adata->longrun = false; /* to force nm_db_release() released DB */
     if (nm_db_release(m) == 0)
       mutt_debug(LL_DEBUG2, "nm: long run deinitialized\n");
-    else
+    else if (!adata->loading)
       adata->longrun = true;
   }
 }
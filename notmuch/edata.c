@@ -50,6 +50,7 @@ void nm_edata_free(void **ptr)
   FREE(&edata->folder);
   FREE(&edata->oldpath);
   FREE(&edata->virtual_id);
+  FREE(&edata->parent_id);
 
   FREE(ptr);
 }
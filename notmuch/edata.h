@@ -35,6 +35,7 @@ struct NmEmailData
   char *folder;           ///< Location of the Email
   char *oldpath;
   char *virtual_id;       ///< Unique Notmuch Id
+  char *parent_id;        ///< Message-ID of the parent in Notmuch's thread
   enum MailboxType type;  ///< Type of Mailbox the Email is in
 };
 
@@ -61,6 +61,7 @@ void  nm_db_longrun_done         (struct Mailbox *m);
 void  nm_db_longrun_init         (struct Mailbox *m, bool writable);
 char *nm_email_get_folder        (struct Email *e);
 char *nm_email_get_folder_rel_db (struct Mailbox *m, struct Email *e);
+const char *nm_email_get_parent_id(struct Email *e);
 int   nm_get_all_tags            (struct Mailbox *m, const char **tag_list, int *tag_count);
 bool  nm_message_is_still_queried(struct Mailbox *m, struct Email *e);
 enum MailboxType nm_path_probe   (const char *path, const struct stat *st);
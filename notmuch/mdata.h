@@ -23,6 +23,8 @@
 #ifndef MUTT_NOTMUCH_MDATA_H
 #define MUTT_NOTMUCH_MDATA_H
 
+#include <notmuch.h>
+#include <stdbool.h>
 #include <time.h>
 #include "query.h"
 
@@ -42,6 +44,16 @@ struct NmMboxData
   int oldmsgcount;
   int ignmsgcount;             ///< Ignored messages
   struct timespec mtime;       ///< Time Mailbox was last changed
+  unsigned long db_revision;   ///< Database revision (lastmod) of the last refresh
+  char *db_uuid;               ///< Database UUID, the revision is only valid for this
+
+  bool loading;                    ///< The query's results are still being loaded
+  bool load_dedup;                 ///< De-duplicate the rest of the results
+  bool load_changed;               ///< Emails have been loaded since the last check
+  int load_pos;                    ///< Number of results (messages or threads) loaded
+  notmuch_query_t *load_query;     ///< Query being loaded, NULL if suspended
+  notmuch_messages_t *load_msgs;   ///< Messages left to load, #NM_QUERY_TYPE_MESGS
+  notmuch_threads_t *load_threads; ///< Threads left to load, #NM_QUERY_TYPE_THREADS
 };
 
 void                  nm_mdata_free(void **ptr);
@@ -46,6 +46,22 @@
  * - all functions have to be covered by "mailbox->type == MUTT_NOTMUCH" check
  *   (it's implemented in nm_mdata_get() and init_mailbox() functions).
  *
+ * ## Loading
+ *
+ * A query can match hundreds of thousands of messages, so its results are
+ * loaded in slices.  nm_mbox_open() loads the first #NM_LOAD_FIRST
+ * milliseconds' worth, enough to fill the screen, and leaves the query open.
+ * While the user is idle, each #NT_TIMEOUT loads some more, until the results
+ * run out, the user presses a key, or the Mailbox is closed.  The next
+ * nm_mbox_check() reports the new Emails as #MX_STATUS_FLAGS, so that the index
+ * is refreshed without announcing new mail.
+ *
+ * While the results are being loaded, the database is held open read-only.
+ * If anything needs to write to it, the load is suspended.  The next
+ * nm_mbox_check() runs the query again and skips the results that have already
+ * been loaded.  The write may have changed the results, so the Emails are
+ * de-duplicated by Message-Id, too.
+ *
  * Implementation: #MxNotmuchOps
  */
 
@@ -67,6 +83,7 @@
 #include "mutt.h"
 #include "lib.h"
 #include "editor/lib.h"
+#include "gui/lib.h"
 #include "hcache/lib.h"
 #include "history/lib.h"
 #include "index/lib.h"
@@ -87,6 +104,11 @@
 
 struct stat;
 
+/// Time to spend loading results when the Mailbox is opened, in milliseconds
+#define NM_LOAD_FIRST 250
+/// Time to spend loading results on each check, in milliseconds
+#define NM_LOAD_SLICE 1000
+
 /**
  * NmCommands - Notmuch Commands
  */
@@ -471,6 +493,27 @@ err:
   return NULL;
 }
 
+/**
+ * save_revision - Remember the database's revision
+ * @param m Mailbox
+ *
+ * The next nm_mbox_check() only needs to look at messages changed after this.
+ */
+static void save_revision(struct Mailbox *m)
+{
+#if LIBNOTMUCH_CHECK_VERSION(4, 3, 0)
+  struct NmMboxData *mdata = nm_mdata_get(m);
+  notmuch_database_t *db = nm_db_get(m, false);
+  if (!mdata || !db)
+    return;
+
+  const char *uuid = NULL;
+  mdata->db_revision = notmuch_database_get_revision(db, &uuid);
+  mutt_str_replace(&mdata->db_uuid, uuid);
+  mutt_debug(LL_DEBUG2, "nm: revision %lu, uuid %s\n", mdata->db_revision, NONULL(uuid));
+#endif
+}
+
 /**
  * update_email_tags - Update the Email's tags from Notmuch
  * @param e   Email
@@ -744,13 +787,15 @@ static struct Email *get_mutt_email(struct Mailbox *m, notmuch_message_t *msg)
  * @param m     Mailbox
  * @param msg   Notmuch message
  * @param dedup De-duplicate results
+ * @retval ptr  New Email
+ * @retval NULL Error, or a duplicate
  */
-static void append_message(struct HeaderCache *hc, struct Mailbox *m,
-                           notmuch_message_t *msg, bool dedup)
+static struct Email *append_message(struct HeaderCache *hc, struct Mailbox *m,
+                                    notmuch_message_t *msg, bool dedup)
 {
   struct NmMboxData *mdata = nm_mdata_get(m);
   if (!mdata)
-    return;
+    return NULL;
 
   char *newpath = NULL;
   struct Email *e = NULL;
@@ -762,12 +807,12 @@ static void append_message(struct HeaderCache *hc, struct Mailbox *m,
     nm_progress_update(m);
     mutt_debug(LL_DEBUG2, "nm: ignore id=%s, already in the m\n",
                notmuch_message_get_message_id(msg));
-    return;
+    return NULL;
   }
 
   const char *path = get_message_last_filename(msg);
   if (!path)
-    return;
+    return NULL;
 
   mutt_debug(LL_DEBUG2, "nm: appending message, i=%d, id=%s, path=%s\n",
              m->msg_count, notmuch_message_get_message_id(msg), path);
@@ -833,6 +878,10 @@ static void append_message(struct HeaderCache *hc, struct Mailbox *m,
   m->emails[m->msg_count] = e;
   m->msg_count++;
 
+  /* keep the hash up to date, so that de-duplication sees this message */
+  if (m->id_hash && e->env->message_id)
+    mutt_hash_insert(m->id_hash, e->env->message_id, e);
+
   if (newpath)
   {
     /* remember that file has been moved -- nm_mbox_sync() will update the DB */
@@ -846,6 +895,7 @@ static void append_message(struct HeaderCache *hc, struct Mailbox *m,
   nm_progress_update(m);
 done:
   FREE(&newpath);
+  return e;
 }
 
 /**
@@ -867,7 +917,16 @@ static void append_replies(struct HeaderCache *hc, struct Mailbox *m,
        notmuch_messages_move_to_next(msgs))
   {
     notmuch_message_t *nm = notmuch_messages_get(msgs);
-    append_message(hc, m, nm, dedup);
+    struct Email *e = append_message(hc, m, nm, dedup);
+
+    /* remember notmuch's idea of the thread, see $nm_thread_structure */
+    struct NmEmailData *edata = nm_edata_get(e);
+    if (edata)
+    {
+      FREE(&edata->parent_id);
+      edata->parent_id = nm2mutt_message_id(notmuch_message_get_message_id(top));
+    }
+
     /* recurse through all the replies to this message too */
     append_replies(hc, m, q, nm, dedup);
     notmuch_message_destroy(nm);
@@ -929,47 +988,6 @@ static notmuch_messages_t *get_messages(notmuch_query_t *query)
   return msgs;
 }
 
-/**
- * read_mesgs_query - Search for matching messages
- * @param m     Mailbox
- * @param q     Notmuch query
- * @param dedup De-duplicate the results
- * @retval true  Success
- * @retval false Failure
- */
-static bool read_mesgs_query(struct Mailbox *m, notmuch_query_t *q, bool dedup)
-{
-  struct NmMboxData *mdata = nm_mdata_get(m);
-  if (!mdata)
-    return false;
-
-  int limit = get_limit(mdata);
-
-  notmuch_messages_t *msgs = get_messages(q);
-
-  if (!msgs)
-    return false;
-
-  struct HeaderCache *hc = nm_hcache_open(m);
-
-  for (; notmuch_messages_valid(msgs) && ((limit == 0) || (m->msg_count < limit));
-       notmuch_messages_move_to_next(msgs))
-  {
-    if (SigInt)
-    {
-      nm_hcache_close(&hc);
-      SigInt = false;
-      return false;
-    }
-    notmuch_message_t *nm = notmuch_messages_get(msgs);
-    append_message(hc, m, nm, dedup);
-    notmuch_message_destroy(nm);
-  }
-
-  nm_hcache_close(&hc);
-  return true;
-}
-
 /**
  * get_threads - Load threads for a query
  * @param query Notmuch query
@@ -1037,6 +1055,251 @@ static bool read_threads_query(struct Mailbox *m, notmuch_query_t *q, bool dedup
   return true;
 }
 
+/**
+ * load_free - Free the query that's being loaded
+ * @param m Mailbox
+ */
+static void load_free(struct Mailbox *m)
+{
+  struct NmMboxData *mdata = nm_mdata_get(m);
+  if (!mdata)
+    return;
+
+  /* the messages and threads belong to the query */
+  if (mdata->load_query)
+    notmuch_query_destroy(mdata->load_query);
+  mdata->load_query = NULL;
+  mdata->load_msgs = NULL;
+  mdata->load_threads = NULL;
+
+  struct NmAccountData *adata = nm_adata_get(m);
+  if (adata && (adata->loading == m))
+    adata->loading = NULL;
+}
+
+/**
+ * load_stop - Stop loading the results of a query
+ * @param m Mailbox
+ *
+ * @note The caller must release the database
+ */
+static void load_stop(struct Mailbox *m)
+{
+  struct NmMboxData *mdata = nm_mdata_get(m);
+  if (!mdata)
+    return;
+
+  load_free(m);
+  mdata->loading = false;
+  mdata->load_dedup = false;
+  mdata->load_pos = 0;
+}
+
+/**
+ * nm_load_suspend - Suspend the loading of a query
+ * @param m Mailbox
+ *
+ * Let go of the query, so that the database can be reopened read/write.
+ * The next nm_mbox_check() will run the query again, and carry on from where
+ * it left off.
+ */
+void nm_load_suspend(struct Mailbox *m)
+{
+  struct NmMboxData *mdata = nm_mdata_get(m);
+  if (!mdata || !mdata->load_query)
+    return;
+
+  mutt_debug(LL_DEBUG1, "nm: suspend loading [pos=%d]\n", mdata->load_pos);
+  load_free(m);
+  /* the emails loaded so far mustn't be added again */
+  mdata->load_dedup = true;
+  nm_db_release(m);
+}
+
+/**
+ * load_start - Run the query, ready to load its results
+ * @param m Mailbox
+ * @retval true  Success
+ * @retval false Failure
+ *
+ * If the load was suspended, skip the results that have already been loaded.
+ * libnotmuch can't set an offset on a query, so step over them.
+ */
+static bool load_start(struct Mailbox *m)
+{
+  struct NmMboxData *mdata = nm_mdata_get(m);
+  struct NmAccountData *adata = nm_adata_get(m);
+  if (!mdata || !adata)
+    return false;
+
+  /* only one Mailbox at a time can hold the database open */
+  if (adata->loading && (adata->loading != m))
+    nm_load_suspend(adata->loading);
+
+  mdata->load_query = get_query(m, false);
+  if (!mdata->load_query)
+    return false;
+
+  /* if the load was resumed, keep the older revision, to be safe */
+  if (!mdata->loading)
+    save_revision(m);
+
+  if (mdata->query_type == NM_QUERY_TYPE_THREADS)
+  {
+    mdata->load_threads = get_threads(mdata->load_query);
+    for (int i = 0; mdata->load_threads && (i < mdata->load_pos) &&
+                    notmuch_threads_valid(mdata->load_threads);
+         i++)
+    {
+      notmuch_threads_move_to_next(mdata->load_threads);
+    }
+  }
+  else
+  {
+    mdata->load_msgs = get_messages(mdata->load_query);
+    for (int i = 0; mdata->load_msgs && (i < mdata->load_pos) &&
+                    notmuch_messages_valid(mdata->load_msgs);
+         i++)
+    {
+      notmuch_messages_move_to_next(mdata->load_msgs);
+    }
+  }
+
+  if (!mdata->load_msgs && !mdata->load_threads)
+  {
+    load_free(m);
+    return false;
+  }
+
+  adata->loading = m;
+  mdata->loading = true;
+  return true;
+}
+
+/**
+ * load_batch - Load some more of the query's results
+ * @param m     Mailbox
+ * @param slice Time to spend, in milliseconds
+ * @param keys  Stop early if the user presses a key
+ * @retval  1 There are more results to load
+ * @retval  0 All the results have been loaded
+ * @retval -1 Interrupted by the user
+ */
+static int load_batch(struct Mailbox *m, uint64_t slice, bool keys)
+{
+  struct NmMboxData *mdata = nm_mdata_get(m);
+  if (!mdata || !mdata->load_query)
+    return 0;
+
+  const int limit = get_limit(mdata);
+  const uint64_t end = mutt_date_now_ms() + slice;
+  struct HeaderCache *hc = nm_hcache_open(m);
+  int rc = 1;
+
+  while (true)
+  {
+    if ((limit != 0) && (m->msg_count >= limit))
+    {
+      rc = 0;
+      break;
+    }
+
+    if (mdata->load_msgs)
+    {
+      if (!notmuch_messages_valid(mdata->load_msgs))
+      {
+        rc = 0;
+        break;
+      }
+      notmuch_message_t *nm = notmuch_messages_get(mdata->load_msgs);
+      append_message(hc, m, nm, mdata->load_dedup);
+      notmuch_message_destroy(nm);
+      notmuch_messages_move_to_next(mdata->load_msgs);
+    }
+    else
+    {
+      if (!notmuch_threads_valid(mdata->load_threads))
+      {
+        rc = 0;
+        break;
+      }
+      notmuch_thread_t *thread = notmuch_threads_get(mdata->load_threads);
+      append_thread(hc, m, mdata->load_query, thread, mdata->load_dedup);
+      notmuch_thread_destroy(thread);
+      notmuch_threads_move_to_next(mdata->load_threads);
+    }
+    mdata->load_pos++;
+
+    if (SigInt)
+    {
+      SigInt = false;
+      rc = -1;
+      break;
+    }
+
+    if ((mutt_date_now_ms() >= end) || (keys && mutt_key_pending()))
+      break;
+  }
+
+  nm_hcache_close(&hc);
+  return rc;
+}
+
+/**
+ * nm_load_continue - Load some more of the query's results
+ * @param m Mailbox
+ *
+ * The new Emails are reported by the next nm_mbox_check().
+ */
+void nm_load_continue(struct Mailbox *m)
+{
+  struct NmMboxData *mdata = nm_mdata_get(m);
+  if (!mdata || !mdata->loading)
+    return;
+
+  const int oldmsgcount = m->msg_count;
+  int rc = 0;
+  if (mdata->load_query || load_start(m))
+    rc = load_batch(m, NM_LOAD_SLICE, true);
+
+  if (rc <= 0)
+  {
+    load_stop(m);
+    nm_db_release(m);
+  }
+
+  mutt_debug(LL_DEBUG1, "nm: loading... [rc=%d, count=%d]\n", rc, m->msg_count);
+
+  if (m->msg_count > oldmsgcount)
+    mdata->load_changed = true;
+  if ((rc > 0) || mdata->load_changed)
+    m->last_checked = 0; // continue on the next mx_mbox_check() call
+}
+
+/**
+ * load_continue - Load some more of the query's results and report them
+ * @param m Mailbox
+ * @retval enum #MxStatus
+ *
+ * The Emails are older results of the query, not new mail, so they're
+ * reported as #MX_STATUS_FLAGS, which just refreshes the index.
+ */
+static enum MxStatus load_continue(struct Mailbox *m)
+{
+  struct NmMboxData *mdata = nm_mdata_get(m);
+  if (!mdata)
+    return MX_STATUS_ERROR;
+
+  nm_load_continue(m);
+
+  if (!mdata->load_changed)
+    return MX_STATUS_OK;
+
+  mdata->load_changed = false;
+  mailbox_changed(m, NT_MAILBOX_INVALID);
+  return MX_STATUS_FLAGS;
+}
+
 /**
  * get_nm_message - Find a Notmuch message
  * @param db  Notmuch database
@@ -1460,6 +1723,251 @@ static unsigned int count_query(notmuch_database_t *db, const char *qstr, int li
   return res;
 }
 
+/**
+ * struct NmCount - Cached counts of a virtual mailbox
+ */
+struct NmCount
+{
+  unsigned long revision; ///< Database revision of the counts
+  unsigned int all;       ///< Number of messages
+  unsigned int unread;    ///< Number of unread messages
+  unsigned int flagged;   ///< Number of flagged messages
+};
+
+/**
+ * count_hash_free - Free our hash table data - Implements ::hash_hdata_free_t - @ingroup hash_hdata_free_api
+ */
+static void count_hash_free(int type, void *obj, intptr_t data)
+{
+  FREE(&obj);
+}
+
+/**
+ * stats_db_get - Get the database for counting messages
+ * @param adata       Notmuch Account data
+ * @param db_filename Database filename
+ * @retval ptr  Notmuch database
+ * @retval NULL Error
+ *
+ * All the virtual mailboxes share one read-only database.  It's only reopened
+ * once the database has been modified, to see the changes.
+ */
+static notmuch_database_t *stats_db_get(struct NmAccountData *adata, const char *db_filename)
+{
+  time_t mtime = 0;
+  if (adata->stats_db)
+  {
+    /* a change in the same second as the open might not have been seen */
+    if (mutt_str_equal(adata->stats_filename, db_filename) &&
+        (nm_db_get_file_mtime(db_filename, &mtime) == 0) && (mtime < adata->stats_opened))
+    {
+      return adata->stats_db;
+    }
+
+    nm_db_free(adata->stats_db);
+    adata->stats_db = NULL;
+    mutt_debug(LL_DEBUG1, "nm: count close DB\n");
+  }
+
+  /* don't be verbose about connection, as we're called from
+   * sidebar/mailbox very often */
+  adata->stats_opened = mutt_date_now();
+  adata->stats_db = nm_db_do_open(db_filename, false, false);
+  mutt_str_replace(&adata->stats_filename, db_filename);
+  return adata->stats_db;
+}
+
+/**
+ * stats_db_revision - Get the revision of the counting database
+ * @param adata Notmuch Account data
+ * @retval num Database revision
+ *
+ * Without lastmod support, the time the database was opened is used instead.
+ */
+static unsigned long stats_db_revision(struct NmAccountData *adata)
+{
+#if LIBNOTMUCH_CHECK_VERSION(4, 3, 0)
+  return notmuch_database_get_revision(adata->stats_db, NULL);
+#else
+  return adata->stats_opened;
+#endif
+}
+
+/**
+ * merge_email - Update an Email from its Notmuch message
+ * @param m   Mailbox
+ * @param e   Email
+ * @param msg Notmuch message
+ * @retval true The tags have changed
+ */
+static bool merge_email(struct Mailbox *m, struct Email *e, notmuch_message_t *msg)
+{
+  /* Check to see if the message has moved to a different subdirectory.
+   * If so, update the associated filename.  */
+  const char *new_file = get_message_last_filename(msg);
+  char old_file[PATH_MAX] = { 0 };
+  email_get_fullpath(e, old_file, sizeof(old_file));
+
+  if (!mutt_str_equal(old_file, new_file))
+    update_message_path(e, new_file);
+
+  if (!e->changed)
+  {
+    /* if the user hasn't modified the flags on this message, update the
+     * flags we just detected.  */
+    struct Email *e_tmp = maildir_email_new();
+    maildir_parse_flags(e_tmp, new_file);
+    e_tmp->old = e->old;
+    maildir_update_flags(m, e, e_tmp);
+    email_free(&e_tmp);
+  }
+
+  return (update_email_tags(e, msg) == 0);
+}
+
+#if LIBNOTMUCH_CHECK_VERSION(4, 3, 0)
+/**
+ * check_changes - Update a Mailbox with the messages changed since the last check
+ * @param[in]  m  Mailbox
+ * @param[out] rc Result of the check, e.g. #MX_STATUS_NEW_MAIL
+ * @retval true  Mailbox was updated
+ * @retval false A full check is needed
+ *
+ * Every change to a message's tags or files raises its "lastmod" revision, so
+ * only the messages changed since the last check need to be examined:
+ * - `(QUERY) and lastmod:REV..` are new or updated
+ * - the rest of `lastmod:REV..` no longer match the query
+ *
+ * Messages deleted from the database don't show up at all, so if the number of
+ * results doesn't add up afterwards, a full check is needed.
+ *
+ * @note The caller must release the database
+ */
+static bool check_changes(struct Mailbox *m, enum MxStatus *rc)
+{
+  struct NmMboxData *mdata = nm_mdata_get(m);
+  if (!mdata || !mdata->db_uuid)
+    return false;
+
+  const char *str = get_query_string(mdata, true);
+  notmuch_database_t *db = nm_db_get(m, false);
+  if (!str || !db)
+    return false;
+
+  /* a thread's other messages, or the oldest of a limit, can't be tracked */
+  if ((mdata->query_type == NM_QUERY_TYPE_THREADS) || (get_limit(mdata) != 0))
+    return false;
+
+  const char *uuid = NULL;
+  const unsigned long revision = notmuch_database_get_revision(db, &uuid);
+  if (!mutt_str_equal(uuid, mdata->db_uuid))
+    return false; // the database has been rebuilt
+
+  mutt_debug(LL_DEBUG1, "nm: checking changes (revision %lu..%lu)\n",
+             mdata->db_revision, revision);
+
+  bool updated = false;
+  bool occult = false;
+  int new_flags = 0;
+  const int oldmsgcount = m->msg_count;
+  struct HashTable *matches = mutt_hash_new(64, MUTT_HASH_STRDUP_KEYS);
+  struct Buffer *qstr = buf_pool_get();
+  notmuch_messages_t *msgs = NULL;
+
+  /* changed messages that match the query */
+  buf_printf(qstr, "(%s) and lastmod:%lu..", str, mdata->db_revision + 1);
+  notmuch_query_t *q = notmuch_query_create(db, buf_string(qstr));
+  if (!q)
+    goto done;
+  apply_exclude_tags(q);
+  msgs = get_messages(q);
+  if (!msgs)
+    goto done;
+
+  struct HeaderCache *hc = nm_hcache_open(m);
+  for (; notmuch_messages_valid(msgs); notmuch_messages_move_to_next(msgs))
+  {
+    notmuch_message_t *msg = notmuch_messages_get(msgs);
+    mutt_hash_insert(matches, notmuch_message_get_message_id(msg), matches);
+
+    struct Email *e = get_mutt_email(m, msg);
+    if (e)
+    {
+      e->active = true;
+      if (merge_email(m, e, msg))
+        new_flags++;
+    }
+    else
+    {
+      append_message(hc, m, msg, false);
+    }
+    notmuch_message_destroy(msg);
+  }
+  nm_hcache_close(&hc);
+  notmuch_query_destroy(q);
+
+  /* changed messages that don't match any more */
+  buf_printf(qstr, "lastmod:%lu..", mdata->db_revision + 1);
+  q = notmuch_query_create(db, buf_string(qstr));
+  if (!q)
+    goto done;
+  msgs = get_messages(q);
+  if (!msgs)
+    goto done;
+
+  for (; notmuch_messages_valid(msgs); notmuch_messages_move_to_next(msgs))
+  {
+    notmuch_message_t *msg = notmuch_messages_get(msgs);
+    if (!mutt_hash_find(matches, notmuch_message_get_message_id(msg)))
+    {
+      struct Email *e = get_mutt_email(m, msg);
+      if (e && e->active)
+      {
+        e->active = false;
+        occult = true;
+      }
+    }
+    notmuch_message_destroy(msg);
+  }
+
+  /* deleted messages don't appear in either query */
+  unsigned int active = 0;
+  for (int i = 0; i < m->msg_count; i++)
+  {
+    struct Email *e = m->emails[i];
+    if (e && e->active)
+      active++;
+  }
+  if (count_query(db, str, 0) != active)
+  {
+    mutt_debug(LL_DEBUG1, "nm: %u messages, the query doesn't agree\n", active);
+    goto done;
+  }
+
+  mdata->db_revision = revision;
+  updated = true;
+
+  mutt_debug(LL_DEBUG1, "nm: ... changes done [count=%d, new_flags=%d, occult=%d]\n",
+             m->msg_count, new_flags, occult);
+
+  if (occult)
+    *rc = MX_STATUS_REOPENED;
+  else if (m->msg_count > oldmsgcount)
+    *rc = MX_STATUS_NEW_MAIL;
+  else if (new_flags)
+    *rc = MX_STATUS_FLAGS;
+  else
+    *rc = MX_STATUS_OK;
+
+done:
+  if (q)
+    notmuch_query_destroy(q);
+  buf_pool_release(&qstr);
+  mutt_hash_free(&matches);
+  return updated;
+}
+#endif
+
 /**
  * nm_email_get_folder - Get the folder for a Email
  * @param e Email
@@ -1475,6 +1983,21 @@ char *nm_email_get_folder(struct Email *e)
   return edata->folder;
 }
 
+/**
+ * nm_email_get_parent_id - Get the parent of an Email in Notmuch's thread
+ * @param e Email
+ * @retval ptr  Message-ID of the parent
+ * @retval NULL Unknown, the Email is top-level or wasn't read as a thread
+ */
+const char *nm_email_get_parent_id(struct Email *e)
+{
+  struct NmEmailData *edata = nm_edata_get(e);
+  if (!edata)
+    return NULL;
+
+  return edata->parent_id;
+}
+
 /**
  * nm_email_get_folder_rel_db - Get the folder for a Email from the same level as the notmuch database
  * @param m Mailbox containing Email
@@ -1546,6 +2069,9 @@ int nm_read_entire_thread(struct Mailbox *m, struct Email *e)
   notmuch_query_set_sort(q, NOTMUCH_SORT_NEWEST_FIRST);
 
   read_threads_query(m, q, true, 0);
+  /* the rest of the query mustn't add these messages again */
+  if (mdata->loading)
+    mdata->load_dedup = true;
   mdata->mtime.tv_sec = mutt_date_now();
   mdata->mtime.tv_nsec = 0;
   rc = 0;
@@ -1792,6 +2318,8 @@ static enum MxStatus nm_mbox_check_stats(struct Mailbox *m, uint8_t flags)
   const char *db_filename = NULL;
   char *db_query = NULL;
   notmuch_database_t *db = NULL;
+  struct NmAccountData *adata = nm_adata_get(m);
+  struct Buffer *key = NULL;
   enum MxStatus rc = MX_STATUS_ERROR;
   const short c_nm_db_limit = cs_subset_number(NeoMutt->sub, "nm_db_limit");
   int limit = c_nm_db_limit;
@@ -1821,45 +2349,74 @@ static enum MxStatus nm_mbox_check_stats(struct Mailbox *m, uint8_t flags)
     }
   }
 
-  if (!db_query)
+  if (!db_query || !adata)
     goto done;
 
   db_filename = url->path;
   if (!db_filename)
     db_filename = nm_db_get_filename(m);
 
-  /* don't be verbose about connection, as we're called from
-   * sidebar/mailbox very often */
-  db = nm_db_do_open(db_filename, false, false);
+  db = stats_db_get(adata, db_filename);
   if (!db)
     goto done;
 
-  /* all emails */
-  m->msg_count = count_query(db, db_query, limit);
-  mx_alloc_memory(m, m->msg_count);
+  const char *const c_nm_unread_tag = cs_subset_string(NeoMutt->sub, "nm_unread_tag");
+  const char *const c_nm_flagged_tag = cs_subset_string(NeoMutt->sub, "nm_flagged_tag");
+  const char *const c_nm_exclude_tags = cs_subset_string(NeoMutt->sub, "nm_exclude_tags");
 
-  // holder variable for extending query to unread/flagged
-  char *qstr = NULL;
+  /* the counts depend on the database, the query, the limit and the tags */
+  key = buf_pool_get();
+  buf_printf(key, "%s|%d|%s|%s|%s|%s", NONULL(db_filename), limit,
+             NONULL(c_nm_unread_tag), NONULL(c_nm_flagged_tag),
+             NONULL(c_nm_exclude_tags), db_query);
 
-  // unread messages
-  const char *const c_nm_unread_tag = cs_subset_string(NeoMutt->sub, "nm_unread_tag");
-  mutt_str_asprintf(&qstr, "( %s ) tag:%s", db_query, c_nm_unread_tag);
-  m->msg_unread = count_query(db, qstr, limit);
-  FREE(&qstr);
+  if (!adata->counts)
+  {
+    adata->counts = mutt_hash_new(64, MUTT_HASH_STRDUP_KEYS);
+    mutt_hash_set_destructor(adata->counts, count_hash_free, 0);
+  }
 
-  // flagged messages
-  const char *const c_nm_flagged_tag = cs_subset_string(NeoMutt->sub, "nm_flagged_tag");
-  mutt_str_asprintf(&qstr, "( %s ) tag:%s", db_query, c_nm_flagged_tag);
-  m->msg_flagged = count_query(db, qstr, limit);
-  FREE(&qstr);
+  const unsigned long revision = stats_db_revision(adata);
+  struct NmCount *count = mutt_hash_find(adata->counts, buf_string(key));
+  if (count && (count->revision == revision))
+  {
+    mutt_debug(LL_DEBUG1, "nm: count unchanged at revision %lu\n", revision);
+  }
+  else
+  {
+    if (!count)
+    {
+      count = mutt_mem_calloc(1, sizeof(struct NmCount));
+      mutt_hash_insert(adata->counts, buf_string(key), count);
+    }
+
+    // holder variable for extending query to unread/flagged
+    char *qstr = NULL;
+
+    /* all emails */
+    count->all = count_query(db, db_query, limit);
+
+    // unread messages
+    mutt_str_asprintf(&qstr, "( %s ) tag:%s", db_query, c_nm_unread_tag);
+    count->unread = count_query(db, qstr, limit);
+    FREE(&qstr);
+
+    // flagged messages
+    mutt_str_asprintf(&qstr, "( %s ) tag:%s", db_query, c_nm_flagged_tag);
+    count->flagged = count_query(db, qstr, limit);
+    FREE(&qstr);
+
+    count->revision = revision;
+  }
+
+  m->msg_count = count->all;
+  mx_alloc_memory(m, m->msg_count);
+  m->msg_unread = count->unread;
+  m->msg_flagged = count->flagged;
 
   rc = (m->msg_new > 0) ? MX_STATUS_NEW_MAIL : MX_STATUS_OK;
 done:
-  if (db)
-  {
-    nm_db_free(db);
-    mutt_debug(LL_DEBUG1, "nm: count close DB\n");
-  }
+  buf_pool_release(&key);
   url_free(&url);
 
   mutt_debug(LL_DEBUG1, "nm: count done [rc=%d]\n", rc);
@@ -2057,23 +2614,17 @@ static enum MxOpenReturns nm_mbox_open(struct Mailbox *m)
   progress_setup(m);
   enum MxOpenReturns rc = MX_OPEN_ERROR;
 
-  notmuch_query_t *q = get_query(m, false);
-  if (q)
+  load_stop(m);
+  if (load_start(m))
   {
     rc = MX_OPEN_OK;
-    switch (mdata->query_type)
-    {
-      case NM_QUERY_TYPE_UNKNOWN: // UNKNOWN should never occur, but MESGS is default
-      case NM_QUERY_TYPE_MESGS:
-        if (!read_mesgs_query(m, q, false))
-          rc = MX_OPEN_ABORT;
-        break;
-      case NM_QUERY_TYPE_THREADS:
-        if (!read_threads_query(m, q, false, get_limit(mdata)))
-          rc = MX_OPEN_ABORT;
-        break;
-    }
-    notmuch_query_destroy(q);
+    int more = load_batch(m, NM_LOAD_FIRST, false);
+    if (more < 0)
+      rc = MX_OPEN_ABORT;
+    if (more <= 0)
+      load_stop(m);
+    else
+      m->last_checked = 0; // continue on the first mx_mbox_check() call
   }
 
   nm_db_release(m);
@@ -2083,7 +2634,8 @@ static enum MxOpenReturns nm_mbox_open(struct Mailbox *m)
 
   mdata->oldmsgcount = 0;
 
-  mutt_debug(LL_DEBUG1, "nm: reading messages... done [rc=%d, count=%d]\n", rc, m->msg_count);
+  mutt_debug(LL_DEBUG1, "nm: reading messages... done [rc=%d, count=%d, more=%d]\n",
+             rc, m->msg_count, mdata->loading);
   progress_free(&mdata->progress);
   return rc;
 }
@@ -2100,6 +2652,10 @@ static enum MxStatus nm_mbox_check(struct Mailbox *m)
   if (!mdata || (nm_db_get_mtime(m, &mtime) != 0))
     return MX_STATUS_ERROR;
 
+  /* carry on loading, changes are picked up once the query is complete */
+  if (mdata->loading || mdata->load_changed)
+    return load_continue(m);
+
   int new_flags = 0;
   bool occult = false;
 
@@ -2113,12 +2669,26 @@ static enum MxStatus nm_mbox_check(struct Mailbox *m)
   mutt_debug(LL_DEBUG1, "nm: checking (db=%llu mailbox=%llu)\n",
              (unsigned long long) mtime, (unsigned long long) mdata->mtime.tv_sec);
 
+  /* check_changes() may add Emails before giving up, so count from here */
+  mdata->oldmsgcount = m->msg_count;
+
+#if LIBNOTMUCH_CHECK_VERSION(4, 3, 0)
+  enum MxStatus rc = MX_STATUS_OK;
+  if (check_changes(m, &rc))
+  {
+    nm_db_release(m);
+    mdata->mtime.tv_sec = mutt_date_now();
+    mdata->mtime.tv_nsec = 0;
+    return rc;
+  }
+#endif
+
   notmuch_query_t *q = get_query(m, false);
   if (!q)
     goto done;
 
   mutt_debug(LL_DEBUG1, "nm: start checking (count=%d)\n", m->msg_count);
-  mdata->oldmsgcount = m->msg_count;
+  save_revision(m);
 
   for (int i = 0; i < m->msg_count; i++)
   {
@@ -2160,28 +2730,7 @@ static enum MxStatus nm_mbox_check(struct Mailbox *m)
 
     /* message already exists, merge flags */
     e->active = true;
-
-    /* Check to see if the message has moved to a different subdirectory.
-     * If so, update the associated filename.  */
-    const char *new_file = get_message_last_filename(msg);
-    char old_file[PATH_MAX] = { 0 };
-    email_get_fullpath(e, old_file, sizeof(old_file));
-
-    if (!mutt_str_equal(old_file, new_file))
-      update_message_path(e, new_file);
-
-    if (!e->changed)
-    {
-      /* if the user hasn't modified the flags on this message, update the
-       * flags we just detected.  */
-      struct Email *e_tmp = maildir_email_new();
-      maildir_parse_flags(e_tmp, new_file);
-      e_tmp->old = e->old;
-      maildir_update_flags(m, e, e_tmp);
-      email_free(&e_tmp);
-    }
-
-    if (update_email_tags(e, msg) == 0)
+    if (merge_email(m, e, msg))
       new_flags++;
 
     notmuch_message_destroy(msg);
@@ -2250,6 +2799,13 @@ static enum MxStatus nm_mbox_sync(struct Mailbox *m)
 
   struct HeaderCache *hc = nm_hcache_open(m);
 
+  /* keep the database open and commit the changes in batches */
+  const bool longrun = !nm_db_is_longrun(m);
+  if (longrun)
+    nm_db_longrun_init(m, true);
+  nm_db_trans_begin(m);
+  const uint64_t start = mutt_date_now_ms();
+
   int mh_sync_errors = 0;
   for (int i = 0; i < m->msg_count; i++)
   {
@@ -2318,6 +2874,13 @@ static enum MxStatus nm_mbox_sync(struct Mailbox *m)
         changed = true;
       else if (*new_file && *old_file && (rename_filename(m, old_file, new_file, e) == 0))
         changed = true;
+
+      if (nm_db_trans_step(m) && progress)
+      {
+        const uint64_t elapsed = mutt_date_now_ms() - start;
+        progress_set_message(progress, _("Writing %s... (%d messages/s)"), mailbox_path(m),
+                             (int) (((i + 1) * 1000) / MAX(elapsed, 1)));
+      }
     }
 
     FREE(&edata->oldpath);
@@ -2334,7 +2897,8 @@ static enum MxStatus nm_mbox_sync(struct Mailbox *m)
   buf_strcpy(&m->pathbuf, url);
   m->type = MUTT_NOTMUCH;
 
-  nm_db_release(m);
+  if (longrun)
+    nm_db_longrun_done(m);
 
   if (changed)
   {
@@ -2353,10 +2917,19 @@ static enum MxStatus nm_mbox_sync(struct Mailbox *m)
 /**
  * nm_mbox_close - Close a Mailbox - Implements MxOps::mbox_close() - @ingroup mx_mbox_close
  *
- * Nothing to do.
+ * Cancel the loading of the query's results, if it's still running.
  */
 static enum MxStatus nm_mbox_close(struct Mailbox *m)
 {
+  struct NmMboxData *mdata = nm_mdata_get(m);
+  if (mdata && mdata->loading)
+  {
+    load_stop(m);
+    nm_db_release(m);
+  }
+  if (mdata)
+    mdata->load_changed = false;
+
   return MX_STATUS_OK;
 }
 
@@ -2433,11 +3006,17 @@ static int nm_tags_commit(struct Mailbox *m, struct Email *e, const char *buf)
 
   mutt_debug(LL_DEBUG1, "nm: tags modify: '%s'\n", buf);
 
+  /* when modifying many messages, commit them in batches */
+  const bool batch = nm_db_is_longrun(m) && (nm_db_trans_begin(m) >= 0);
+
   update_tags(msg, buf);
   update_email_flags(m, e, buf);
   update_email_tags(e, msg);
   mutt_set_header_color(m, e);
 
+  if (batch)
+    nm_db_trans_step(m);
+
   rc = 0;
   e->changed = true;
 done:
@@ -60,14 +60,19 @@ struct Mailbox;
 extern const char NmUrlProtocol[];
 extern const int NmUrlProtocolLen;
 
-notmuch_database_t *nm_db_do_open     (const char *filename, bool writable, bool verbose);
-void                nm_db_free        (notmuch_database_t *db);
-const char *        nm_db_get_filename(struct Mailbox *m);
-int                 nm_db_get_mtime   (struct Mailbox *m, time_t *mtime);
-notmuch_database_t *nm_db_get         (struct Mailbox *m, bool writable);
-bool                nm_db_is_longrun  (struct Mailbox *m);
-int                 nm_db_release     (struct Mailbox *m);
-int                 nm_db_trans_begin (struct Mailbox *m);
-int                 nm_db_trans_end   (struct Mailbox *m);
+notmuch_database_t *nm_db_do_open        (const char *filename, bool writable, bool verbose);
+void                nm_db_free           (notmuch_database_t *db);
+const char *        nm_db_get_filename   (struct Mailbox *m);
+int                 nm_db_get_file_mtime (const char *db_filename, time_t *mtime);
+int                 nm_db_get_mtime      (struct Mailbox *m, time_t *mtime);
+notmuch_database_t *nm_db_get            (struct Mailbox *m, bool writable);
+bool                nm_db_is_longrun     (struct Mailbox *m);
+int                 nm_db_release        (struct Mailbox *m);
+int                 nm_db_trans_begin    (struct Mailbox *m);
+int                 nm_db_trans_end      (struct Mailbox *m);
+bool                nm_db_trans_step     (struct Mailbox *m);
+
+void                nm_load_continue     (struct Mailbox *m);
+void                nm_load_suspend      (struct Mailbox *m);
 
 #endif /* MUTT_NOTMUCH_PRIVATE_H */
@@ -54,6 +54,7 @@
 #include "display.h"
 #include "functions.h"
 #include "muttlib.h"
+#include "mx.h"
 #include "private_data.h"
 #include "protos.h"
 #endif
@@ -1080,8 +1081,23 @@ static int op_view_attachments(struct IndexSharedData *shared,
 
   if (!assert_pager_mode(pview->mode == PAGER_MODE_EMAIL))
     return FR_NOT_IMPL;
-  dlg_attachment(NeoMutt->sub, shared->mailbox_view, shared->email,
-                 pview->pdata->fp, shared->attach_msg);
+
+  if (pview->pdata->partial)
+  {
+    /* The attachments are needed, so fetch the whole message */
+    struct Message *msg = mx_msg_open(shared->mailbox, shared->email);
+    if (!msg)
+      return FR_ERROR;
+    dlg_attachment(NeoMutt->sub, shared->mailbox_view, shared->email, msg->fp,
+                   shared->attach_msg);
+    mx_msg_close(shared->mailbox, &msg);
+  }
+  else
+  {
+    dlg_attachment(NeoMutt->sub, shared->mailbox_view, shared->email,
+                   pview->pdata->fp, shared->attach_msg);
+  }
+
   if (shared->email->attach_del)
     shared->mailbox->changed = true;
   pager_queue_redraw(priv, PAGER_REDRAW_PAGER);
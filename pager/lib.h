@@ -163,6 +163,7 @@ struct PagerData
   FILE             *fp;     ///< Source stream
   struct AttachCtx *actx;   ///< Attachment information
   const char       *fname;  ///< Name of the file to read
+  bool              partial; ///< Source stream is missing large attachments
 };
 
 /**
@@ -303,7 +303,7 @@ int external_pager(struct MailboxView *mv, struct Email *e, const char *command)
     return -1;
 
   struct Mailbox *m = mv->mailbox;
-  struct Message *msg = mx_msg_open(m, e);
+  struct Message *msg = mx_msg_open_partial(m, e);
   if (!msg)
     return -1;
 
@@ -457,7 +457,7 @@ int mutt_display_message(struct MuttWindow *win_index, struct IndexSharedData *s
   int rc = PAGER_LOOP_QUIT;
   do
   {
-    msg = mx_msg_open(shared->mailbox, shared->email);
+    msg = mx_msg_open_partial(shared->mailbox, shared->email);
     if (!msg)
       break;
 
@@ -478,6 +478,7 @@ int mutt_display_message(struct MuttWindow *win_index, struct IndexSharedData *s
 
     pdata.fp = msg->fp;
     pdata.fname = buf_string(tempfile);
+    pdata.partial = msg->partial;
 
     pview.mode = PAGER_MODE_EMAIL;
     pview.banner = NULL;
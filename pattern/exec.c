@@ -773,16 +773,23 @@ static int msg_search_sendmode(struct Email *e, struct Pattern *pat)
 
 /**
  * pattern_needs_msg - Check whether a pattern needs a full message
- * @param m Mailbox
+ * @param m   Mailbox
+ * @param e   Email
  * @param pat Pattern
  * @retval true The pattern needs a full message
  * @retval false The pattern does not need a full message
  */
-static bool pattern_needs_msg(const struct Mailbox *m, const struct Pattern *pat)
+static bool pattern_needs_msg(const struct Mailbox *m, const struct Email *e,
+                              const struct Pattern *pat)
 {
-  if ((pat->op == MUTT_PAT_MIMETYPE) || (pat->op == MUTT_PAT_MIMEATTACH))
+  if (pat->op == MUTT_PAT_MIMEATTACH)
   {
-    return true;
+    return !(e->attach_valid || email_structure_known(e));
+  }
+
+  if (pat->op == MUTT_PAT_MIMETYPE)
+  {
+    return !email_structure_known(e);
   }
 
   if ((pat->op == MUTT_PAT_WHOLE_MSG) || (pat->op == MUTT_PAT_BODY) || (pat->op == MUTT_PAT_HEADER))
@@ -795,7 +802,7 @@ static bool pattern_needs_msg(const struct Mailbox *m, const struct Pattern *pat
     struct Pattern *p = NULL;
     SLIST_FOREACH(p, pat->child, entries)
     {
-      if (pattern_needs_msg(m, p))
+      if (pattern_needs_msg(m, e, p))
       {
         return true;
       }
@@ -1095,14 +1102,14 @@ static bool pattern_exec(struct Pattern *pat, PatternExecFlags flags,
       if (!m)
         return false;
       {
-        int count = mutt_count_body_parts(m, e, msg->fp);
+        int count = mutt_count_body_parts(m, e, msg ? msg->fp : NULL);
         return pat->pat_not ^ (count >= pat->min &&
                                (pat->max == MUTT_MAXRANGE || count <= pat->max));
       }
     case MUTT_PAT_MIMETYPE:
       if (!m)
         return false;
-      return pat->pat_not ^ match_mime_content_type(pat, e, msg->fp);
+      return pat->pat_not ^ match_mime_content_type(pat, e, msg ? msg->fp : NULL);
     case MUTT_PAT_UNREFERENCED:
       return pat->pat_not ^ (e->thread && !e->thread->child);
     case MUTT_PAT_BROKEN:
@@ -1133,7 +1140,7 @@ static bool pattern_exec(struct Pattern *pat, PatternExecFlags flags,
 bool mutt_pattern_exec(struct Pattern *pat, PatternExecFlags flags,
                        struct Mailbox *m, struct Email *e, struct PatternCache *cache)
 {
-  const bool needs_msg = pattern_needs_msg(m, pat);
+  const bool needs_msg = pattern_needs_msg(m, e, pat);
   struct Message *msg = needs_msg ? mx_msg_open(m, e) : NULL;
   if (needs_msg && !msg)
   {
@@ -45,9 +45,11 @@ struct PopAccountData
   unsigned int cmd_uidl : 2; ///< optional command UIDL
   unsigned int cmd_top  : 2; ///< optional command TOP
   bool resp_codes       : 1; ///< server supports extended response codes
+  bool cmd_pipelining   : 1; ///< server supports PIPELINING (RFC2449)
   bool expire           : 1; ///< expire is greater than 0
   bool clear_cache      : 1;
   size_t size;
+  unsigned int msg_count; ///< Number of messages, from STAT
   time_t check_time;
   time_t login_delay; ///< minimal login delay  capability
   struct Buffer auth_list; ///< list of auth mechanisms
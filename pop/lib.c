@@ -169,6 +169,10 @@ static int fetch_capa(const char *line, void *data)
   {
     adata->cmd_top = 1;
   }
+  else if (mutt_istr_startswith(line, "PIPELINING"))
+  {
+    adata->cmd_pipelining = true;
+  }
 
   return 0;
 }
@@ -216,6 +220,7 @@ static int pop_capabilities(struct PopAccountData *adata, int mode)
     adata->cmd_user = 0;
     adata->cmd_uidl = 0;
     adata->cmd_top = 0;
+    adata->cmd_pipelining = false;
     adata->resp_codes = false;
     adata->expire = true;
     adata->login_delay = 0;
@@ -410,6 +415,7 @@ int pop_open_connection(struct PopAccountData *adata)
   unsigned int n = 0, size = 0;
   sscanf(buf, "+OK %u %u", &n, &size);
   adata->size = size;
+  adata->msg_count = n;
   return 0;
 
 err_conn:
@@ -454,33 +460,16 @@ void pop_logout(struct Mailbox *m)
 }
 
 /**
- * pop_query_d - Send data from buffer and receive answer to the same buffer
+ * pop_read_status - Read the status line of a response
  * @param adata  POP Account data
- * @param buf    Buffer to send/store data
+ * @param buf    Buffer for the response
  * @param buflen Buffer length
- * @param msg    Progress message
  * @retval  0 Successful
  * @retval -1 Connection lost
  * @retval -2 Invalid command or execution error
  */
-int pop_query_d(struct PopAccountData *adata, char *buf, size_t buflen, char *msg)
+static int pop_read_status(struct PopAccountData *adata, char *buf, size_t buflen)
 {
-  if (adata->status != POP_CONNECTED)
-    return -1;
-
-  /* print msg instead of real command */
-  if (msg)
-  {
-    mutt_debug(MUTT_SOCK_LOG_CMD, "> %s", msg);
-  }
-
-  mutt_socket_send_d(adata->conn, buf, MUTT_SOCK_LOG_FULL);
-
-  char *c = strpbrk(buf, " \r\n");
-  if (c)
-    *c = '\0';
-  snprintf(adata->err_msg, sizeof(adata->err_msg), "%s: ", buf);
-
   if (mutt_socket_readln_d(buf, buflen, adata->conn, MUTT_SOCK_LOG_FULL) < 0)
   {
     adata->status = POP_DISCONNECTED;
@@ -494,31 +483,24 @@ int pop_query_d(struct PopAccountData *adata, char *buf, size_t buflen, char *ms
 }
 
 /**
- * pop_fetch_data - Read Headers with callback function
+ * pop_read_multiline - Read the body of a multi-line response
  * @param adata    POP Account data
- * @param query    POP query to send to server
  * @param progress Progress bar
- * @param callback Function called for each header read
+ * @param callback Function called for each line, may be NULL
  * @param data     Data to pass to the callback
  * @retval  0 Successful
  * @retval -1 Connection lost
- * @retval -2 Invalid command or execution error
  * @retval -3 Error in callback(*line, *data)
  *
- * This function calls  callback(*line, *data)  for each received line,
- * callback(NULL, *data)  if  rewind(*data)  needs, exits when fail or done.
+ * The lines are read up to the terminating ".", even if the callback fails.
  */
-int pop_fetch_data(struct PopAccountData *adata, const char *query,
-                   struct Progress *progress, pop_fetch_t callback, void *data)
+static int pop_read_multiline(struct PopAccountData *adata, struct Progress *progress,
+                              pop_fetch_t callback, void *data)
 {
   char buf[1024] = { 0 };
   long pos = 0;
   size_t lenbuf = 0;
-
-  mutt_str_copy(buf, query, sizeof(buf));
-  int rc = pop_query(adata, buf, sizeof(buf));
-  if (rc < 0)
-    return rc;
+  int rc = 0;
 
   char *inbuf = mutt_mem_malloc(sizeof(buf));
 
@@ -551,7 +533,7 @@ int pop_fetch_data(struct PopAccountData *adata, const char *query,
     else
     {
       progress_update(progress, pos, -1);
-      if ((rc == 0) && (callback(inbuf, data) < 0))
+      if ((rc == 0) && callback && (callback(inbuf, data) < 0))
         rc = -3;
       lenbuf = 0;
     }
@@ -563,6 +545,137 @@ int pop_fetch_data(struct PopAccountData *adata, const char *query,
   return rc;
 }
 
+/**
+ * pop_query_d - Send data from buffer and receive answer to the same buffer
+ * @param adata  POP Account data
+ * @param buf    Buffer to send/store data
+ * @param buflen Buffer length
+ * @param msg    Progress message
+ * @retval  0 Successful
+ * @retval -1 Connection lost
+ * @retval -2 Invalid command or execution error
+ */
+int pop_query_d(struct PopAccountData *adata, char *buf, size_t buflen, char *msg)
+{
+  if (adata->status != POP_CONNECTED)
+    return -1;
+
+  /* print msg instead of real command */
+  if (msg)
+  {
+    mutt_debug(MUTT_SOCK_LOG_CMD, "> %s", msg);
+  }
+
+  mutt_socket_send_d(adata->conn, buf, MUTT_SOCK_LOG_FULL);
+
+  char *c = strpbrk(buf, " \r\n");
+  if (c)
+    *c = '\0';
+  snprintf(adata->err_msg, sizeof(adata->err_msg), "%s: ", buf);
+
+  return pop_read_status(adata, buf, buflen);
+}
+
+/**
+ * pop_fetch_data - Read Headers with callback function
+ * @param adata    POP Account data
+ * @param query    POP query to send to server
+ * @param progress Progress bar
+ * @param callback Function called for each header read
+ * @param data     Data to pass to the callback
+ * @retval  0 Successful
+ * @retval -1 Connection lost
+ * @retval -2 Invalid command or execution error
+ * @retval -3 Error in callback(*line, *data)
+ *
+ * This function calls  callback(*line, *data)  for each received line,
+ * callback(NULL, *data)  if  rewind(*data)  needs, exits when fail or done.
+ */
+int pop_fetch_data(struct PopAccountData *adata, const char *query,
+                   struct Progress *progress, pop_fetch_t callback, void *data)
+{
+  char buf[1024] = { 0 };
+
+  mutt_str_copy(buf, query, sizeof(buf));
+  int rc = pop_query(adata, buf, sizeof(buf));
+  if (rc < 0)
+    return rc;
+
+  return pop_read_multiline(adata, progress, callback, data);
+}
+
+/**
+ * pop_pipeline - Send a series of commands, without waiting if possible
+ * @param adata     POP Account data
+ * @param count     Number of commands
+ * @param multiline true if the responses are multi-line, e.g. TOP, RETR
+ * @param cmd_cb    Function to create each command
+ * @param line_cb   Function called for each line of a multi-line response
+ * @param done_cb   Function called at the end of each response
+ * @param data      Data to pass to the callbacks
+ * @retval  0 Successful
+ * @retval -1 Connection lost
+ * @retval -2 Stopped by done_cb
+ *
+ * If the server supports PIPELINING (RFC2449), keep up to #POP_PIPELINE_DEPTH
+ * commands in flight, and read the responses as they arrive.  Otherwise, send
+ * one command at a time.
+ *
+ * The responses are handled in order.  If done_cb() asks to stop, no more
+ * commands are sent, but the responses to those in flight are read.
+ */
+int pop_pipeline(struct PopAccountData *adata, int count, bool multiline,
+                 pop_pipeline_cmd_t cmd_cb, pop_fetch_t line_cb,
+                 pop_pipeline_done_t done_cb, void *data)
+{
+  if (adata->status != POP_CONNECTED)
+    return -1;
+
+  const int depth = adata->cmd_pipelining ? POP_PIPELINE_DEPTH : 1;
+  struct Buffer *cmd = buf_pool_get();
+  char buf[1024] = { 0 };
+  int sent = 0;
+  int received = 0;
+  int rc = 0;
+
+  while (received < ((rc == 0) ? count : sent))
+  {
+    while ((rc == 0) && (sent < count) && ((sent - received) < depth))
+    {
+      buf_reset(cmd);
+      cmd_cb(sent, cmd, data);
+      if (mutt_socket_send_d(adata->conn, buf_string(cmd), MUTT_SOCK_LOG_FULL) < 0)
+      {
+        adata->status = POP_DISCONNECTED;
+        rc = -1;
+        goto done;
+      }
+      sent++;
+    }
+
+    /* Prefix errors with the command name, e.g. "DELE: " */
+    snprintf(adata->err_msg, sizeof(adata->err_msg), "%.*s: ",
+             (int) strcspn(buf_string(cmd), " \r\n"), buf_string(cmd));
+
+    int rc_resp = pop_read_status(adata, buf, sizeof(buf));
+    if ((rc_resp == 0) && multiline)
+      rc_resp = pop_read_multiline(adata, NULL, (rc == 0) ? line_cb : NULL, data);
+    if (rc_resp == -1)
+    {
+      rc = -1;
+      break;
+    }
+
+    if ((rc == 0) && (done_cb(received, rc_resp, data) < 0))
+      rc = -2;
+    received++;
+  }
+
+done:
+  buf_pool_release(&cmd);
+  return rc;
+}
+
 /**
  * check_uidl - Parse UIDL response - Implements ::pop_fetch_t - @ingroup pop_fetch_api
  * @param line String containing UIDL
@@ -108,55 +108,91 @@ static int fetch_message(const char *line, void *data)
 }
 
 /**
- * pop_read_header - Read header
- * @param adata POP Account data
- * @param e     Email
- * @retval  0 Success
- * @retval -1 Connection lost
- * @retval -2 Invalid command or execution error
- * @retval -3 Error writing to tempfile
+ * struct PopHeaders - Headers being downloaded with pop_pipeline()
  */
-static int pop_read_header(struct PopAccountData *adata, struct Email *e)
+struct PopHeaders
 {
-  FILE *fp = mutt_file_mkstemp();
-  if (!fp)
-  {
-    mutt_perror(_("Can't create temporary file"));
-    return -3;
-  }
+  struct PopAccountData *adata;             ///< POP Account data
+  struct EmailArray emails;                 ///< Emails whose headers are wanted
+  ARRAY_HEAD(PopSizeArray, size_t) sizes;   ///< Message sizes from LIST, by message number
+  FILE *fp;                                 ///< Temporary file for the current header
+  struct Progress *progress;                ///< Progress bar
+  int rc;                                   ///< Result of the first failure
+};
 
-  int index = 0;
+/**
+ * fetch_list - Parse LIST response - Implements ::pop_fetch_t - @ingroup pop_fetch_api
+ * @param line String containing the message number and size
+ * @param data Headers being downloaded
+ * @retval 0 (always)
+ */
+static int fetch_list(const char *line, void *data)
+{
+  struct PopHeaders *ph = data;
+  unsigned int index = 0;
   size_t length = 0;
-  char buf[1024] = { 0 };
 
-  struct PopEmailData *edata = pop_edata_get(e);
+  if (sscanf(line, "%u %zu", &index, &length) != 2)
+    return 0;
 
-  snprintf(buf, sizeof(buf), "LIST %d\r\n", edata->refno);
-  int rc = pop_query(adata, buf, sizeof(buf));
-  if (rc == 0)
+  /* ignore bogus message numbers, they'd grow the array */
+  if ((index == 0) || (index > ph->adata->msg_count))
   {
-    sscanf(buf, "+OK %d %zu", &index, &length);
+    mutt_debug(LL_DEBUG1, "bogus LIST response: %s\n", line);
+    return 0;
+  }
+
+  ARRAY_SET(&ph->sizes, index - 1, length);
+
+  return 0;
+}
+
+/**
+ * top_cmd - Create a TOP command - Implements ::pop_pipeline_cmd_t - @ingroup pop_pipeline_api
+ */
+static void top_cmd(int num, struct Buffer *cmd, void *data)
+{
+  struct PopHeaders *ph = data;
+  struct Email **ep = ARRAY_GET(&ph->emails, num);
+
+  buf_printf(cmd, "TOP %d 0\r\n", pop_edata_get(*ep)->refno);
+}
+
+/**
+ * top_line - Save a header line - Implements ::pop_fetch_t - @ingroup pop_fetch_api
+ */
+static int top_line(const char *line, void *data)
+{
+  struct PopHeaders *ph = data;
+  return fetch_message(line, ph->fp);
+}
 
-    snprintf(buf, sizeof(buf), "TOP %d 0\r\n", edata->refno);
-    rc = pop_fetch_data(adata, buf, NULL, fetch_message, fp);
+/**
+ * top_done - Parse a downloaded header - Implements ::pop_pipeline_done_t - @ingroup pop_pipeline_api
+ */
+static int top_done(int num, int rc, void *data)
+{
+  struct PopHeaders *ph = data;
+  struct PopAccountData *adata = ph->adata;
+  struct Email *e = *ARRAY_GET(&ph->emails, num);
+  char buf[1024] = { 0 };
 
-    if (adata->cmd_top == 2)
+  if (adata->cmd_top == 2)
+  {
+    if (rc == 0)
     {
-      if (rc == 0)
-      {
-        adata->cmd_top = 1;
+      adata->cmd_top = 1;
 
-        mutt_debug(LL_DEBUG1, "set TOP capability\n");
-      }
+      mutt_debug(LL_DEBUG1, "set TOP capability\n");
+    }
 
-      if (rc == -2)
-      {
-        adata->cmd_top = 0;
+    if (rc == -2)
+    {
+      adata->cmd_top = 0;
 
-        mutt_debug(LL_DEBUG1, "unset TOP capability\n");
-        snprintf(adata->err_msg, sizeof(adata->err_msg), "%s",
-                 _("Command TOP is not supported by server"));
-      }
+      mutt_debug(LL_DEBUG1, "unset TOP capability\n");
+      snprintf(adata->err_msg, sizeof(adata->err_msg), "%s",
+               _("Command TOP is not supported by server"));
     }
   }
 
@@ -164,14 +200,16 @@ static int pop_read_header(struct PopAccountData *adata, struct Email *e)
   {
     case 0:
     {
-      rewind(fp);
-      e->env = mutt_rfc822_read_header(fp, e, false, false);
-      e->body->length = length - e->body->offset + 1;
-      rewind(fp);
-      while (!feof(fp))
+      size_t *length = ARRAY_GET(&ph->sizes, pop_edata_get(e)->refno - 1);
+
+      rewind(ph->fp);
+      e->env = mutt_rfc822_read_header(ph->fp, e, false, false);
+      e->body->length = (length ? *length : 0) - e->body->offset + 1;
+      rewind(ph->fp);
+      while (!feof(ph->fp))
       {
         e->body->length--;
-        if (!fgets(buf, sizeof(buf), fp))
+        if (!fgets(buf, sizeof(buf), ph->fp))
           break;
       }
       break;
@@ -188,7 +226,59 @@ static int pop_read_header(struct PopAccountData *adata, struct Email *e)
     }
   }
 
-  mutt_file_fclose(&fp);
+  /* Empty the file for the next header */
+  rewind(ph->fp);
+  if ((rc == 0) && (ftruncate(fileno(ph->fp), 0) != 0))
+  {
+    mutt_error(_("Can't write header to temporary file"));
+    rc = -3;
+  }
+
+  progress_update(ph->progress, num + 1, -1);
+
+  if (rc != 0)
+  {
+    ph->rc = rc;
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * pop_read_headers - Read the headers of some Emails
+ * @param adata POP Account data
+ * @param ph    Emails whose headers are wanted
+ * @retval  0 Success
+ * @retval -1 Connection lost
+ * @retval -2 Invalid command or execution error
+ * @retval -3 Error writing to tempfile
+ *
+ * One LIST gets the sizes of all the messages.  Then the headers are fetched
+ * with `TOP n 0`, pipelined if the server allows it.
+ */
+static int pop_read_headers(struct PopAccountData *adata, struct PopHeaders *ph)
+{
+  ph->fp = mutt_file_mkstemp();
+  if (!ph->fp)
+  {
+    mutt_perror(_("Can't create temporary file"));
+    return -3;
+  }
+
+  int rc = pop_fetch_data(adata, "LIST\r\n", NULL, fetch_list, ph);
+  if (rc == -2)
+    mutt_error("%s", adata->err_msg);
+
+  if (rc == 0)
+  {
+    rc = pop_pipeline(adata, ARRAY_SIZE(&ph->emails), true, top_cmd, top_line,
+                      top_done, ph);
+    if (rc == -2)
+      rc = ph->rc;
+  }
+
+  mutt_file_fclose(&ph->fp);
+  ARRAY_FREE(&ph->sizes);
   return rc;
 }
 
@@ -327,7 +417,6 @@ static int pop_fetch_headers(struct Mailbox *m)
     return -1;
 
   struct PopAccountData *adata = pop_adata_get(m);
-  struct Progress *progress = NULL;
 
 #ifdef USE_HCACHE
   struct HeaderCache *hc = pop_hcache_open(adata, mailbox_path(m));
@@ -366,12 +455,6 @@ static int pop_fetch_headers(struct Mailbox *m)
     }
   }
 
-  if (m->verbose)
-  {
-    progress = progress_new(MUTT_PROGRESS_READ, new_count - old_count);
-    progress_set_message(progress, _("Fetching message headers..."));
-  }
-
   if (rc == 0)
   {
     int i, deleted;
@@ -391,12 +474,15 @@ static int pop_fetch_headers(struct Mailbox *m)
                  deleted);
     }
 
-    bool hcached = false;
+    struct PopHeaders ph = { 0 };
+    ph.adata = adata;
+    ARRAY_INIT(&ph.emails);
+    ARRAY_INIT(&ph.sizes);
+
     for (i = old_count; i < new_count; i++)
     {
-      progress_update(progress, i + 1 - old_count, -1);
-      struct PopEmailData *edata = pop_edata_get(m->emails[i]);
 #ifdef USE_HCACHE
+      struct PopEmailData *edata = pop_edata_get(m->emails[i]);
       struct HCacheEntry hce = hcache_fetch_email(hc, edata->uid, strlen(edata->uid), 0);
       if (hce.email)
       {
@@ -418,20 +504,44 @@ static int pop_fetch_headers(struct Mailbox *m)
         /* Reattach the private data */
         m->emails[i]->edata = edata;
         m->emails[i]->edata_free = pop_edata_free;
-        rc = 0;
-        hcached = true;
+        continue;
       }
-      else
 #endif
-          if ((rc = pop_read_header(adata, m->emails[i])) < 0)
-        break;
+      ARRAY_ADD(&ph.emails, m->emails[i]);
+    }
+
+    if (!ARRAY_EMPTY(&ph.emails))
+    {
+      if (m->verbose)
+      {
+        ph.progress = progress_new(MUTT_PROGRESS_READ, ARRAY_SIZE(&ph.emails));
+        progress_set_message(ph.progress, _("Fetching message headers..."));
+      }
+      rc = pop_read_headers(adata, &ph);
+      progress_free(&ph.progress);
+    }
+
+    struct Email **ep = NULL;
 #ifdef USE_HCACHE
-      else
+    if (rc == 0)
+    {
+      ARRAY_FOREACH(ep, &ph.emails)
       {
-        hcache_store_email(hc, edata->uid, strlen(edata->uid), m->emails[i], 0);
+        struct PopEmailData *edata = pop_edata_get(*ep);
+        hcache_store_email(hc, edata->uid, strlen(edata->uid), *ep, 0);
       }
+    }
 #endif
 
+    size_t next = 0;
+    for (i = old_count; (rc == 0) && (i < new_count); i++)
+    {
+      struct PopEmailData *edata = pop_edata_get(m->emails[i]);
+      ep = ARRAY_GET(&ph.emails, next);
+      const bool hcached = !ep || (*ep != m->emails[i]);
+      if (!hcached)
+        next++;
+
       /* faked support for flags works like this:
        * - if 'hcached' is true, we have the message in our hcache:
        *        - if we also have a body: read
@@ -461,8 +571,9 @@ static int pop_fetch_headers(struct Mailbox *m)
 
       m->msg_count++;
     }
+
+    ARRAY_FREE(&ph.emails);
   }
-  progress_free(&progress);
 
 #ifdef USE_HCACHE
   hcache_close(&hc);
@@ -507,6 +618,117 @@ static void pop_clear_cache(struct PopAccountData *adata)
   }
 }
 
+/**
+ * struct PopFetch - Messages being moved to the spool file by pop_fetch_mail()
+ */
+struct PopFetch
+{
+  struct PopAccountData *adata; ///< POP Account data
+  struct Mailbox *m_spool;      ///< Spool Mailbox
+  struct Message *msg;          ///< Message being written
+  const char *msgbuf;           ///< Progress message
+  int first;                    ///< Number of the first message on the server
+  int count;                    ///< Number of messages to fetch
+  int saved;                    ///< Number of messages saved so far
+  bool rset;                    ///< Something went wrong, don't delete anything
+};
+
+/**
+ * retr_cmd - Create a RETR command - Implements ::pop_pipeline_cmd_t - @ingroup pop_pipeline_api
+ */
+static void retr_cmd(int num, struct Buffer *cmd, void *data)
+{
+  struct PopFetch *pf = data;
+  buf_printf(cmd, "RETR %d\r\n", pf->first + num);
+}
+
+/**
+ * retr_line - Save a line of a message - Implements ::pop_fetch_t - @ingroup pop_fetch_api
+ */
+static int retr_line(const char *line, void *data)
+{
+  struct PopFetch *pf = data;
+
+  if (!pf->msg)
+  {
+    pf->msg = mx_msg_open_new(pf->m_spool, NULL, MUTT_ADD_FROM);
+    if (!pf->msg)
+      return -1;
+  }
+
+  return fetch_message(line, pf->msg->fp);
+}
+
+/**
+ * retr_done - Commit a message to the spool file - Implements ::pop_pipeline_done_t - @ingroup pop_pipeline_api
+ */
+static int retr_done(int num, int rc, void *data)
+{
+  struct PopFetch *pf = data;
+
+  if ((rc == 0) && !pf->msg)
+  {
+    pf->msg = mx_msg_open_new(pf->m_spool, NULL, MUTT_ADD_FROM);
+    if (!pf->msg)
+      rc = -3;
+  }
+
+  if (rc == -3)
+    pf->rset = true;
+
+  if ((rc == 0) && (mx_msg_commit(pf->m_spool, pf->msg) != 0))
+  {
+    pf->rset = true;
+    rc = -3;
+  }
+
+  if (pf->msg)
+    mx_msg_close(pf->m_spool, &pf->msg);
+
+  if (rc == -2)
+  {
+    mutt_error("%s", pf->adata->err_msg);
+    return -1;
+  }
+  if (rc == -3)
+  {
+    mutt_error(_("Error while writing mailbox"));
+    return -1;
+  }
+
+  pf->saved++;
+  /* L10N: The plural is picked by the second numerical argument, i.e.
+     the %d right before 'messages', i.e. the total number of messages. */
+  mutt_message(ngettext("%s [%d of %d message read]",
+                        "%s [%d of %d messages read]", pf->count),
+               pf->msgbuf, num + 1, pf->count);
+  return 0;
+}
+
+/**
+ * dele_saved_cmd - Create a DELE command - Implements ::pop_pipeline_cmd_t - @ingroup pop_pipeline_api
+ */
+static void dele_saved_cmd(int num, struct Buffer *cmd, void *data)
+{
+  struct PopFetch *pf = data;
+  buf_printf(cmd, "DELE %d\r\n", pf->first + num);
+}
+
+/**
+ * dele_saved_done - Check a DELE response - Implements ::pop_pipeline_done_t - @ingroup pop_pipeline_api
+ */
+static int dele_saved_done(int num, int rc, void *data)
+{
+  struct PopFetch *pf = data;
+
+  if (rc == -2)
+  {
+    mutt_error("%s", pf->adata->err_msg);
+    return -1;
+  }
+  return 0;
+}
+
 /**
  * pop_fetch_mail - Fetch messages and save them in $spool_file
  */
@@ -521,7 +743,7 @@ void pop_fetch_mail(void)
 
   char buf[1024] = { 0 };
   char msgbuf[128] = { 0 };
-  int last = 0, msgs, bytes, rset = 0, rc;
+  int last = 0, msgs, bytes, rc;
   struct ConnAccount cac = { { 0 } };
 
   char *p = mutt_mem_calloc(strlen(c_pop_host) + 7, sizeof(char));
@@ -607,64 +829,30 @@ void pop_fetch_mail(void)
            bytes);
   mutt_message("%s", msgbuf);
 
-  for (int i = last + 1; i <= msgs; i++)
-  {
-    struct Message *msg = mx_msg_open_new(m_spool, NULL, MUTT_ADD_FROM);
-    if (msg)
-    {
-      snprintf(buf, sizeof(buf), "RETR %d\r\n", i);
-      rc = pop_fetch_data(adata, buf, NULL, fetch_message, msg->fp);
-      if (rc == -3)
-        rset = 1;
-
-      if ((rc == 0) && (mx_msg_commit(m_spool, msg) != 0))
-      {
-        rset = 1;
-        rc = -3;
-      }
+  struct PopFetch pf = { 0 };
+  pf.adata = adata;
+  pf.m_spool = m_spool;
+  pf.msgbuf = msgbuf;
+  pf.first = last + 1;
+  pf.count = msgs - last;
 
-      mx_msg_close(m_spool, &msg);
-    }
-    else
-    {
-      rc = -3;
-    }
+  rc = pop_pipeline(adata, pf.count, true, retr_cmd, retr_line, retr_done, &pf);
 
-    if ((rc == 0) && (delanswer == MUTT_YES))
-    {
-      /* delete the message on the server */
-      snprintf(buf, sizeof(buf), "DELE %d\r\n", i);
-      rc = pop_query(adata, buf, sizeof(buf));
-    }
+  m_spool->append = old_append;
+  mx_mbox_close(m_spool);
 
-    if (rc == -1)
-    {
-      m_spool->append = old_append;
-      mx_mbox_close(m_spool);
-      goto fail;
-    }
-    if (rc == -2)
-    {
-      mutt_error("%s", adata->err_msg);
-      break;
-    }
-    if (rc == -3)
-    {
-      mutt_error(_("Error while writing mailbox"));
-      break;
-    }
+  if (rc == -1)
+    goto fail;
 
-    /* L10N: The plural is picked by the second numerical argument, i.e.
-       the %d right before 'messages', i.e. the total number of messages. */
-    mutt_message(ngettext("%s [%d of %d message read]",
-                          "%s [%d of %d messages read]", msgs - last),
-                 msgbuf, i - last, msgs - last);
+  /* delete the saved messages on the server */
+  if (!pf.rset && (pf.saved > 0) && (delanswer == MUTT_YES) &&
+      (pop_pipeline(adata, pf.saved, false, dele_saved_cmd, NULL,
+                    dele_saved_done, &pf) == -1))
+  {
+    goto fail;
   }
 
-  m_spool->append = old_append;
-  mx_mbox_close(m_spool);
-
-  if (rset)
+  if (pf.rset)
   {
     /* make sure no messages get deleted */
     mutt_str_copy(buf, "RSET\r\n", sizeof(buf));
@@ -852,6 +1040,47 @@ static enum MxStatus pop_mbox_check(struct Mailbox *m)
   return MX_STATUS_OK;
 }
 
+/**
+ * struct PopDelete - Emails being deleted by pop_mbox_sync()
+ */
+struct PopDelete
+{
+  struct PopAccountData *adata; ///< POP Account data
+  struct EmailArray emails;     ///< Emails to delete
+  struct HeaderCache *hc;       ///< Header cache
+  struct Progress *progress;    ///< Progress bar
+};
+
+/**
+ * dele_cmd - Create a DELE command - Implements ::pop_pipeline_cmd_t - @ingroup pop_pipeline_api
+ */
+static void dele_cmd(int num, struct Buffer *cmd, void *data)
+{
+  struct PopDelete *pd = data;
+  struct Email **ep = ARRAY_GET(&pd->emails, num);
+
+  buf_printf(cmd, "DELE %d\r\n", pop_edata_get(*ep)->refno);
+}
+
+/**
+ * dele_done - Drop a deleted Email from the caches - Implements ::pop_pipeline_done_t - @ingroup pop_pipeline_api
+ */
+static int dele_done(int num, int rc, void *data)
+{
+  struct PopDelete *pd = data;
+
+  if (rc != 0)
+    return -1;
+
+  struct PopEmailData *edata = pop_edata_get(*ARRAY_GET(&pd->emails, num));
+  mutt_bcache_del(pd->adata->bcache, cache_id(edata->uid));
+#ifdef USE_HCACHE
+  hcache_delete_email(pd->hc, edata->uid, strlen(edata->uid));
+#endif
+  progress_update(pd->progress, num + 1, -1);
+  return 0;
+}
+
 /**
  * pop_mbox_sync - Save changes to the Mailbox - Implements MxOps::mbox_sync() - @ingroup mx_mbox_sync
  *
@@ -859,17 +1088,14 @@ static enum MxStatus pop_mbox_check(struct Mailbox *m)
  */
 static enum MxStatus pop_mbox_sync(struct Mailbox *m)
 {
-  int i, j, rc = 0;
+  int rc = 0;
   char buf[1024] = { 0 };
   struct PopAccountData *adata = pop_adata_get(m);
-#ifdef USE_HCACHE
-  struct HeaderCache *hc = NULL;
-#endif
 
   adata->check_time = 0;
 
   int num_deleted = 0;
-  for (i = 0; i < m->msg_count; i++)
+  for (int i = 0; i < m->msg_count; i++)
   {
     if (m->emails[i]->deleted)
       num_deleted++;
@@ -880,46 +1106,40 @@ static enum MxStatus pop_mbox_sync(struct Mailbox *m)
     if (pop_reconnect(m) < 0)
       return MX_STATUS_ERROR;
 
+    struct PopDelete pd = { 0 };
+    pd.adata = adata;
+    ARRAY_INIT(&pd.emails);
 #ifdef USE_HCACHE
-    hc = pop_hcache_open(adata, mailbox_path(m));
+    pd.hc = pop_hcache_open(adata, mailbox_path(m));
 #endif
 
-    struct Progress *progress = NULL;
-    if (m->verbose)
-    {
-      progress = progress_new(MUTT_PROGRESS_WRITE, num_deleted);
-      progress_set_message(progress, _("Marking messages deleted..."));
-    }
-
-    for (i = 0, j = 0, rc = 0; (rc == 0) && (i < m->msg_count); i++)
+    for (int i = 0; i < m->msg_count; i++)
     {
       struct PopEmailData *edata = pop_edata_get(m->emails[i]);
       if (m->emails[i]->deleted && (edata->refno != -1))
-      {
-        j++;
-        progress_update(progress, j, -1);
-        snprintf(buf, sizeof(buf), "DELE %d\r\n", edata->refno);
-        rc = pop_query(adata, buf, sizeof(buf));
-        if (rc == 0)
-        {
-          mutt_bcache_del(adata->bcache, cache_id(edata->uid));
-#ifdef USE_HCACHE
-          hcache_delete_email(hc, edata->uid, strlen(edata->uid));
-#endif
-        }
-      }
+        ARRAY_ADD(&pd.emails, m->emails[i]);
 
 #ifdef USE_HCACHE
       if (m->emails[i]->changed)
       {
-        hcache_store_email(hc, edata->uid, strlen(edata->uid), m->emails[i], 0);
+        hcache_store_email(pd.hc, edata->uid, strlen(edata->uid), m->emails[i], 0);
       }
 #endif
     }
-    progress_free(&progress);
 
+    if (m->verbose)
+    {
+      pd.progress = progress_new(MUTT_PROGRESS_WRITE, num_deleted);
+      progress_set_message(pd.progress, _("Marking messages deleted..."));
+    }
+
+    rc = pop_pipeline(adata, ARRAY_SIZE(&pd.emails), false, dele_cmd, NULL,
+                      dele_done, &pd);
+
+    progress_free(&pd.progress);
+    ARRAY_FREE(&pd.emails);
 #ifdef USE_HCACHE
-    hcache_close(&hc);
+    hcache_close(&pd.hc);
 #endif
 
     if (rc == 0)
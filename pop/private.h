@@ -41,6 +41,9 @@ struct Progress;
 /* maximal length of the server response (RFC1939) */
 #define POP_CMD_RESPONSE 512
 
+/* number of commands in flight with PIPELINING (RFC2449) */
+#define POP_PIPELINE_DEPTH 32
+
 /**
  * enum PopStatus - POP server responses
  */
@@ -107,6 +110,34 @@ void pop_apop_timestamp(struct PopAccountData *adata, char *buf);
  */
 typedef int (*pop_fetch_t)(const char *str, void *data);
 
+/**
+ * @defgroup pop_pipeline_api POP Pipeline API
+ *
+ * Callbacks for sending a series of commands with pop_pipeline()
+ */
+
+/**
+ * @ingroup pop_pipeline_api
+ *
+ * pop_pipeline_cmd_t - Create a command
+ * @param[in]  num  Number of the command, counting from 0
+ * @param[out] cmd  Buffer for the command, including "\r\n"
+ * @param[in]  data Private data passed to pop_pipeline()
+ */
+typedef void (*pop_pipeline_cmd_t)(int num, struct Buffer *cmd, void *data);
+
+/**
+ * @ingroup pop_pipeline_api
+ *
+ * pop_pipeline_done_t - Handle the end of a response
+ * @param num  Number of the command, counting from 0
+ * @param rc   Result, 0 Success, -2 Server error, -3 Error in the line callback
+ * @param data Private data passed to pop_pipeline()
+ * @retval  0 Continue
+ * @retval -1 Stop, don't send any more commands
+ */
+typedef int (*pop_pipeline_done_t)(int num, int rc, void *data);
+
 /* pop_lib.c */
 #define pop_query(adata, buf, buflen) pop_query_d(adata, buf, buflen, NULL)
 int pop_parse_path(const char *path, struct ConnAccount *acct);
@@ -115,6 +146,9 @@ int pop_open_connection(struct PopAccountData *adata);
 int pop_query_d(struct PopAccountData *adata, char *buf, size_t buflen, char *msg);
 int pop_fetch_data(struct PopAccountData *adata, const char *query,
                    struct Progress *progress, pop_fetch_t callback, void *data);
+int pop_pipeline(struct PopAccountData *adata, int count, bool multiline,
+                 pop_pipeline_cmd_t cmd_cb, pop_fetch_t line_cb,
+                 pop_pipeline_done_t done_cb, void *data);
 int pop_reconnect(struct Mailbox *m);
 void pop_logout(struct Mailbox *m);
 const char *pop_get_field(enum ConnAccountField field, void *gf_data);
@@ -43,12 +43,14 @@ struct ProgressWindowData
   size_t size_inc;              ///< Size increment
   size_t time_inc;              ///< Time increment
   bool   is_bytes;              ///< true if measuring bytes
+  uint64_t start_time;          ///< Time the transfer started
 
   // Current display
   size_t   display_pos;         ///< Displayed position
   int      display_percent;     ///< Displayed percentage complete
   uint64_t display_time;        ///< Time of last display
   char     pretty_pos[24];      ///< Pretty string for the position
+  char     pretty_rate[24];     ///< Pretty string for the throughput
 
   // Updates waiting for display
   size_t   update_pos;          ///< Updated position
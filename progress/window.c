@@ -142,8 +142,18 @@ static int progress_window_recalc(struct MuttWindow *win)
   wdata->display_time = wdata->update_time;
 
   if (wdata->is_bytes)
+  {
     mutt_str_pretty_size(wdata->pretty_pos, sizeof(wdata->pretty_pos), wdata->display_pos);
 
+    wdata->pretty_rate[0] = '\0';
+    if (wdata->display_time > wdata->start_time)
+    {
+      const uint64_t elapsed = wdata->display_time - wdata->start_time;
+      mutt_str_pretty_size(wdata->pretty_rate, sizeof(wdata->pretty_rate),
+                           wdata->display_pos * 1000 / elapsed);
+    }
+  }
+
   if ((wdata->update_percent < 0) && (wdata->size != 0))
     wdata->display_percent = 100 * wdata->display_pos / wdata->size;
   else
@@ -202,7 +212,17 @@ static int progress_window_repaint(struct MuttWindow *win)
   }
   else
   {
-    if (wdata->is_bytes)
+    if (wdata->is_bytes && (wdata->pretty_rate[0] != '\0'))
+    {
+      /* L10N: Progress bar: `%s` loading text, `%s/%s` position/size,
+         `%d` is the number, `%%` is the percent symbol,
+         `%s/s` is the throughput, e.g. 1.2M/s.
+         `%d` and `%%` may be reordered, or space inserted, if you wish. */
+      message_bar(wdata->win, wdata->display_percent, _("%s %s/%s (%d%%) %s/s"),
+                  wdata->msg, wdata->pretty_pos, wdata->pretty_size,
+                  wdata->display_percent, wdata->pretty_rate);
+    }
+    else if (wdata->is_bytes)
     {
       /* L10N: Progress bar: `%s` loading text, `%s/%s` position/size,
          `%d` is the number, `%%` is the percent symbol.
@@ -327,6 +347,7 @@ struct MuttWindow *progress_window_new(size_t size, size_t size_inc,
   wdata->size_inc = size_inc;
   wdata->time_inc = time_inc;
   wdata->is_bytes = is_bytes;
+  wdata->start_time = mutt_date_now_ms();
 
   if (is_bytes)
     mutt_str_pretty_size(wdata->pretty_size, sizeof(wdata->pretty_size), size);
@@ -371,5 +392,6 @@ void progress_window_set_size(struct MuttWindow *win, size_t size)
   wdata->display_pos = 0;
   wdata->display_percent = 0;
   wdata->display_time = 0;
+  wdata->start_time = mutt_date_now_ms();
   win->actions |= WA_RECALC;
 }
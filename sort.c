@@ -40,6 +40,7 @@
 #include "core/lib.h"
 #include "alias/lib.h"
 #include "sort.h"
+#include "imap/lib.h"
 #include "nntp/lib.h"
 #include "globals.h"
 #include "mutt_logging.h"
@@ -405,8 +406,11 @@ void mutt_sort_headers(struct MailboxView *mv, bool init)
     cmp.type = mx_type(m);
     cmp.sort = cs_subset_sort(NeoMutt->sub, "sort");
     cmp.sort_aux = cs_subset_sort(NeoMutt->sub, "sort_aux");
-    mutt_qsort_r((void *) m->emails, m->msg_count, sizeof(struct Email *),
-                 compare_email_shim, &cmp);
+    if (!imap_sort(m, cmp.sort, cmp.sort_aux))
+    {
+      mutt_qsort_r((void *) m->emails, m->msg_count, sizeof(struct Email *),
+                   compare_email_shim, &cmp);
+    }
   }
 
   /* adjust the virtual message numbers */
@@ -0,0 +1,54 @@
+/**
+ * @file
+ * Test code for email_structure_known()
+ *
+ * @authors
+ * Copyright (C) 2026 Richard Russon <rich@flatcap.org>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include <stddef.h>
+#include <stdbool.h>
+#include "email/lib.h"
+
+void test_email_structure_known(void)
+{
+  // bool email_structure_known(const struct Email *e);
+
+  {
+    TEST_CHECK(!email_structure_known(NULL));
+  }
+
+  {
+    struct Email *e = email_new();
+    TEST_CHECK(!email_structure_known(e));
+
+    e->body = mutt_body_new();
+    e->body->type = TYPE_TEXT;
+    TEST_CHECK(email_structure_known(e));
+
+    e->body->type = TYPE_MULTIPART;
+    TEST_CHECK(!email_structure_known(e));
+
+    e->body->parts = mutt_body_new();
+    TEST_CHECK(email_structure_known(e));
+
+    email_free(&e);
+  }
+}
@@ -0,0 +1,248 @@
+#!/usr/bin/env python3
+#
+# Benchmark NeoMutt's IMAP code against the scripted server
+#
+#   This program is free software: you can redistribute it and/or modify it
+#   under the terms of the GNU General Public License as published by the Free
+#   Software Foundation, either version 2 of the License, or (at your option)
+#   any later version.
+#
+#   This program is distributed in the hope that it will be useful, but WITHOUT
+#   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+#   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+#   more details.
+#
+#   You should have received a copy of the GNU General Public License along
+#   with this program.  If not, see <http://www.gnu.org/licenses/>.
+'''Benchmark NeoMutt's IMAP code against the scripted server
+
+Start imap_server.py with the chosen mailbox size and network conditions,
+then run NeoMutt on a pseudo-terminal with a scripted set of keys:
+  open the INBOX, display the first message, flag every message, sync, quit.
+
+The timings come from the server's command log, so each stage is measured
+from the first command NeoMutt sends for it to the first command of the next
+stage.  That includes NeoMutt's own processing, but not its screen updates
+at startup.
+
+  login  Connect, CAPABILITY and LOGIN
+  open   SELECT and the header download
+  body   Fetch and display the first message
+  sync   STOREs for the flag changes, until NeoMutt exits
+
+With --runs, NeoMutt is run several times against the same server.  If the
+header cache is enabled (the default) the first run is "cold", and the rest
+are "warm".
+
+Example:
+  ./imap_bench.py --neomutt ../../neomutt --messages 20000 --latency 50
+'''
+
+import argparse
+import fcntl
+import json
+import os
+import re
+import select
+import shutil
+import signal
+import struct
+import subprocess
+import sys
+import tempfile
+import termios
+import time
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+STAGES = ['login', 'open', 'body', 'sync']
+
+KEYS = ('<display-message><exit>'
+        '<tag-pattern>~A<enter><tag-prefix><flag-message>'
+        '<sync-mailbox><quit>')
+
+
+def start_server(opts, logfile):
+    '''Start imap_server.py and wait until it's listening'''
+    cmd = [sys.executable, os.path.join(HERE, 'imap_server.py'), '--port', '0',
+           '--messages', str(opts.messages), '--body-size', str(opts.body_size),
+           '--latency', str(opts.latency), '--bandwidth', str(opts.bandwidth),
+           '--log', logfile]
+    for cap in opts.disable:
+        cmd += ['--disable', cap]
+    proc = subprocess.Popen(cmd, stdout=subprocess.PIPE, text=True)
+    line = proc.stdout.readline()
+    # "Listening on 127.0.0.1:PORT, N messages"
+    port = int(line.split(':')[1].split(',')[0])
+    return proc, port
+
+
+def write_muttrc(path, opts, port, hcache_dir):
+    '''Create a config that opens the server's INBOX and runs the keys'''
+    lines = [
+        'set folder="imap://bench@127.0.0.1:%d/"' % port,
+        'set imap_pass="bench"',
+        'set spool_file="+INBOX"',
+        'set record="" postponed=""',
+        'set ssl_starttls=no ssl_force_tls=no',
+        'set header_cache="%s"' % (hcache_dir if hcache_dir else ''),
+        'set imap_condstore=%s' % ('yes' if opts.condstore else 'no'),
+        'set imap_qresync=%s' % ('yes' if opts.qresync else 'no'),
+        'set imap_deflate=%s' % ('yes' if opts.deflate else 'no'),
+        'set quit=yes wait_key=no sleep_time=0 mail_check_stats=no',
+        'set imap_pipeline_depth=%d' % opts.pipeline_depth,
+    ]
+    lines += ['set %s' % s for s in opts.set]
+    lines.append('push "%s"' % KEYS)
+    with open(path, 'w') as fp:
+        fp.write('\n'.join(lines) + '\n')
+
+
+def run_neomutt(opts, muttrc, home):
+    '''Run NeoMutt on a pseudo-terminal until it exits'''
+    master, slave = os.openpty()
+    fcntl.ioctl(slave, termios.TIOCSWINSZ, struct.pack('HHHH', 50, 120, 0, 0))
+    env = dict(os.environ, TERM='xterm', HOME=home, LC_ALL='C.UTF-8')
+    start = time.monotonic()
+    proc = subprocess.Popen([opts.neomutt, '-n', '-F', muttrc], stdin=slave,
+                            stdout=slave, stderr=slave, env=env,
+                            start_new_session=True)
+    os.close(slave)
+
+    while proc.poll() is None:
+        if time.monotonic() - start > opts.timeout:
+            proc.send_signal(signal.SIGTERM)
+            proc.wait()
+            raise RuntimeError('NeoMutt did not finish within %ds' % opts.timeout)
+        ready, _, _ = select.select([master], [], [], 0.1)
+        if ready:
+            try:
+                os.read(master, 65536)
+            except OSError:
+                break
+    proc.wait()
+    os.close(master)
+    return time.monotonic() - start
+
+
+def is_body_fetch(event):
+    '''Is this the FETCH of a message's body?'''
+    return ('FETCH' in event['command']) and \
+        bool(re.search(r'BODY(\.PEEK)?\[(TEXT)?\]|\bRFC822(\.TEXT)?\b(?!\.)', event['text'], re.I))
+
+
+def analyse(events):
+    '''Split a session's commands into stages, see the module docstring'''
+    events = sorted(events, key=lambda e: e['arrived'])
+    starts = {}
+    for ev in events:
+        cmd = ev['command']
+        if 'login' not in starts:
+            starts['login'] = ev['arrived']
+        if (cmd in ('SELECT', 'EXAMINE')) and ('open' not in starts):
+            starts['open'] = ev['arrived']
+        if is_body_fetch(ev) and ('body' not in starts):
+            starts['body'] = ev['arrived']
+        if cmd.endswith('STORE') and ('sync' not in starts):
+            starts['sync'] = ev['arrived']
+    starts['end'] = max(e['t'] for e in events)
+
+    result = {}
+    names = [s for s in STAGES if s in starts] + ['end']
+    for stage, following in zip(names, names[1:]):
+        begin, end = starts[stage], starts[following]
+        inside = [e for e in events if begin <= e['arrived'] < end]
+        result[stage] = {
+            'seconds': end - begin,
+            'commands': len(inside),
+            'bytes_in': sum(e['bytes_in'] for e in inside),
+            'bytes_out': sum(e['bytes_out'] for e in inside),
+        }
+    return result
+
+
+def read_log(path, offset):
+    '''Read the server log, from a byte offset'''
+    with open(path) as fp:
+        fp.seek(offset)
+        events = [json.loads(line) for line in fp if line.strip()]
+        return events, fp.tell()
+
+
+def print_table(runs):
+    '''Print the timings of each run'''
+    print('%-6s %-6s %10s %9s %12s %12s' % ('run', 'stage', 'seconds', 'commands',
+                                           'bytes in', 'bytes out'))
+    for num, (label, wall, stages) in enumerate(runs, 1):
+        for stage in STAGES:
+            if stage not in stages:
+                continue
+            s = stages[stage]
+            print('%-6s %-6s %10.3f %9d %12d %12d' % ('%d/%s' % (num, label), stage,
+                                                     s['seconds'], s['commands'],
+                                                     s['bytes_in'], s['bytes_out']))
+        print('%-6s %-6s %10.3f' % ('%d/%s' % (num, label), 'wall', wall))
+
+
+def main():
+    '''Parse the options and run the benchmark'''
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--neomutt', default='./neomutt', help='NeoMutt binary')
+    parser.add_argument('--messages', type=int, default=1000, help='messages in the INBOX')
+    parser.add_argument('--body-size', type=int, default=2048, help='bytes of body per message')
+    parser.add_argument('--latency', type=float, default=0, help='round-trip time, in ms')
+    parser.add_argument('--bandwidth', type=float, default=0, help='bytes/second, 0 for unlimited')
+    parser.add_argument('--disable', action='append', default=[], metavar='CAP',
+                        help='capability for the server to hide (repeatable)')
+    parser.add_argument('--runs', type=int, default=2, help='number of NeoMutt runs')
+    parser.add_argument('--no-hcache', dest='hcache', action='store_false',
+                        help="don't use a header cache")
+    parser.add_argument('--no-condstore', dest='condstore', action='store_false')
+    parser.add_argument('--no-qresync', dest='qresync', action='store_false')
+    parser.add_argument('--no-deflate', dest='deflate', action='store_false')
+    parser.add_argument('--pipeline-depth', type=int, default=15)
+    parser.add_argument('--set', action='append', default=[], metavar='VAR=VALUE',
+                        help='extra NeoMutt config (repeatable)')
+    parser.add_argument('--timeout', type=int, default=600, help='seconds to allow each run')
+    parser.add_argument('--json', action='store_true', help='print the results as JSON')
+    parser.add_argument('--keep', action='store_true', help="keep the temporary directory")
+    opts = parser.parse_args()
+
+    tmpdir = tempfile.mkdtemp(prefix='imap-bench-')
+    logfile = os.path.join(tmpdir, 'server.log')
+    muttrc = os.path.join(tmpdir, 'muttrc')
+    hcache_dir = os.path.join(tmpdir, 'hcache') if opts.hcache else None
+    if hcache_dir:
+        os.mkdir(hcache_dir)
+
+    server, port = start_server(opts, logfile)
+    runs = []
+    try:
+        write_muttrc(muttrc, opts, port, hcache_dir)
+        offset = 0
+        for num in range(opts.runs):
+            wall = run_neomutt(opts, muttrc, tmpdir)
+            time.sleep(0.2)
+            events, offset = read_log(logfile, offset)
+            if not events:
+                raise RuntimeError('NeoMutt sent no commands, see %s' % muttrc)
+            label = 'warm' if (hcache_dir and num > 0) else 'cold'
+            runs.append((label, wall, analyse(events)))
+    finally:
+        server.terminate()
+        server.wait()
+        if not opts.keep:
+            shutil.rmtree(tmpdir, ignore_errors=True)
+        else:
+            print('Files kept in %s' % tmpdir, file=sys.stderr)
+
+    if opts.json:
+        print(json.dumps([{'run': label, 'wall': wall, 'stages': stages}
+                          for label, wall, stages in runs], indent=2))
+    else:
+        print_table(runs)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
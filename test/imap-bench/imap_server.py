@@ -0,0 +1,1106 @@
+#!/usr/bin/env python3
+#
+# Scripted IMAP server, for benchmarking NeoMutt's IMAP code offline
+#
+#   This program is free software: you can redistribute it and/or modify it
+#   under the terms of the GNU General Public License as published by the Free
+#   Software Foundation, either version 2 of the License, or (at your option)
+#   any later version.
+#
+#   This program is distributed in the hope that it will be useful, but WITHOUT
+#   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+#   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+#   more details.
+#
+#   You should have received a copy of the GNU General Public License along
+#   with this program.  If not, see <http://www.gnu.org/licenses/>.
+'''Scripted IMAP server, for benchmarking NeoMutt offline
+
+The server keeps a generated mailbox of any size in memory and speaks enough
+IMAP4rev1 for NeoMutt: LITERAL+, IDLE, ENABLE, CONDSTORE, QRESYNC, UIDPLUS and
+COMPRESS=DEFLATE.  Any login is accepted.  Changes are kept until the server
+exits, and are shared by all the connections.
+
+The network can be slowed down:
+  --latency  Round-trip time, in milliseconds.  Every response is held back
+             until this long after its command arrived, so pipelined commands
+             share one round trip, as they would on a real link.
+  --bandwidth  Bytes per second the server may send (after compression).
+
+With --log, every command is recorded as a line of JSON:
+  {"t": 12.345, "session": 1, "tag": "a0003", "command": "UID FETCH",
+   "text": "a0003 UID FETCH 1:* (FLAGS)", "arrived": 12.300,
+   "bytes_in": 40, "bytes_out": 12345}
+where "t" is the time the tagged response was sent.  "bytes_in" is the size
+of the command; "bytes_out" is what was sent on the wire, after compression.  imap_bench.py uses the
+log to time each stage of a NeoMutt session.
+'''
+
+import argparse
+import asyncio
+import json
+import random
+import re
+import sys
+import time
+import zlib
+
+CAPABILITIES = ['IMAP4rev1', 'LITERAL+', 'IDLE', 'ENABLE', 'CONDSTORE',
+                'QRESYNC', 'UIDPLUS', 'COMPRESS=DEFLATE']
+SYSTEM_FLAGS = ['\\Seen', '\\Answered', '\\Flagged', '\\Deleted', '\\Draft']
+
+WORDS = ('lorem ipsum dolor sit amet consectetur adipiscing elit sed do eiusmod '
+         'tempor incididunt ut labore et dolore magna aliqua enim ad minim veniam '
+         'quis nostrud exercitation ullamco laboris nisi aliquip ex ea commodo').split()
+
+
+class ImapError(Exception):
+    '''A command failed: the tagged response is "NO" or "BAD"'''
+
+    def __init__(self, status, text):
+        super().__init__(text)
+        self.status = status
+        self.text = text
+
+
+class Message:
+    '''One message in a Mailbox'''
+
+    def __init__(self, uid, data, flags=(), date=None, modseq=1):
+        self.uid = uid
+        self.data = data
+        self.flags = set(flags)
+        self.date = date or time.time()
+        self.modseq = modseq
+        split = data.find(b'\r\n\r\n')
+        self.header = data[:split + 4] if split >= 0 else data
+        self.text = data[split + 4:] if split >= 0 else b''
+
+    def header_fields(self, names, invert=False):
+        '''Get a subset of the header, for BODY[HEADER.FIELDS (...)]'''
+        wanted = {n.upper() for n in names}
+        out = []
+        keep = False
+        for line in self.header.split(b'\r\n'):
+            if not line:
+                continue
+            if line[:1] not in (b' ', b'\t'):
+                name = line.split(b':', 1)[0].decode('ascii', 'replace').upper()
+                keep = (name in wanted) != invert
+            if keep:
+                out.append(line)
+        return b'\r\n'.join(out) + b'\r\n\r\n'
+
+    def internaldate(self):
+        '''Format the date for INTERNALDATE'''
+        return time.strftime('%d-%b-%Y %H:%M:%S +0000', time.gmtime(self.date))
+
+
+class Mailbox:
+    '''A folder, shared by all the sessions'''
+
+    def __init__(self, name):
+        self.name = name
+        self.uidvalidity = 1234567890
+        self.uidnext = 1
+        self.modseq = 1
+        self.messages = []
+        self.changed = asyncio.Condition()
+
+    def append(self, data, flags=(), date=None):
+        '''Add a message'''
+        self.modseq += 1
+        msg = Message(self.uidnext, data, flags, date, self.modseq)
+        self.uidnext += 1
+        self.messages.append(msg)
+        return msg
+
+    def touch(self, msg):
+        '''Record a change to a message's flags'''
+        self.modseq += 1
+        msg.modseq = self.modseq
+
+    async def notify(self):
+        '''Wake up any sessions that are IDLE'''
+        async with self.changed:
+            self.changed.notify_all()
+
+
+def generate_message(num, body_size, rng):
+    '''Create a plausible email, with threads of up to ten messages'''
+    thread = num - (num % 10)
+    subject = ' '.join(rng.choice(WORDS) for _ in range(5))
+    sender = rng.choice(WORDS)
+    date = 1600000000 + num * 600
+    lines = [
+        'Date: %s' % time.strftime('%a, %d %b %Y %H:%M:%S +0000', time.gmtime(date)),
+        'From: %s <%s@example.com>' % (sender.title(), sender),
+        'To: Bench User <bench@example.com>',
+        'Subject: %s%s' % ('Re: ' if num != thread else '', subject),
+        'Message-ID: <%d@bench.example.com>' % num,
+    ]
+    if num != thread:
+        lines.append('In-Reply-To: <%d@bench.example.com>' % (num - 1))
+        lines.append('References: %s' % ' '.join('<%d@bench.example.com>' % i
+                                                 for i in range(thread, num)))
+    lines += ['MIME-Version: 1.0', 'Content-Type: text/plain; charset=us-ascii', '', '']
+
+    body = []
+    size = 0
+    while size < body_size:
+        line = ' '.join(rng.choice(WORDS) for _ in range(12))
+        body.append(line)
+        size += len(line) + 2
+    data = '\r\n'.join(lines) + '\r\n'.join(body) + '\r\n'
+    return data.encode('ascii'), date
+
+
+def parse_seqset(text, highest):
+    '''Parse a sequence set, e.g. "1:5,7,9:*", into a list of ranges'''
+    ranges = []
+    for part in text.split(','):
+        bounds = [highest if b == '*' else int(b) for b in part.split(':')]
+        if len(bounds) == 1:
+            bounds.append(bounds[0])
+        ranges.append((min(bounds), max(bounds)))
+    return ranges
+
+
+def in_seqset(num, ranges):
+    '''Is a number in a parsed sequence set?'''
+    return any(lo <= num <= hi for lo, hi in ranges)
+
+
+def make_seqset(nums):
+    '''Compress a list of numbers into a sequence set'''
+    out = []
+    nums = sorted(nums)
+    i = 0
+    while i < len(nums):
+        j = i
+        while (j + 1 < len(nums)) and (nums[j + 1] == nums[j] + 1):
+            j += 1
+        out.append(str(nums[i]) if i == j else '%d:%d' % (nums[i], nums[j]))
+        i = j + 1
+    return ','.join(out)
+
+
+def tokenize(text, literals):
+    '''Split a command into atoms, strings and (nested) lists
+
+    Atoms may contain a bracketed section, e.g. BODY.PEEK[HEADER.FIELDS (A B)],
+    which is kept in one piece.  Literals have already been read; they appear
+    in the text as "\\0<index>".
+    '''
+    pos = 0
+
+    def parse_list(end):
+        nonlocal pos
+        items = []
+        while pos < len(text):
+            ch = text[pos]
+            if ch == ' ':
+                pos += 1
+            elif ch == end:
+                pos += 1
+                return items
+            elif ch == '(':
+                pos += 1
+                items.append(parse_list(')'))
+            elif ch == '"':
+                pos += 1
+                value = []
+                while text[pos] != '"':
+                    if text[pos] == '\\':
+                        pos += 1
+                    value.append(text[pos])
+                    pos += 1
+                pos += 1
+                items.append(''.join(value))
+            elif ch == '\0':
+                match = re.match(r'\0(\d+)', text[pos:])
+                pos += len(match.group(0))
+                items.append(literals[int(match.group(1))])
+            else:
+                start = pos
+                depth = 0
+                while pos < len(text):
+                    ch = text[pos]
+                    if ch == '[':
+                        depth += 1
+                    elif ch == ']':
+                        depth -= 1
+                    elif (depth == 0) and (ch in ' ()'):
+                        break
+                    pos += 1
+                items.append(text[start:pos])
+        if end:
+            raise ImapError('BAD', 'Unbalanced parentheses')
+        return items
+
+    return parse_list(None)
+
+
+def quote(text):
+    '''Quote a string for a response'''
+    return '"%s"' % text.replace('\\', '\\\\').replace('"', '\\"')
+
+
+class Session:
+    '''One client connection'''
+
+    next_id = 1
+
+    def __init__(self, server, reader, writer):
+        self.server = server
+        self.opts = server.opts
+        self.reader = reader
+        self.writer = writer
+        self.id = Session.next_id
+        Session.next_id += 1
+
+        self.inbuf = b''
+        self.outbuf = []
+        self.deflate = None
+        self.inflate = None
+        self.bytes_out = 0
+
+        self.mailbox = None
+        self.readonly = False
+        self.view = []          # UIDs, in MSN order, as known to the client
+        self.seen_modseq = 0    # Flag changes up to here have been reported
+        self.condstore = False
+        self.qresync = False
+
+    # ---- Network --------------------------------------------------------
+
+    async def fill(self):
+        '''Read more data from the client'''
+        data = await self.reader.read(65536)
+        if not data:
+            raise ConnectionResetError('client closed the connection')
+        if self.inflate:
+            data = self.inflate.decompress(data)
+        self.inbuf += data
+
+    async def read_line(self):
+        '''Read a line, without its CRLF'''
+        while b'\r\n' not in self.inbuf:
+            await self.fill()
+        line, self.inbuf = self.inbuf.split(b'\r\n', 1)
+        return line
+
+    async def read_bytes(self, num):
+        '''Read an exact number of bytes'''
+        while len(self.inbuf) < num:
+            await self.fill()
+        data, self.inbuf = self.inbuf[:num], self.inbuf[num:]
+        return data
+
+    async def read_command(self):
+        '''Read a command, including any literals'''
+        text = ''
+        literals = []
+        while True:
+            line = (await self.read_line()).decode('utf-8', 'replace')
+            match = re.search(r'\{(\d+)(\+?)\}$', line)
+            if not match:
+                return text + line, literals
+            if not match.group(2):
+                self.send('+ Ready for literal')
+                await self.flush()
+            literals.append(await self.read_bytes(int(match.group(1))))
+            text += line[:match.start()] + '\0%d' % (len(literals) - 1)
+
+    def send(self, line):
+        '''Queue a response line (str) or raw data (bytes)'''
+        if isinstance(line, str):
+            line = line.encode('utf-8') + b'\r\n'
+        self.outbuf.append(line)
+
+    async def flush(self, due=None):
+        '''Send the queued responses, simulating the network'''
+        if not self.outbuf:
+            return
+        data = b''.join(self.outbuf)
+        self.outbuf = []
+        if self.deflate:
+            data = self.deflate.compress(data) + self.deflate.flush(zlib.Z_SYNC_FLUSH)
+
+        if due is not None:
+            delay = due - time.monotonic()
+            if delay > 0:
+                await asyncio.sleep(delay)
+
+        chunk = 16384
+        for start in range(0, len(data), chunk):
+            part = data[start:start + chunk]
+            self.writer.write(part)
+            await self.writer.drain()
+            if self.opts.bandwidth:
+                await asyncio.sleep(len(part) / self.opts.bandwidth)
+        self.bytes_out += len(data)
+
+    # ---- Main loop ------------------------------------------------------
+
+    async def run(self):
+        '''Handle the connection until LOGOUT'''
+        self.send('* OK [CAPABILITY %s] IMAP benchmark server ready' %
+                  ' '.join(self.server.capabilities))
+        await self.flush()
+
+        while True:
+            text, literals = await self.read_command()
+            arrived = time.monotonic()
+            size = len(text.encode('utf-8')) + 2 + sum(len(lit) for lit in literals)
+            before_out = self.bytes_out
+
+            tag, _, rest = text.partition(' ')
+            name = '?'
+            try:
+                args = tokenize(rest, literals)
+                if not tag or not args:
+                    raise ImapError('BAD', 'Missing command')
+                name = args[0].upper()
+                if (name == 'UID') and (len(args) > 1):
+                    name = 'UID ' + args[1].upper()
+                    args = args[2:]
+                else:
+                    args = args[1:]
+
+                handler = self.server.commands.get(name)
+                if not handler:
+                    raise ImapError('BAD', 'Unknown command %s' % name)
+                result = await handler(self, tag, args, arrived)
+                self.send('%s OK %s' % (tag, result or ('%s completed' % name)))
+            except ImapError as err:
+                self.send('%s %s %s' % (tag, err.status, err.text))
+            except (ValueError, IndexError, TypeError) as err:
+                self.send('%s BAD Invalid arguments: %s' % (tag, err))
+
+            compress = (name == 'COMPRESS') and not self.deflate and \
+                self.outbuf[-1].startswith(tag.encode() + b' OK')
+            await self.flush(arrived + self.opts.latency / 1000.0)
+            if compress:
+                self.start_compression()
+
+            self.server.log(self, tag, name, text, arrived, size,
+                            self.bytes_out - before_out)
+            if name == 'LOGOUT':
+                return
+
+    def start_compression(self):
+        '''Switch both directions to DEFLATE (RFC4978)'''
+        self.deflate = zlib.compressobj(zlib.Z_DEFAULT_COMPRESSION, zlib.DEFLATED, -15)
+        self.inflate = zlib.decompressobj(-15)
+        # Anything already read arrived compressed
+        self.inbuf = self.inflate.decompress(self.inbuf)
+
+    # ---- Helpers --------------------------------------------------------
+
+    def require_selected(self):
+        '''Check that a mailbox is selected'''
+        if not self.mailbox:
+            raise ImapError('BAD', 'No mailbox selected')
+
+    def find_mailbox(self, name):
+        '''Look up a mailbox by name'''
+        mbox = self.server.mailboxes.get('INBOX' if name.upper() == 'INBOX' else name)
+        if not mbox:
+            raise ImapError('NO', '[NONEXISTENT] No such mailbox')
+        return mbox
+
+    def messages(self, setspec, uid):
+        '''Get the (msn, Message) pairs for a sequence set'''
+        by_uid = {m.uid: m for m in self.mailbox.messages}
+        if uid:
+            highest = self.mailbox.uidnext - 1
+            ranges = parse_seqset(setspec, highest if self.view else 0)
+            # "n:*" always matches the highest UID, RFC3501 6.4.8
+            if self.view and any(hi >= highest for _, hi in ranges):
+                ranges.append((self.view[-1], self.view[-1]))
+            return [(i + 1, by_uid[u]) for i, u in enumerate(self.view)
+                    if in_seqset(u, ranges) and (u in by_uid)]
+        ranges = parse_seqset(setspec, len(self.view))
+        return [(i + 1, by_uid[u]) for i, u in enumerate(self.view)
+                if in_seqset(i + 1, ranges) and (u in by_uid)]
+
+    def report_changes(self, expunge=True):
+        '''Send the changes made by other sessions: new mail, expunges, flags'''
+        if not self.mailbox:
+            return
+        current = {m.uid: m for m in self.mailbox.messages}
+
+        if expunge:
+            gone = [u for u in self.view if u not in current]
+            if gone:
+                if self.qresync:
+                    self.send('* VANISHED %s' % make_seqset(gone))
+                    self.view = [u for u in self.view if u in current]
+                else:
+                    for msn in range(len(self.view), 0, -1):
+                        if self.view[msn - 1] not in current:
+                            self.send('* %d EXPUNGE' % msn)
+                            del self.view[msn - 1]
+
+        for msn, uid in enumerate(self.view, 1):
+            msg = current.get(uid)
+            if msg and (msg.modseq > self.seen_modseq):
+                self.send('* %d FETCH (UID %d %s)' % (msn, uid, self.fetch_flags(msg)))
+
+        known = set(self.view)
+        added = [m.uid for m in self.mailbox.messages if m.uid not in known]
+        if added:
+            self.view += added
+            self.send('* %d EXISTS' % len(self.view))
+        self.seen_modseq = self.mailbox.modseq
+
+    def fetch_flags(self, msg):
+        '''Format FLAGS, and MODSEQ if CONDSTORE is in use'''
+        out = 'FLAGS (%s)' % ' '.join(sorted(msg.flags))
+        if self.condstore:
+            out += ' MODSEQ (%d)' % msg.modseq
+        return out
+
+
+# ---- Commands ------------------------------------------------------------
+
+async def cmd_capability(session, tag, args, arrived):
+    '''CAPABILITY'''
+    session.send('* CAPABILITY %s' % ' '.join(session.server.capabilities))
+
+
+async def cmd_noop(session, tag, args, arrived):
+    '''NOOP, CHECK'''
+    session.report_changes()
+
+
+async def cmd_login(session, tag, args, arrived):
+    '''LOGIN user pass - anything is accepted'''
+    return '[CAPABILITY %s] Logged in' % ' '.join(session.server.capabilities)
+
+
+async def cmd_authenticate(session, tag, args, arrived):
+    '''AUTHENTICATE - not supported, use LOGIN'''
+    raise ImapError('NO', 'Use LOGIN')
+
+
+async def cmd_logout(session, tag, args, arrived):
+    '''LOGOUT'''
+    session.send('* BYE Logging out')
+
+
+async def cmd_enable(session, tag, args, arrived):
+    '''ENABLE (RFC5161)'''
+    enabled = []
+    for ext in (a.upper() for a in args):
+        if (ext in ('CONDSTORE', 'QRESYNC')) and (ext in session.server.capabilities):
+            session.condstore = True
+            if ext == 'QRESYNC':
+                session.qresync = True
+            enabled.append(ext)
+    session.send('* ENABLED %s' % ' '.join(enabled))
+
+
+async def cmd_compress(session, tag, args, arrived):
+    '''COMPRESS DEFLATE (RFC4978) - compression starts after the OK'''
+    if 'COMPRESS=DEFLATE' not in session.server.capabilities:
+        raise ImapError('BAD', 'Not supported')
+    if session.deflate:
+        raise ImapError('NO', '[COMPRESSIONACTIVE] Already compressing')
+    if args[0].upper() != 'DEFLATE':
+        raise ImapError('BAD', 'Unknown algorithm')
+    return 'DEFLATE active'
+
+
+async def cmd_idle(session, tag, args, arrived):
+    '''IDLE (RFC2177) - report changes until DONE'''
+    if 'IDLE' not in session.server.capabilities:
+        raise ImapError('BAD', 'Not supported')
+    session.send('+ idling')
+    session.report_changes()
+    await session.flush(arrived + session.opts.latency / 1000.0)
+
+    done = asyncio.ensure_future(session.read_line())
+    mbox = session.mailbox
+    while True:
+        waits = [done]
+        if mbox:
+            async with mbox.changed:
+                changed = asyncio.ensure_future(mbox.changed.wait())
+            waits.append(changed)
+        finished, _ = await asyncio.wait(waits, return_when=asyncio.FIRST_COMPLETED)
+        if mbox:
+            changed.cancel()
+        if done in finished:
+            if done.result().upper() != b'DONE':
+                raise ImapError('BAD', 'Expected DONE')
+            return 'IDLE terminated'
+        session.report_changes()
+        await session.flush()
+
+
+async def cmd_list(session, tag, args, arrived, kind='LIST'):
+    '''LIST - every mailbox matches any pattern'''
+    if args and isinstance(args[0], list):
+        args = args[1:]     # selection options, e.g. (SUBSCRIBED)
+    if args[1] == '':
+        session.send('* %s (\\Noselect) "/" ""' % kind)
+        return
+    for mbox in session.server.mailboxes:
+        session.send('* %s (\\HasNoChildren) "/" %s' % (kind, quote(mbox)))
+
+
+async def cmd_lsub(session, tag, args, arrived):
+    '''LSUB - every mailbox is subscribed'''
+    return await cmd_list(session, tag, args, arrived, kind='LSUB')
+
+
+async def cmd_status(session, tag, args, arrived):
+    '''STATUS mailbox (items)'''
+    mbox = session.find_mailbox(args[0])
+    values = {
+        'MESSAGES': len(mbox.messages),
+        'RECENT': 0,
+        'UIDNEXT': mbox.uidnext,
+        'UIDVALIDITY': mbox.uidvalidity,
+        'UNSEEN': sum(1 for m in mbox.messages if '\\Seen' not in m.flags),
+        'HIGHESTMODSEQ': mbox.modseq,
+    }
+    items = ' '.join('%s %d' % (i.upper(), values[i.upper()]) for i in args[1])
+    session.send('* STATUS %s (%s)' % (quote(mbox.name), items))
+
+
+async def cmd_select(session, tag, args, arrived, readonly=False):
+    '''SELECT, EXAMINE, with CONDSTORE (RFC7162)'''
+    session.mailbox = None
+    mbox = session.find_mailbox(args[0])
+    session.readonly = readonly
+    for param in args[1:]:
+        if isinstance(param, list) and param and (param[0].upper() == 'CONDSTORE'):
+            session.condstore = True
+
+    session.mailbox = mbox
+    session.view = [m.uid for m in mbox.messages]
+    session.seen_modseq = mbox.modseq
+    session.send('* FLAGS (%s)' % ' '.join(SYSTEM_FLAGS))
+    session.send('* OK [PERMANENTFLAGS (%s \\*)] Flags permitted' % ' '.join(SYSTEM_FLAGS))
+    session.send('* %d EXISTS' % len(mbox.messages))
+    session.send('* 0 RECENT')
+    session.send('* OK [UIDVALIDITY %d] UIDs valid' % mbox.uidvalidity)
+    session.send('* OK [UIDNEXT %d] Predicted next UID' % mbox.uidnext)
+    if 'CONDSTORE' in session.server.capabilities:
+        session.send('* OK [HIGHESTMODSEQ %d] Highest' % mbox.modseq)
+    return '[READ-%s] Selected' % ('ONLY' if session.readonly else 'WRITE')
+
+
+async def cmd_examine(session, tag, args, arrived):
+    '''EXAMINE'''
+    return await cmd_select(session, tag, args, arrived, readonly=True)
+
+
+async def cmd_close(session, tag, args, arrived):
+    '''CLOSE, UNSELECT'''
+    session.require_selected()
+    session.mailbox = None
+    session.view = []
+
+
+def fetch_section(msg, section):
+    '''Get the data for a BODY[section]'''
+    section = section.upper()
+    if section == '':
+        return msg.data
+    if section == 'HEADER':
+        return msg.header
+    if section == 'TEXT':
+        return msg.text
+    match = re.match(r'HEADER\.FIELDS(\.NOT)?\s*\((.*)\)', section)
+    if match:
+        return msg.header_fields(match.group(2).split(), bool(match.group(1)))
+    if section == '1':
+        return msg.text
+    raise ImapError('BAD', 'Unsupported section %s' % section)
+
+
+def fetch_item(session, msg, item, out, literals):
+    '''Format one FETCH data item'''
+    name = item.upper()
+    if name == 'UID':
+        return
+    if name == 'FLAGS':
+        out.append('FLAGS (%s)' % ' '.join(sorted(msg.flags)))
+    elif name == 'MODSEQ':
+        out.append('MODSEQ (%d)' % msg.modseq)
+    elif name == 'INTERNALDATE':
+        out.append('INTERNALDATE "%s"' % msg.internaldate())
+    elif name == 'RFC822.SIZE':
+        out.append('RFC822.SIZE %d' % len(msg.data))
+    elif name in ('RFC822', 'RFC822.HEADER', 'RFC822.TEXT'):
+        data = {'RFC822': msg.data, 'RFC822.HEADER': msg.header,
+                'RFC822.TEXT': msg.text}[name]
+        literals.append((name, data))
+    elif name.startswith('RFC822.HEADER.LINES'):
+        fields = re.search(r'\((.*)\)', item).group(1).split()
+        literals.append(('RFC822.HEADER', msg.header_fields(fields)))
+    elif name == 'ENVELOPE':
+        out.append('ENVELOPE %s' % envelope(msg))
+    elif name in ('BODYSTRUCTURE', 'BODY'):
+        out.append('%s ("TEXT" "PLAIN" ("CHARSET" "us-ascii") NIL NIL "7BIT" %d %d)' %
+                   (name, len(msg.text), msg.text.count(b'\r\n')))
+    elif name.startswith('BODY[') or name.startswith('BODY.PEEK['):
+        match = re.match(r'BODY(?:\.PEEK)?\[(.*)\](?:<(\d+)\.(\d+)>)?$', item, re.I)
+        data = fetch_section(msg, match.group(1))
+        label = 'BODY[%s]' % match.group(1)
+        if match.group(2):
+            start = int(match.group(2))
+            data = data[start:start + int(match.group(3))]
+            label += '<%d>' % start
+        literals.append((label, data))
+        if not name.startswith('BODY.PEEK') and not session.readonly and \
+                ('\\Seen' not in msg.flags):
+            msg.flags.add('\\Seen')
+            session.mailbox.touch(msg)
+            out.append('FLAGS (%s)' % ' '.join(sorted(msg.flags)))
+    else:
+        raise ImapError('BAD', 'Unsupported FETCH item %s' % item)
+
+
+def envelope(msg):
+    '''Build an ENVELOPE from the message's header'''
+    fields = {}
+    for line in msg.header.decode('ascii', 'replace').split('\r\n'):
+        if ':' in line:
+            key, value = line.split(':', 1)
+            fields[key.strip().upper()] = value.strip()
+
+    def nstring(key):
+        return quote(fields[key]) if key in fields else 'NIL'
+
+    def address(key):
+        match = re.match(r'(.*?)\s*<([^@]+)@([^>]+)>', fields.get(key, ''))
+        if not match:
+            return 'NIL'
+        return '((%s NIL %s %s))' % (quote(match.group(1)), quote(match.group(2)),
+                                     quote(match.group(3)))
+
+    return '(%s %s %s %s %s %s NIL NIL %s %s)' % (
+        nstring('DATE'), nstring('SUBJECT'), address('FROM'), address('FROM'),
+        address('FROM'), address('TO'), nstring('IN-REPLY-TO'), nstring('MESSAGE-ID'))
+
+
+async def cmd_fetch(session, tag, args, arrived, uid=False):
+    '''FETCH, UID FETCH, with CHANGEDSINCE and VANISHED (RFC7162)'''
+    session.require_selected()
+    items = args[1] if isinstance(args[1], list) else [args[1]]
+    macros = {'ALL': ['FLAGS', 'INTERNALDATE', 'RFC822.SIZE', 'ENVELOPE'],
+              'FAST': ['FLAGS', 'INTERNALDATE', 'RFC822.SIZE'],
+              'FULL': ['FLAGS', 'INTERNALDATE', 'RFC822.SIZE', 'ENVELOPE', 'BODY']}
+    if len(items) == 1 and items[0].upper() in macros:
+        items = macros[items[0].upper()]
+
+    changedsince = None
+    vanished = False
+    if len(args) > 2:
+        mods = args[2]
+        for i, mod in enumerate(mods):
+            if mod.upper() == 'CHANGEDSINCE':
+                changedsince = int(mods[i + 1])
+            elif mod.upper() == 'VANISHED':
+                vanished = True
+    if changedsince is not None:
+        session.condstore = True
+        items = items + ['MODSEQ']
+
+    if vanished:
+        if not (uid and session.qresync and changedsince is not None):
+            raise ImapError('BAD', 'VANISHED needs UID FETCH, QRESYNC and CHANGEDSINCE')
+        # Every UID that's missing has "vanished", the server keeps no history
+        ranges = parse_seqset(args[0], session.mailbox.uidnext - 1)
+        live = {m.uid for m in session.mailbox.messages}
+        gone = [u for lo, hi in ranges for u in range(lo, min(hi, session.mailbox.uidnext - 1) + 1)
+                if u not in live]
+        if gone:
+            session.send('* VANISHED (EARLIER) %s' % make_seqset(gone))
+
+    want_modseq = session.condstore and any(i.upper() == 'FLAGS' for i in items)
+    for msn, msg in session.messages(args[0], uid):
+        if (changedsince is not None) and (msg.modseq <= changedsince):
+            continue
+        out = ['UID %d' % msg.uid] if uid or any(i.upper() == 'UID' for i in items) else []
+        literals = []
+        for item in items:
+            fetch_item(session, msg, item, out, literals)
+        if want_modseq and not any(o.startswith('MODSEQ') for o in out):
+            out.append('MODSEQ (%d)' % msg.modseq)
+
+        parts = ' '.join(out)
+        if literals:
+            # Literals go last, so the client can read the other items first
+            prefix = '* %d FETCH (%s' % (msn, parts + ' ' if parts else '')
+            for label, data in literals:
+                session.send('%s%s {%d}' % (prefix, label, len(data)))
+                session.send(data)
+                prefix = ' '
+            session.send(')')
+        else:
+            session.send('* %d FETCH (%s)' % (msn, parts))
+
+        # Keep the output moving, so large fetches stream
+        if len(session.outbuf) > 256:
+            await session.flush(arrived + session.opts.latency / 1000.0)
+
+    session.report_changes(expunge=False)
+
+
+async def cmd_uid_fetch(session, tag, args, arrived):
+    '''UID FETCH'''
+    return await cmd_fetch(session, tag, args, arrived, uid=True)
+
+
+async def cmd_store(session, tag, args, arrived, uid=False):
+    '''STORE, UID STORE, with UNCHANGEDSINCE (RFC7162)'''
+    session.require_selected()
+    if session.readonly:
+        raise ImapError('NO', 'Mailbox is read-only')
+
+    rest = args[1:]
+    unchangedsince = None
+    if isinstance(rest[0], list):
+        mods = rest[0]
+        unchangedsince = int(mods[mods.index(next(m for m in mods
+                                                   if m.upper() == 'UNCHANGEDSINCE')) + 1])
+        session.condstore = True
+        rest = rest[1:]
+
+    action = rest[0].upper()
+    flags = rest[1] if isinstance(rest[1], list) else rest[1:]
+    silent = action.endswith('.SILENT')
+    action = action.replace('.SILENT', '')
+
+    # The client already knows about its own changes
+    caught_up = (session.seen_modseq == session.mailbox.modseq)
+    modified = []
+    for msn, msg in session.messages(args[0], uid):
+        if (unchangedsince is not None) and (msg.modseq > unchangedsince):
+            modified.append(msg.uid if uid else msn)
+            continue
+        old = set(msg.flags)
+        if action == '+FLAGS':
+            msg.flags |= set(flags)
+        elif action == '-FLAGS':
+            msg.flags -= set(flags)
+        elif action == 'FLAGS':
+            msg.flags = set(flags)
+        else:
+            raise ImapError('BAD', 'Unknown STORE action')
+        if msg.flags != old:
+            session.mailbox.touch(msg)
+            if not silent or session.condstore:
+                item = session.fetch_flags(msg) if not silent else 'MODSEQ (%d)' % msg.modseq
+                session.send('* %d FETCH (%s%s)' % (msn, 'UID %d ' % msg.uid if uid else '', item))
+    if caught_up:
+        session.seen_modseq = session.mailbox.modseq
+    await session.mailbox.notify()
+
+    if modified:
+        return '[MODIFIED %s] Conditional STORE failed' % make_seqset(modified)
+    return None
+
+
+async def cmd_uid_store(session, tag, args, arrived):
+    '''UID STORE'''
+    return await cmd_store(session, tag, args, arrived, uid=True)
+
+
+def search_match(session, msn, msg, keys):
+    '''Does a message match a list of SEARCH keys?  Consumes the list'''
+    key = keys.pop(0)
+    if isinstance(key, list):
+        keys_copy = list(key)
+        result = True
+        while keys_copy:
+            result = search_match(session, msn, msg, keys_copy) and result
+        return result
+
+    flag_keys = {'SEEN': '\\Seen', 'ANSWERED': '\\Answered', 'FLAGGED': '\\Flagged',
+                 'DELETED': '\\Deleted', 'DRAFT': '\\Draft'}
+    name = key.upper()
+    if name == 'ALL':
+        return True
+    if name in flag_keys:
+        return flag_keys[name] in msg.flags
+    if name.startswith('UN') and name[2:] in flag_keys:
+        return flag_keys[name[2:]] not in msg.flags
+    if name in ('NEW', 'RECENT'):
+        return False
+    if name == 'OLD':
+        return True
+    if name == 'NOT':
+        return not search_match(session, msn, msg, keys)
+    if name == 'OR':
+        first = search_match(session, msn, msg, keys)
+        return search_match(session, msn, msg, keys) or first
+    if name == 'UID':
+        return in_seqset(msg.uid, parse_seqset(keys.pop(0), session.mailbox.uidnext - 1))
+    if name == 'KEYWORD':
+        return keys.pop(0) in msg.flags
+    if name == 'UNKEYWORD':
+        return keys.pop(0) not in msg.flags
+    if name in ('SUBJECT', 'FROM', 'TO', 'CC', 'BCC'):
+        value = keys.pop(0)
+        return value.lower().encode() in msg.header_fields([name]).lower()
+    if name == 'HEADER':
+        field = keys.pop(0)
+        value = keys.pop(0)
+        return value.lower().encode() in msg.header_fields([field]).lower()
+    if name == 'BODY':
+        return keys.pop(0).lower().encode() in msg.text.lower()
+    if name == 'TEXT':
+        return keys.pop(0).lower().encode() in msg.data.lower()
+    if name in ('LARGER', 'SMALLER'):
+        size = int(keys.pop(0))
+        return (len(msg.data) > size) if name == 'LARGER' else (len(msg.data) < size)
+    if name in ('BEFORE', 'ON', 'SINCE', 'SENTBEFORE', 'SENTON', 'SENTSINCE'):
+        day = time.mktime(time.strptime(keys.pop(0), '%d-%b-%Y'))
+        msg_day = msg.date - (msg.date % 86400)
+        if name.endswith('BEFORE'):
+            return msg_day < day
+        if name.endswith('ON'):
+            return msg_day == day
+        return msg_day >= day
+    if name == 'MODSEQ':
+        return msg.modseq >= int(keys.pop(0))
+    if re.match(r'^[\d:*,]+$', key):
+        return in_seqset(msn, parse_seqset(key, len(session.view)))
+    raise ImapError('BAD', 'Unsupported SEARCH key %s' % key)
+
+
+async def cmd_search(session, tag, args, arrived, uid=False):
+    '''SEARCH, UID SEARCH'''
+    session.require_selected()
+    if args and args[0].upper() == 'CHARSET':
+        args = args[2:]
+    found = []
+    for msn, msg in session.messages('1:*', False):
+        keys = list(args)
+        match = True
+        while keys:
+            match = search_match(session, msn, msg, keys) and match
+        if match:
+            found.append(str(msg.uid if uid else msn))
+    session.send('* SEARCH %s' % ' '.join(found) if found else '* SEARCH')
+
+
+async def cmd_uid_search(session, tag, args, arrived):
+    '''UID SEARCH'''
+    return await cmd_search(session, tag, args, arrived, uid=True)
+
+
+async def cmd_expunge(session, tag, args, arrived, uid=False):
+    '''EXPUNGE, UID EXPUNGE (RFC4315)'''
+    session.require_selected()
+    if session.readonly:
+        raise ImapError('NO', 'Mailbox is read-only')
+    ranges = parse_seqset(args[0], session.mailbox.uidnext - 1) if uid else None
+    mbox = session.mailbox
+    doomed = {m.uid for m in mbox.messages if ('\\Deleted' in m.flags) and
+              ((ranges is None) or in_seqset(m.uid, ranges))}
+    if doomed:
+        mbox.messages = [m for m in mbox.messages if m.uid not in doomed]
+        mbox.modseq += 1
+        await mbox.notify()
+    session.report_changes()
+
+
+async def cmd_uid_expunge(session, tag, args, arrived):
+    '''UID EXPUNGE'''
+    return await cmd_expunge(session, tag, args, arrived, uid=True)
+
+
+async def cmd_copy(session, tag, args, arrived, uid=False, move=False):
+    '''COPY, UID COPY, MOVE, UID MOVE'''
+    session.require_selected()
+    dest = session.find_mailbox(args[1])
+    src_uids = []
+    dst_uids = []
+    for _, msg in session.messages(args[0], uid):
+        new = dest.append(msg.data, msg.flags, msg.date)
+        src_uids.append(msg.uid)
+        dst_uids.append(new.uid)
+    await dest.notify()
+    if move:
+        session.mailbox.messages = [m for m in session.mailbox.messages
+                                    if m.uid not in set(src_uids)]
+        session.mailbox.modseq += 1
+        session.report_changes()
+    if not src_uids:
+        return None
+    return '[COPYUID %d %s %s] Done' % (dest.uidvalidity, make_seqset(src_uids),
+                                        make_seqset(dst_uids))
+
+
+async def cmd_uid_copy(session, tag, args, arrived):
+    '''UID COPY'''
+    return await cmd_copy(session, tag, args, arrived, uid=True)
+
+
+async def cmd_append(session, tag, args, arrived):
+    '''APPEND mailbox [(flags)] [date] literal'''
+    mbox = session.find_mailbox(args[0])
+    flags = args[1] if isinstance(args[1], list) else []
+    data = args[-1]
+    if not isinstance(data, bytes):
+        raise ImapError('BAD', 'Expected a literal')
+    msg = mbox.append(data, flags)
+    await mbox.notify()
+    session.report_changes(expunge=False)
+    return '[APPENDUID %d %d] Appended' % (mbox.uidvalidity, msg.uid)
+
+
+async def cmd_create(session, tag, args, arrived):
+    '''CREATE'''
+    if args[0] in session.server.mailboxes:
+        raise ImapError('NO', '[ALREADYEXISTS] Mailbox exists')
+    session.server.mailboxes[args[0]] = Mailbox(args[0])
+
+
+async def cmd_delete(session, tag, args, arrived):
+    '''DELETE'''
+    session.find_mailbox(args[0])
+    del session.server.mailboxes[args[0]]
+
+
+async def cmd_rename(session, tag, args, arrived):
+    '''RENAME'''
+    mbox = session.find_mailbox(args[0])
+    del session.server.mailboxes[args[0]]
+    mbox.name = args[1]
+    session.server.mailboxes[args[1]] = mbox
+
+
+async def cmd_ok(session, tag, args, arrived):
+    '''SUBSCRIBE, UNSUBSCRIBE - always succeed'''
+
+
+class Server:
+    '''Mailboxes and listener'''
+
+    def __init__(self, opts):
+        self.opts = opts
+        self.capabilities = [c for c in CAPABILITIES
+                             if c.split('=')[0] not in opts.disable]
+        self.logfile = open(opts.log, 'a', buffering=1) if opts.log else None
+        self.start = time.monotonic()
+
+        rng = random.Random(opts.seed)
+        inbox = Mailbox('INBOX')
+        for num in range(opts.messages):
+            data, date = generate_message(num, opts.body_size, rng)
+            flags = ['\\Seen'] if rng.random() < opts.seen else []
+            inbox.append(data, flags, date)
+        self.mailboxes = {'INBOX': inbox}
+        for num in range(opts.folders):
+            folder = Mailbox('folder%d' % num)
+            for i in range(10):
+                data, date = generate_message(i, opts.body_size, rng)
+                folder.append(data, [], date)
+            self.mailboxes[folder.name] = folder
+
+        self.commands = {
+            'CAPABILITY': cmd_capability, 'NOOP': cmd_noop, 'CHECK': cmd_noop,
+            'LOGIN': cmd_login, 'AUTHENTICATE': cmd_authenticate,
+            'LOGOUT': cmd_logout, 'ENABLE': cmd_enable, 'COMPRESS': cmd_compress,
+            'IDLE': cmd_idle, 'LIST': cmd_list, 'LSUB': cmd_lsub,
+            'STATUS': cmd_status, 'SELECT': cmd_select, 'EXAMINE': cmd_examine,
+            'CLOSE': cmd_close, 'UNSELECT': cmd_close,
+            'FETCH': cmd_fetch, 'UID FETCH': cmd_uid_fetch,
+            'STORE': cmd_store, 'UID STORE': cmd_uid_store,
+            'SEARCH': cmd_search, 'UID SEARCH': cmd_uid_search,
+            'EXPUNGE': cmd_expunge, 'UID EXPUNGE': cmd_uid_expunge,
+            'COPY': cmd_copy, 'UID COPY': cmd_uid_copy, 'APPEND': cmd_append,
+            'CREATE': cmd_create, 'DELETE': cmd_delete, 'RENAME': cmd_rename,
+            'SUBSCRIBE': cmd_ok, 'UNSUBSCRIBE': cmd_ok,
+        }
+
+    def log(self, session, tag, command, text, arrived, bytes_in, bytes_out):
+        '''Record a completed command'''
+        if not self.logfile:
+            return
+        if command in ('LOGIN', 'AUTHENTICATE'):
+            text = tag + ' ' + command
+        self.logfile.write(json.dumps({
+            't': round(time.monotonic() - self.start, 6),
+            'session': session.id,
+            'tag': tag,
+            'command': command,
+            'text': text[:200],
+            'arrived': round(arrived - self.start, 6),
+            'bytes_in': bytes_in,
+            'bytes_out': bytes_out,
+        }) + '\n')
+
+    async def handle(self, reader, writer):
+        '''Serve one connection'''
+        session = Session(self, reader, writer)
+        try:
+            await session.run()
+        except (ConnectionError, asyncio.IncompleteReadError):
+            pass
+        finally:
+            writer.close()
+
+    async def churn(self):
+        '''Simulate another client, by toggling \\Flagged on random messages'''
+        rng = random.Random(self.opts.seed + 1)
+        inbox = self.mailboxes['INBOX']
+        while True:
+            await asyncio.sleep(self.opts.churn)
+            if not inbox.messages:
+                continue
+            msg = rng.choice(inbox.messages)
+            msg.flags ^= {'\\Flagged'}
+            inbox.touch(msg)
+            await inbox.notify()
+
+    async def serve(self):
+        '''Listen until killed'''
+        server = await asyncio.start_server(self.handle, self.opts.host, self.opts.port)
+        port = server.sockets[0].getsockname()[1]
+        print('Listening on %s:%d, %d messages' % (self.opts.host, port, self.opts.messages),
+              flush=True)
+        if self.opts.churn:
+            asyncio.ensure_future(self.churn())
+        async with server:
+            await server.serve_forever()
+
+
+def main():
+    '''Parse the options and run the server'''
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--host', default='127.0.0.1', help='address to listen on')
+    parser.add_argument('--port', type=int, default=1143, help='port, 0 for any')
+    parser.add_argument('--messages', type=int, default=1000, help='messages in the INBOX')
+    parser.add_argument('--body-size', type=int, default=2048, help='bytes of body per message')
+    parser.add_argument('--folders', type=int, default=0, help='extra mailboxes of 10 messages')
+    parser.add_argument('--seen', type=float, default=0.5, help='fraction of messages read')
+    parser.add_argument('--seed', type=int, default=1, help='random seed for the mailbox')
+    parser.add_argument('--latency', type=float, default=0, help='round-trip time, in ms')
+    parser.add_argument('--bandwidth', type=float, default=0, help='bytes/second, 0 for unlimited')
+    parser.add_argument('--disable', action='append', default=[], metavar='CAP',
+                        help='capability to hide, e.g. QRESYNC (repeatable)')
+    parser.add_argument('--churn', type=float, default=0,
+                        help='toggle a flag every N seconds, like another client')
+    parser.add_argument('--log', help='file to record the commands, as JSON lines')
+    opts = parser.parse_args()
+    opts.disable = [d.upper() for d in opts.disable]
+
+    try:
+        asyncio.run(Server(opts).serve())
+    except KeyboardInterrupt:
+        pass
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,172 @@
+/**
+ * @file
+ * Test code for IMAP ENVELOPE and BODYSTRUCTURE parsing
+ *
+ * @authors
+ * Copyright (C) 2026 Richard Russon <rich@flatcap.org>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include <stddef.h>
+#include <stdbool.h>
+#include "mutt/lib.h"
+#include "address/lib.h"
+#include "config/lib.h"
+#include "email/lib.h"
+#include "core/lib.h"
+#include "imap/private.h" // IWYU pragma: keep
+#include "test_common.h"
+
+static struct ConfigDef Vars[] = {
+  // clang-format off
+  { "rfc2047_parameters", DT_BOOL, true, 0, NULL, },
+  { NULL },
+  // clang-format on
+};
+
+void test_nstring(void)
+{
+  struct Buffer *buf = buf_pool_get();
+  bool nil = false;
+
+  {
+    char str[] = " \"a \\\"quoted\\\" string\" rest";
+    char *s = str;
+    TEST_CHECK(imap_parse_nstring(&s, buf, &nil));
+    TEST_CHECK_STR_EQ(buf_string(buf), "a \"quoted\" string");
+    TEST_CHECK(!nil);
+    TEST_CHECK_STR_EQ(s, " rest");
+  }
+
+  {
+    char str[] = "NIL)";
+    char *s = str;
+    TEST_CHECK(imap_parse_nstring(&s, buf, &nil));
+    TEST_CHECK(nil);
+    TEST_CHECK_STR_EQ(s, ")");
+  }
+
+  {
+    char str[] = "\"unterminated";
+    char *s = str;
+    TEST_CHECK(!imap_parse_nstring(&s, buf, &nil));
+  }
+
+  {
+    char str[] = "(a (b \")\") c) NIL";
+    char *s = imap_skip_item(str);
+    TEST_CHECK_STR_EQ(s, " NIL");
+  }
+
+  buf_pool_release(&buf);
+}
+
+void test_envelope(void)
+{
+  char str[] = "(NIL NIL ((\"Alice\" NIL \"alice\" \"example.com\")) NIL NIL "
+               "((NIL NIL \"team\" NIL)(NIL NIL \"bob\" \"example.org\")(NIL NIL NIL NIL)) "
+               "NIL NIL NIL \"<id@example.com>\")";
+
+  struct Email *e = email_new();
+  TEST_CHECK(imap_parse_envelope(str, e) == 0);
+
+  struct Address *a = TAILQ_FIRST(&e->env->from);
+  if (TEST_CHECK(a != NULL))
+  {
+    TEST_CHECK_STR_EQ(buf_string(a->mailbox), "alice@example.com");
+    TEST_CHECK_STR_EQ(buf_string(a->personal), "Alice");
+  }
+
+  a = TAILQ_FIRST(&e->env->to);
+  if (TEST_CHECK(a != NULL))
+  {
+    TEST_CHECK(a->group);
+    TEST_CHECK_STR_EQ(buf_string(a->mailbox), "team");
+    a = TAILQ_NEXT(a, entries);
+    TEST_CHECK_STR_EQ(buf_string(a->mailbox), "bob@example.org");
+    a = TAILQ_NEXT(a, entries);
+    TEST_CHECK(!a->group && !a->mailbox);
+  }
+
+  TEST_CHECK_STR_EQ(e->env->message_id, "<id@example.com>");
+
+  char bad[] = "(NIL NIL (";
+  TEST_CHECK(imap_parse_envelope(bad, e) == -1);
+
+  email_free(&e);
+}
+
+void test_bodystructure(void)
+{
+  char str[] = "((\"text\" \"plain\" (\"charset\" \"utf-8\") NIL NIL \"7bit\" 42 3 NIL NIL NIL NIL)"
+               "(\"application\" \"pdf\" (\"name\" \"a.pdf\") NIL \"A PDF\" \"base64\" 1000 NIL "
+               "(\"attachment\" (\"filename\" \"a.pdf\")) NIL NIL)"
+               "(\"message\" \"rfc822\" NIL NIL NIL \"7bit\" 50 (NIL NIL NIL NIL NIL NIL NIL NIL NIL NIL) "
+               "(\"text\" \"plain\" NIL NIL NIL \"7bit\" 10 1) 4)"
+               " \"mixed\" (\"boundary\" \"xyz\") NIL NIL NIL)";
+
+  struct Email *e = email_new();
+  e->body = mutt_body_new();
+  TEST_CHECK(imap_parse_bodystructure(str, e) == 0);
+
+  struct Body *b = e->body;
+  TEST_CHECK(b->type == TYPE_MULTIPART);
+  TEST_CHECK_STR_EQ(b->subtype, "mixed");
+  TEST_CHECK_STR_EQ(mutt_param_get(&b->parameter, "boundary"), "xyz");
+
+  b = b->parts;
+  if (TEST_CHECK(b != NULL))
+  {
+    TEST_CHECK(b->type == TYPE_TEXT);
+    TEST_CHECK_STR_EQ(mutt_param_get(&b->parameter, "charset"), "utf-8");
+    TEST_CHECK(b->length == 42);
+
+    b = b->next;
+    TEST_CHECK(b->type == TYPE_APPLICATION);
+    TEST_CHECK(b->encoding == ENC_BASE64);
+    TEST_CHECK(b->disposition == DISP_ATTACH);
+    TEST_CHECK_STR_EQ(b->d_filename, "a.pdf");
+    TEST_CHECK_STR_EQ(b->description, "A PDF");
+
+    b = b->next;
+    TEST_CHECK(b->type == TYPE_MESSAGE);
+    TEST_CHECK(b->next == NULL);
+  }
+
+  char single[] = "(\"TEXT\" \"HTML\" NIL NIL NIL \"QUOTED-PRINTABLE\" 200 12)";
+  TEST_CHECK(imap_parse_bodystructure(single, e) == 0);
+  TEST_CHECK(e->body->type == TYPE_TEXT);
+  TEST_CHECK_STR_EQ(e->body->subtype, "html");
+  TEST_CHECK(e->body->parts == NULL);
+  TEST_CHECK(e->lines == 12);
+
+  char bad[] = "((\"text\" \"plain\"";
+  TEST_CHECK(imap_parse_bodystructure(bad, e) == -1);
+
+  email_free(&e);
+}
+
+void test_imap_envelope(void)
+{
+  TEST_CHECK(cs_register_variables(NeoMutt->sub->cs, Vars));
+
+  test_nstring();
+  test_envelope();
+  test_bodystructure();
+}
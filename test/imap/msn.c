@@ -0,0 +1,121 @@
+/**
+ * @file
+ * Test code for the IMAP MSN index
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include <stddef.h>
+#include <stdbool.h>
+#include "mutt/lib.h"
+#include "email/lib.h"
+#include "imap/edata.h"
+#include "imap/mdata.h" // IWYU pragma: keep
+#include "imap/msn.h"
+#include "test_common.h"
+
+static void msn_fill(struct MSNArray *msn, struct Email **emails, size_t num)
+{
+  imap_msn_reserve(msn, num);
+  for (size_t i = 0; i < num; i++)
+  {
+    emails[i] = email_new();
+    emails[i]->edata = imap_edata_new();
+    emails[i]->edata_free = imap_edata_free;
+    imap_edata_get(emails[i])->msn = i + 1;
+    imap_msn_set(msn, i, emails[i]);
+  }
+}
+
+static void msn_empty(struct MSNArray *msn, struct Email **emails, size_t num)
+{
+  for (size_t i = 0; i < num; i++)
+    email_free(&emails[i]);
+  imap_msn_free(msn);
+}
+
+void test_imap_msn(void)
+{
+  // struct MsnExpunge *imap_msn_expunge_new(const struct MSNArray *msn);
+  // size_t imap_msn_expunge_find(const struct MsnExpunge *mx, size_t num);
+  // void imap_msn_expunge_mark(struct MsnExpunge *mx, size_t idx);
+  // void imap_msn_expunge_apply(struct MSNArray *msn, struct MsnExpunge **ptr);
+
+  {
+    imap_msn_expunge_free(NULL);
+    imap_msn_expunge_mark(NULL, 0);
+    TEST_CHECK(imap_msn_expunge_find(NULL, 1) == (size_t) -1);
+  }
+
+  {
+    // A run of EXPUNGE responses, each numbered after the previous one
+    struct MSNArray msn = ARRAY_HEAD_INITIALIZER;
+    struct Email *emails[10] = { 0 };
+    msn_fill(&msn, emails, mutt_array_size(emails));
+
+    struct MsnExpunge *mx = imap_msn_expunge_new(&msn);
+    TEST_CHECK(mx->live == 10);
+
+    for (int i = 0; i < 3; i++)
+    {
+      size_t idx = imap_msn_expunge_find(mx, 3);
+      TEST_CHECK(idx == (size_t) (2 + i));
+      imap_msn_expunge_mark(mx, idx);
+    }
+
+    size_t idx = imap_msn_expunge_find(mx, 7);
+    TEST_CHECK(idx == 9);
+    imap_msn_expunge_mark(mx, idx);
+    TEST_CHECK(mx->live == 6);
+    TEST_CHECK(imap_msn_expunge_find(mx, 7) == (size_t) -1);
+
+    imap_msn_expunge_apply(&msn, &mx);
+    TEST_CHECK(mx == NULL);
+    TEST_CHECK(imap_msn_highest(&msn) == 6);
+
+    static const int survivors[] = { 0, 1, 5, 6, 7, 8 };
+    for (size_t i = 0; i < mutt_array_size(survivors); i++)
+    {
+      TEST_CHECK(imap_msn_get(&msn, i) == emails[survivors[i]]);
+      TEST_CHECK(imap_edata_get(emails[survivors[i]])->msn == (i + 1));
+    }
+
+    msn_empty(&msn, emails, mutt_array_size(emails));
+  }
+
+  {
+    // Unloaded messages leave holes in the index, which must be kept
+    struct MSNArray msn = ARRAY_HEAD_INITIALIZER;
+    struct Email *emails[5] = { 0 };
+    msn_fill(&msn, emails, mutt_array_size(emails));
+    imap_msn_remove(&msn, 1);
+
+    struct MsnExpunge *mx = imap_msn_expunge_new(&msn);
+    imap_msn_expunge_mark(mx, 0);
+    imap_msn_expunge_mark(mx, 0);
+    TEST_CHECK(mx->live == 4);
+    imap_msn_expunge_apply(&msn, &mx);
+
+    TEST_CHECK(imap_msn_highest(&msn) == 4);
+    TEST_CHECK(imap_msn_get(&msn, 0) == NULL);
+    TEST_CHECK(imap_msn_get(&msn, 1) == emails[2]);
+    TEST_CHECK(imap_edata_get(emails[4])->msn == 4);
+
+    msn_empty(&msn, emails, mutt_array_size(emails));
+  }
+}
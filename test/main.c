@@ -257,6 +257,7 @@ void test_fini(void);
   NEOMUTT_TEST_ITEM(test_email_free)                                           \
   NEOMUTT_TEST_ITEM(test_email_new)                                            \
   NEOMUTT_TEST_ITEM(test_email_size)                                           \
+  NEOMUTT_TEST_ITEM(test_email_structure_known)                                \
   NEOMUTT_TEST_ITEM(test_mutt_autocrypthdr_free)                               \
   NEOMUTT_TEST_ITEM(test_mutt_autocrypthdr_new)                                \
   NEOMUTT_TEST_ITEM(test_email_header_find)                                    \
@@ -423,7 +424,9 @@ void test_fini(void);
   NEOMUTT_TEST_ITEM(test_mutt_idna_to_ascii_lz)                                \
                                                                                \
   /* imap */                                                                   \
+  NEOMUTT_TEST_ITEM(test_imap_envelope)                                        \
   NEOMUTT_TEST_ITEM(test_imap_msg_set)                                         \
+  NEOMUTT_TEST_ITEM(test_imap_msn)                                             \
                                                                                \
   /* list */                                                                   \
   NEOMUTT_TEST_ITEM(test_mutt_list_clear)                                      \
@@ -539,7 +542,9 @@ void test_fini(void);
   NEOMUTT_TEST_ITEM(test_mutt_rfc822_parse_line)                               \
   NEOMUTT_TEST_ITEM(test_mutt_rfc822_parse_message)                            \
   NEOMUTT_TEST_ITEM(test_mutt_rfc822_read_header)                              \
+  NEOMUTT_TEST_ITEM(test_mutt_rfc822_read_header_str)                          \
   NEOMUTT_TEST_ITEM(test_mutt_rfc822_read_line)                                \
+  NEOMUTT_TEST_ITEM(test_mutt_rfc822_read_line_str)                            \
   NEOMUTT_TEST_ITEM(test_parse_extract_token)                                  \
   NEOMUTT_TEST_ITEM(test_parse_rc)                                             \
   NEOMUTT_TEST_ITEM(test_parse_set)                                            \
@@ -0,0 +1,91 @@
+/**
+ * @file
+ * Test code for mutt_rfc822_read_line_str()
+ *
+ * @authors
+ * Copyright (C) 2026 Richard Russon <rich@flatcap.org>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include <stdio.h>
+#include <string.h>
+#include "mutt/lib.h"
+#include "email/lib.h"
+#include "test_common.h"
+
+static struct Rfc822ReadLineStrTestData
+{
+  const char *input;
+  const char *output;
+  size_t read;
+} test_data[] = {
+  // clang-format off
+  { "Subject: basic stuff\n",          "Subject: basic stuff",  21 },
+  { "Subject: basic stuff\n\n  ",      "Subject: basic stuff",  21 },
+  { "Subject: long\n subject\n",       "Subject: long subject", 23 },
+  { "Subject: long\n      subject\n",  "Subject: long subject", 28 },
+  { "Subject: one\nAnother: two\n",    "Subject: one",          13 },
+  { "Subject: one    \n",              "Subject: one",          17 },
+  { "Subject: one\r\n",                "Subject: one",          14 },
+  { "Subject: no newline",             "Subject: no newline",   19 },
+  // clang-format on
+};
+
+void test_mutt_rfc822_read_line_str(void)
+{
+  // size_t mutt_rfc822_read_line_str(const char *str, size_t len, struct Buffer *buf);
+
+  {
+    struct Buffer buf = { 0 };
+    TEST_CHECK(mutt_rfc822_read_line_str(NULL, 10, &buf) == 0);
+  }
+
+  {
+    TEST_CHECK(mutt_rfc822_read_line_str("Subject: one\n", 13, NULL) == 0);
+  }
+
+  {
+    const char *input = "Head1: val1.1\n  val1.2\nHead2: val2.1\n val2.2\n";
+    const size_t len = strlen(input);
+    struct Buffer *buf = buf_pool_get();
+
+    const size_t after1 = mutt_rfc822_read_line_str(input, len, buf);
+    TEST_CHECK_STR_EQ(buf_string(buf), "Head1: val1.1 val1.2");
+
+    mutt_rfc822_read_line_str(input + after1, len - after1, buf);
+    TEST_CHECK_STR_EQ(buf_string(buf), "Head2: val2.1 val2.2");
+
+    buf_pool_release(&buf);
+  }
+
+  for (size_t i = 0; i < mutt_array_size(test_data); i++)
+  {
+    TEST_CASE(test_data[i].input);
+    struct Buffer *buf = buf_pool_get();
+    const size_t read = mutt_rfc822_read_line_str(test_data[i].input,
+                                                  strlen(test_data[i].input), buf);
+    if (!TEST_CHECK(read == test_data[i].read))
+    {
+      TEST_MSG("Expected: %zu", test_data[i].read);
+      TEST_MSG("Actual  : %zu", read);
+    }
+    TEST_CHECK_STR_EQ(buf_string(buf), test_data[i].output);
+    buf_pool_release(&buf);
+  }
+}